@@ -3,12 +3,126 @@ import serial
 import serial.tools.list_ports
 import threading
 import time
+import struct
+import binascii
 from PyQt5.QtWidgets import (QApplication, QMainWindow, QVBoxLayout, QHBoxLayout, 
                              QLabel, QPushButton, QComboBox, QTextEdit, 
                              QWidget, QGridLayout, QProgressBar)
-from PyQt5.QtCore import Qt, QTimer
+from PyQt5.QtCore import Qt
 from PyQt5.QtGui import QKeyEvent, QFont, QColor
 
+# Двоичные кадры прошивки (Core/Inc/frame.h): COBS, конец кадра - 0x00.
+# После декодирования: [version][type][sequence:u16][payload][crc16:u16]
+FRAME_VERSION = 2
+FRAME_TYPE_IMU_CAPTURE = 2
+FRAME_TYPE_SATELLITES = 3
+FRAME_TYPE_TEXT = 4
+FRAME_TYPE_IMU = 5
+FRAME_TYPE_ATTITUDE = 6
+FRAME_TYPE_GPS = 7
+FRAME_TYPE_HALL = 8
+FRAME_TYPE_MOTOR = 9
+FRAME_TYPE_DIAG = 10
+FRAME_TYPE_NAV = 11
+FRAME_TYPE_PROFILE = 12
+FRAME_TYPE_HISTOGRAM = 13
+FRAME_HEADER = struct.Struct('<BBH')
+
+# Каналы телеметрии по подписке (Core/Inc/telemetry.h), по кадру на канал
+IMU = struct.Struct('<I3h3h3hhBII')         # timestamp_us, accel, gyro, mag, temp, sync, utc
+ATTITUDE = struct.Struct('<I3hB')           # timestamp_us, roll, pitch, yaw, yaw_source
+GPS = struct.Struct('<IiiiHHBBIBBHH')       # timestamp_us, lat, lon, alt, speed, course, sats, fix, время, дата, hdop
+HALL = struct.Struct('<I4h')                # timestamp_us, ALF, ALR, ARF, ARR
+MOTOR = struct.Struct('<I10B')              # timestamp_us, MotorState по MotorID
+DIAG = struct.Struct('<IIIIIIIBBiHHH')      # timestamp_us, uptime, потери USB, задержки команд, GPS, PPS, простой ЦП, стек, RAM
+NAV = struct.Struct('<IBiihhH')             # timestamp_us, valid, lat, lon, vel_n, vel_e, heading
+PROFILE_HEADER = struct.Struct('<IB3x')      # clock_hz, count
+PROFILE_ENTRY = struct.Struct('<BxIIII')     # id, calls, min, avg, max (такты)
+HISTOGRAM = struct.Struct('<BBxxI20I')        # id, bucket_count, max_us, counts[20]
+
+# Histogram_Id (Core/Inc/histogram.h)
+HISTOGRAM_NAMES = ["Джиттер такта", "Команда -> двигатели", "Джиттер телеметрии", "Возраст отсчета IMU"]
+
+# Profile_Id (Core/Inc/profile.h); задачи - в порядке таблицы main.c
+PROFILE_NAMES = ["ISR USART2", "ISR DMA1_CH6", "ISR I2C1", "ISR ADC", "ISR USB", "ISR TIM2", "ISR TIM3",
+                 "IMU_READ", "NMEA_DECODE", "MOTOR_UPDATE", "FRAME_ENCODE",
+                 "Задача CMD", "Задача IMU", "Задача NAV", "Задача GPS", "Задача TLM", "Задача HOUSE"]
+
+# Частоты каналов (Гц), запрашиваются командами SUB:<канал>:<Гц> при подключении
+SUBSCRIPTIONS = {"IMU": 10, "ATT": 10, "GPS": 5, "HALL": 10, "MOTOR": 2, "DIAG": 1, "NAV": 5}
+ACCEL_SCALE = 8000.0
+GYRO_SCALE = 50.0
+MAG_SCALE = 1000.0
+TEMP_SCALE = 100.0
+ANGLE_SCALE = 50.0
+COURSE_SCALE = 100.0
+SPEED_SCALE = 100.0
+ALT_SCALE = 100.0
+DOP_SCALE = 100.0
+
+CAPTURE_HEADER = struct.Struct('<IB3x')      # dropped, count
+CAPTURE_SAMPLE = struct.Struct('<I3hh3hH')  # timestamp_us, accel[3], temp, gyro[3], seq
+SATELLITES_HEADER = struct.Struct('<BxHHH')  # count, pdop, hdop, vdop
+SATELLITE = struct.Struct('<BBBBH')         # система, prn, угол места, snr, азимут
+
+# Кадры каналов телеметрии, которые начинаются с timestamp_us
+STAMPED_FRAMES = (FRAME_TYPE_IMU, FRAME_TYPE_ATTITUDE, FRAME_TYPE_GPS, FRAME_TYPE_HALL,
+                  FRAME_TYPE_MOTOR, FRAME_TYPE_DIAG, FRAME_TYPE_NAV)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("COBS")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_frame(encoded):
+    """Возвращает (type, sequence, payload) или None при ошибке кадра."""
+    try:
+        frame = cobs_decode(encoded)
+    except ValueError:
+        return None
+    if len(frame) < FRAME_HEADER.size + 2:
+        return None
+    body, crc = frame[:-2], struct.unpack('<H', frame[-2:])[0]
+    if binascii.crc_hqx(body, 0xFFFF) != crc:
+        return None
+    version, frame_type, sequence = FRAME_HEADER.unpack_from(body)
+    if version != FRAME_VERSION:
+        return None
+    return frame_type, sequence, body[FRAME_HEADER.size:]
+
+
+class MicrosClock:
+    """Продолжение 32-битных меток timestamp_us (переполнение ~71.6 мин) в
+    непрерывную шкалу: к предыдущему значению прибавляется разность со
+    знаком. Метки каналов идут не строго по порядку, но расходятся меньше
+    чем на 2^31 мкс (~35 мин)."""
+
+    def __init__(self):
+        self.last = None
+        self.extended = 0
+
+    def extend(self, stamp):
+        if self.last is None:
+            self.extended = stamp
+        else:
+            delta = (stamp - self.last) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            self.extended += delta
+        self.last = stamp
+        return self.extended
+
+
 class RobotControlPanel(QMainWindow):
     def __init__(self):
         super().__init__()
@@ -64,6 +178,34 @@ class RobotControlPanel(QMainWindow):
         port_layout.addWidget(self.refresh_ports_button)
         port_layout.addWidget(self.connect_button)
 
+        # Захват сырых отсчетов IMU
+        self.capture_button = QPushButton("Захват IMU")
+        self.capture_button.setCheckable(True)
+        self.capture_button.toggled.connect(self.toggle_capture)
+        self.capture_active = False
+        self.capture_file = None
+        self.capture_dropped = 0
+
+        # Статистика кадров
+        self.rx_buffer = bytearray()
+        self.last_sequence = None
+        self.frames_lost = 0
+        self.frames_bad = 0
+        self.clock = MicrosClock()
+
+        # Таблица спутников по запросу
+        self.satellites_button = QPushButton("Спутники")
+        self.satellites_button.clicked.connect(self.request_satellites)
+
+        self.histogram_button = QPushButton("Гистограммы")
+        self.histogram_button.clicked.connect(self.request_histograms)
+        self.histogram_reset_button = QPushButton("Сброс гистограмм")
+        self.histogram_reset_button.clicked.connect(self.reset_histograms)
+
+        self.profile_button = QPushButton("Профиль")
+        self.profile_button.setCheckable(True)
+        self.profile_button.toggled.connect(self.toggle_profile)
+
         # Телеметрия
         telemetry_widget = QWidget()
         telemetry_layout = QGridLayout()
@@ -82,8 +224,12 @@ class RobotControlPanel(QMainWindow):
             "Акселерометр X", "Акселерометр Y", "Акселерометр Z",
             "Roll", "Pitch", "Yaw",
             "Широта", "Долгота", "Высота",
-            "Скорость", "Course over ground",
-            "Угол ALF", "Угол ALR", "Угол ARF", "Угол ARR"
+            "Скорость", "Course over ground", "Спутники", "Фикс",
+            "Угол ALF", "Угол ALR", "Угол ARF", "Угол ARR",
+            "Синхронизация PPS", "Время IMU (UTC)",
+            "Фильтр: широта", "Фильтр: долгота", "Фильтр: скорость N/E", "Фильтр: курс",
+            "Двигатели", "Потери USB (TX/RX)", "Задержка команд", "Простой ЦП",
+            "Стек / свободная RAM"
         ]
 
         self.telemetry_values = {}
@@ -102,6 +248,11 @@ class RobotControlPanel(QMainWindow):
         # Компоновка
         control_layout.addLayout(movement_layout)
         control_layout.addLayout(port_layout)
+        control_layout.addWidget(self.capture_button)
+        control_layout.addWidget(self.satellites_button)
+        control_layout.addWidget(self.profile_button)
+        control_layout.addWidget(self.histogram_button)
+        control_layout.addWidget(self.histogram_reset_button)
 
         main_layout.addWidget(control_widget)
         main_layout.addWidget(telemetry_widget)
@@ -113,10 +264,20 @@ class RobotControlPanel(QMainWindow):
         self.refresh_ports_button.clicked.connect(self.refresh_ports)
         self.connect_button.clicked.connect(self.toggle_connection)
 
-        # Таймер для обновления
-        self.update_timer = QTimer()
-        self.update_timer.timeout.connect(self.request_telemetry)
-        self.update_timer.start(500)  # Опрос каждые 500 мс
+        # Прошивка сама отправляет подписанные каналы, опрос не нужен
+        self.frame_handlers = {
+            FRAME_TYPE_IMU: self.parse_imu,
+            FRAME_TYPE_ATTITUDE: self.parse_attitude,
+            FRAME_TYPE_GPS: self.parse_gps,
+            FRAME_TYPE_HALL: self.parse_hall,
+            FRAME_TYPE_MOTOR: self.parse_motor,
+            FRAME_TYPE_DIAG: self.parse_diag,
+            FRAME_TYPE_NAV: self.parse_nav,
+            FRAME_TYPE_IMU_CAPTURE: self.handle_capture,
+            FRAME_TYPE_SATELLITES: self.parse_satellites,
+            FRAME_TYPE_PROFILE: self.parse_profile,
+            FRAME_TYPE_HISTOGRAM: self.parse_histogram,
+        }
 
         # Переменные для отслеживания GPS
         self.last_satellite_count = 0
@@ -175,19 +336,113 @@ class RobotControlPanel(QMainWindow):
                 self.connect_button.setText("Отключить")
                 self.log(f"Подключено к порту {port}")
                 threading.Thread(target=self.read_serial, daemon=True).start()
+                self.subscribe_telemetry()
             except Exception as e:
                 self.log(f"Ошибка подключения: {e}")
 
-    def request_telemetry(self):
+    def subscribe_telemetry(self):
+        for channel, rate in SUBSCRIPTIONS.items():
+            self.serial_port.write(f"SUB:{channel}:{rate}\n".encode())
+
+    def request_satellites(self):
+        if self.serial_port and self.serial_port.is_open and not self.capture_active:
+            self.serial_port.write(b'SATS\n')
+
+    def request_histograms(self):
+        if self.serial_port and self.serial_port.is_open:
+            self.serial_port.write(b'HIST\n')
+
+    def reset_histograms(self):
         if self.serial_port and self.serial_port.is_open:
-            self.serial_port.write(b'TELEMETRY\n')
+            self.serial_port.write(b'HIST:RESET\n')
+            self.log("Гистограммы сброшены")
+
+    def toggle_profile(self, enabled):
+        # Профиль раз в секунду, пока кнопка нажата
+        if not self.serial_port or not self.serial_port.is_open:
+            self.profile_button.setChecked(False)
+            return
+        self.serial_port.write(b'SUB:PROF:1\n' if enabled else b'SUB:PROF:0\n')
+
+    def toggle_capture(self, enabled):
+        if not self.serial_port or not self.serial_port.is_open:
+            self.log("Порт не подключен")
+            self.capture_button.setChecked(False)
+            return
+
+        if enabled:
+            self.capture_file = open("imu_capture.csv", "w")
+            self.capture_file.write("timestamp_us,ax,ay,az,temp,gx,gy,gz,seq\n")
+            self.capture_dropped = 0
+            self.capture_active = True
+            self.serial_port.write(b'CAPTURE:ON\n')
+            self.log("Захват IMU запущен (imu_capture.csv)")
+        else:
+            self.serial_port.write(b'CAPTURE:OFF\n')
+            self.capture_active = False
+            if self.capture_file:
+                self.capture_file.close()
+                self.capture_file = None
+            self.log("Захват IMU остановлен")
+
+    def handle_capture(self, payload):
+        dropped, count = CAPTURE_HEADER.unpack_from(payload)
+        samples = payload[CAPTURE_HEADER.size:CAPTURE_HEADER.size + count * CAPTURE_SAMPLE.size]
+        if not self.capture_file:
+            return
+
+        # В файл - метки без переполнения 32 бит
+        for sample in CAPTURE_SAMPLE.iter_unpack(samples):
+            values = (self.clock.extend(sample[0]),) + sample[1:]
+            self.capture_file.write(",".join(str(v) for v in values) + "\n")
+        if dropped != self.capture_dropped:
+            self.capture_dropped = dropped
+            self.log(f"Захват IMU: потеряно отсчетов {dropped}")
+
+    def handle_frame(self, encoded):
+        frame = decode_frame(encoded)
+        if frame is None:
+            self.frames_bad += 1
+            self.log(f"Поврежденный кадр ({self.frames_bad})")
+            return
+        frame_type, sequence, payload = frame
+
+        # Пропуски номеров - кадры, потерянные в прошивке или в USB
+        if self.last_sequence is not None:
+            lost = (sequence - self.last_sequence - 1) & 0xFFFF
+            if lost:
+                self.frames_lost += lost
+                if not self.capture_active:
+                    self.log(f"Потеряно кадров: {self.frames_lost}")
+        self.last_sequence = sequence
+
+        if frame_type == FRAME_TYPE_TEXT:
+            self.log(payload.decode(errors='ignore'))
+            return
+        # Каждая метка продвигает шкалу, чтобы ни одно переполнение не пропало
+        if frame_type in STAMPED_FRAMES and len(payload) >= 4:
+            self.clock.extend(struct.unpack_from('<I', payload)[0])
+        handler = self.frame_handlers.get(frame_type)
+        if handler:
+            try:
+                handler(payload)
+            except struct.error as e:
+                self.log(f"Ошибка парсинга кадра {frame_type}: {e}")
 
     def read_serial(self):
         while self.serial_port and self.serial_port.is_open:
             try:
-                data = self.serial_port.readline().decode().strip()
-                if data:
-                    self.parse_telemetry(data)
+                chunk = self.serial_port.read(self.serial_port.in_waiting or 1)
+                self.rx_buffer += chunk
+                # Каждый ноль завершает кадр
+                while True:
+                    end = self.rx_buffer.find(b'\x00')
+                    if end < 0:
+                        break
+                    encoded = bytes(self.rx_buffer[:end])
+                    del self.rx_buffer[:end + 1]
+                    if encoded:
+                        self.handle_frame(encoded)
             except Exception as e:
                 self.log(f"Ошибка чтения: {e}")
                 break
@@ -233,43 +488,113 @@ class RobotControlPanel(QMainWindow):
         except ValueError:
             pass
 
-    def parse_telemetry(self, data):
+    def parse_imu(self, payload):
+        (ts, ax, ay, az, gx, gy, gz, mx, my, mz, temp, sync, utc_s, utc_us) = IMU.unpack_from(payload)
+        imu_values = {
+            "Гироскоп X": gx / GYRO_SCALE, "Гироскоп Y": gy / GYRO_SCALE, "Гироскоп Z": gz / GYRO_SCALE,
+            "Акселерометр X": ax / ACCEL_SCALE, "Акселерометр Y": ay / ACCEL_SCALE,
+            "Акселерометр Z": az / ACCEL_SCALE,
+        }
+        for label, value in imu_values.items():
+            self.telemetry_values[label].setText(f"{value:.3f}")
+
+        # Привязка времени IMU к UTC по PPS
+        states = {0: "нет", 1: "PPS", 2: "удержание"}
+        self.telemetry_values["Синхронизация PPS"].setText(states.get(sync, str(sync)))
+        if sync != 0:
+            stamp = time.strftime("%H:%M:%S", time.gmtime(utc_s))
+            self.telemetry_values["Время IMU (UTC)"].setText(f"{stamp}.{utc_us:06d}")
+
+    def parse_attitude(self, payload):
+        ts, roll, pitch, yaw, yaw_source = ATTITUDE.unpack_from(payload)
+        self.telemetry_values["Roll"].setText(f"{roll / ANGLE_SCALE:.3f}")
+        self.telemetry_values["Pitch"].setText(f"{pitch / ANGLE_SCALE:.3f}")
+        sources = {0: "", 1: " (GPS)", 2: " (GPS, последний)"}
+        self.telemetry_values["Yaw"].setText(f"{yaw / ANGLE_SCALE:.3f}{sources.get(yaw_source, '')}")
+
+    def parse_gps(self, payload):
+        (ts, lat, lon, alt, speed, course, satellites, fix,
+         tod_ms, day, month, year, hdop) = GPS.unpack_from(payload)
+        # Координаты приходят целыми в единицах 1e-7 градуса
+        self.telemetry_values["Широта"].setText(f"{lat / 1e7:.7f}")
+        self.telemetry_values["Долгота"].setText(f"{lon / 1e7:.7f}")
+        self.telemetry_values["Высота"].setText(f"{alt / ALT_SCALE:.2f}")
+        self.telemetry_values["Скорость"].setText(f"{speed / SPEED_SCALE:.2f}")
+        self.telemetry_values["Course over ground"].setText(f"{course / COURSE_SCALE:.1f}")
+        self.telemetry_values["Спутники"].setText(str(satellites))
+        self.telemetry_values["Фикс"].setText(f"{fix} (HDOP {hdop / DOP_SCALE:.2f})")
+        self.update_gps_signal_indicator(satellites)
+
+    def parse_hall(self, payload):
+        ts, alf, alr, arf, arr = HALL.unpack_from(payload)
+        hall_values = {"Угол ALF": alf, "Угол ALR": alr, "Угол ARF": arf, "Угол ARR": arr}
+        for label, value in hall_values.items():
+            self.telemetry_values[label].setText(f"{value / ANGLE_SCALE:.1f}")
+
+    def parse_motor(self, payload):
+        # MotorState: 0 - стоп, 1 - вперед, 2 - назад
+        symbols = {0: "-", 1: "F", 2: "B"}
+        ts, *states = MOTOR.unpack_from(payload)
+        self.telemetry_values["Двигатели"].setText("".join(symbols.get(s, "?") for s in states))
+
+    def parse_diag(self, payload):
+        (ts, uptime_ms, tx_dropped, rx_overruns, latency_last, latency_max,
+         late, gps_protocol, sync, drift_ppb, idle_permille,
+         stack_peak, ram_free) = DIAG.unpack_from(payload)
+        self.telemetry_values["Потери USB (TX/RX)"].setText(f"{tx_dropped} / {rx_overruns}")
+        self.telemetry_values["Задержка команд"].setText(
+            f"{latency_last} / {latency_max} мкс, сверх бюджета {late}")
+        self.telemetry_values["Простой ЦП"].setText(f"{idle_permille / 10:.1f}%")
+        self.telemetry_values["Стек / свободная RAM"].setText(f"{stack_peak} / {ram_free} байт")
+
+    def parse_nav(self, payload):
+        ts, valid, lat, lon, vn, ve, heading = NAV.unpack_from(payload)
+        if valid:
+            self.telemetry_values["Фильтр: широта"].setText(f"{lat / 1e7:.7f}")
+            self.telemetry_values["Фильтр: долгота"].setText(f"{lon / 1e7:.7f}")
+            self.telemetry_values["Фильтр: скорость N/E"].setText(
+                f"{vn / SPEED_SCALE:.2f} / {ve / SPEED_SCALE:.2f}")
+            self.telemetry_values["Фильтр: курс"].setText(f"{heading / COURSE_SCALE:.1f}")
+
+    def parse_profile(self, payload):
+        clock_hz, count = PROFILE_HEADER.unpack_from(payload)
+        per_us = clock_hz / 1e6
+        self.log(f"Профиль ({clock_hz / 1e6:.0f} МГц): вызовов, мкс мин/сред/макс")
+        entries = payload[PROFILE_HEADER.size:PROFILE_HEADER.size + count * PROFILE_ENTRY.size]
+        for pid, calls, min_c, avg_c, max_c in PROFILE_ENTRY.iter_unpack(entries):
+            name = PROFILE_NAMES[pid] if pid < len(PROFILE_NAMES) else f"#{pid}"
+            self.log(f"  {name:<14} {calls:>9} {min_c / per_us:9.1f} {avg_c / per_us:9.1f} {max_c / per_us:9.1f}")
+
+    def parse_histogram(self, payload):
+        hid, bucket_count, max_us, *counts = HISTOGRAM.unpack_from(payload)
+        name = HISTOGRAM_NAMES[hid] if hid < len(HISTOGRAM_NAMES) else f"#{hid}"
+        total = sum(counts)
+        self.log(f"{name}: событий {total}, максимум {max_us} мкс")
+        # Корзина 0 - 0 мкс, корзина k - [2^(k-1), 2^k) мкс, последняя открыта сверху
+        for k, count in enumerate(counts[:bucket_count]):
+            if not count:
+                continue
+            low = 0 if k == 0 else 1 << (k - 1)
+            high = "" if k == bucket_count - 1 else f"{(1 << k) - 1 if k else 0}"
+            self.log(f"  {low:>7}..{high:<7} мкс {count:>9} ({100.0 * count / total:5.1f}%)")
+
+    def parse_satellites(self, payload):
+        systems = {1: "GPS", 2: "ГЛОНАСС", 3: "Galileo", 4: "BeiDou", 5: "GNSS"}
         try:
-            imu_data, gps_data, hall_data = data.split('|')
-            
-            # Парсинг IMU
-            imu_values = imu_data.split(':')[1].split(',')
-            imu_labels = [
-                "Гироскоп X", "Гироскоп Y", "Гироскоп Z",
-                "Акселерометр X", "Акселерометр Y", "Акселерометр Z",
-                "Roll", "Pitch", "Yaw"
-            ]
-            
-            # Парсинг GPS
-            gps_values = gps_data.split(':')[1].split(',')
-            gps_labels = [
-                "Широта", "Долгота", "Высота", "Скорость", "Course over ground",
-                "Спутники", "Фикс"
-            ]
-            
-            # Парсинг углов Холла
-            hall_values = hall_data.split(':')[1].split(',')
-            hall_labels = ["Угол ALF", "Угол ALR", "Угол ARF", "Угол ARR"]
-
-            # Обновление значений
-            for label, value in zip(imu_labels, imu_values):
-                self.telemetry_values[label].setText(value)
-            
-            for label, value in zip(gps_labels, gps_values):
-                self.telemetry_values[label].setText(value)
-                if label == "Спутники":
-                    self.update_gps_signal_indicator(value)
-            
-            for label, value in zip(hall_labels, hall_values):
-                self.telemetry_values[label].setText(value)
-
+            count, pdop, hdop, vdop = SATELLITES_HEADER.unpack_from(payload)
+            self.log(f"Спутники в зоне видимости: {count}, PDOP {pdop / DOP_SCALE:.2f}, "
+                     f"HDOP {hdop / DOP_SCALE:.2f}, VDOP {vdop / DOP_SCALE:.2f}")
+
+            timestamp = time.strftime("%Y-%m-%d %H:%M:%S")
+            table = payload[SATELLITES_HEADER.size:]
+            for system, prn, elevation, snr, azimuth in SATELLITE.iter_unpack(table):
+                name = systems.get(system, "?")
+                self.log(f"  {name} {prn}: угол места {elevation}, азимут {azimuth}, SNR {snr}")
+                self.satellite_log_file.write(
+                    f"{timestamp}: {name} {prn} el={elevation} az={azimuth} snr={snr}\n")
+            self.satellite_log_file.flush()
         except Exception as e:
-            self.log(f"Ошибка парсинга: {e}")
+            self.log(f"Ошибка разбора спутников: {e}")
 
     def log(self, message):
         self.console.append(message)
@@ -278,6 +603,8 @@ class RobotControlPanel(QMainWindow):
         # Закрытие файла лога при закрытии приложения
         if hasattr(self, 'satellite_log_file'):
             self.satellite_log_file.close()
+        if self.capture_file:
+            self.capture_file.close()
         event.accept()
 
 def main():
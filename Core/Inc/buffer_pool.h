@@ -0,0 +1,62 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stdint.h>
+#include "lockfree.h"
+
+// Пул блоков фиксированного размера с передачей владения: блок заполняется
+// на месте (кадр кодируется, пакет USB принимается прямо в него), номер
+// блока передается другому контексту через SpscRecordRing, тот освобождает
+// блок после использования. Данные между буферами не копируются.
+//
+// Выделяет блоки только один контекст (владелец пула), освобождать можно
+// из любого: свободные блоки - биты одного слова, освобождение через
+// LDREX/STREX. До 32 блоков.
+//
+// Не зависит от HAL.
+
+#define BUFFER_POOL_NONE 0xFF   // Нет блока
+
+typedef struct {
+    uint8_t* memory;
+    uint16_t block_size;
+    uint8_t count;
+    volatile uint32_t free_mask;    // Бит на свободный блок
+} BufferPool;
+
+static inline void BufferPool_Init(BufferPool* pool, void* memory, uint16_t block_size, uint8_t count) {
+    pool->memory = (uint8_t*)memory;
+    pool->block_size = block_size;
+    pool->count = count;
+    pool->free_mask = (count >= 32) ? 0xFFFFFFFFU : ((1U << count) - 1U);
+}
+
+// Владелец пула: номер свободного блока или BUFFER_POOL_NONE
+static inline uint8_t BufferPool_Alloc(BufferPool* pool) {
+    uint32_t mask = pool->free_mask;
+    if (mask == 0) {
+        return BUFFER_POOL_NONE;
+    }
+
+    // Другие контексты только добавляют свободные биты: выбранный блок не
+    // может исчезнуть между чтением маски и сбросом бита
+    uint8_t index = (uint8_t)__builtin_ctz(mask);
+    Lockfree_FetchClear(&pool->free_mask, 1U << index);
+    return index;
+}
+
+// Любой контекст: блок возвращается в пул после последнего обращения к нему
+static inline void BufferPool_Free(BufferPool* pool, uint8_t index) {
+    LOCKFREE_DMB();
+    Lockfree_FetchOr(&pool->free_mask, 1U << index);
+}
+
+static inline uint8_t* BufferPool_Data(const BufferPool* pool, uint8_t index) {
+    return &pool->memory[(uint32_t)index * pool->block_size];
+}
+
+static inline uint8_t BufferPool_FreeCount(const BufferPool* pool) {
+    return (uint8_t)__builtin_popcount(pool->free_mask);
+}
+
+#endif // BUFFER_POOL_H
@@ -0,0 +1,219 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+
+// Двоичные кадры USB: версия, тип, номер кадра, полезная нагрузка и CRC16,
+// закодированные COBS и завершенные нулевым байтом.
+//
+// До кодирования: [version:1][type:1][sequence:2][payload:N][crc16:2]
+//   CRC-16/CCITT-FALSE (полином 0x1021, начальное 0xFFFF) по version..payload
+//   Все поля little-endian, структуры нагрузки упакованы без выравнивания
+//
+// COBS убирает нули из кадра, поэтому 0x00 однозначно отмечает конец кадра:
+// после потери байт приемник синхронизируется на следующем нуле.
+//
+// timestamp_us во всех каналах телеметрии и отсчетах захвата - 32 бита
+// Timebase_GetMicros, переполнение раз в ~71.6 минуты. Хост продолжает шкалу
+// за переполнение по разности со знаком от предыдущей метки (Control.py,
+// MicrosClock): кадры с метками идут чаще раза в ~35 минут, пока канал жив.
+//
+// Не зависит от HAL, собирается и на хосте (Tools/frame_bench.c).
+
+#define FRAME_VERSION     2
+
+#define FRAME_HEADER_SIZE 4
+#define FRAME_CRC_SIZE    2
+#define FRAME_DELIMITER   0x00
+
+// Наибольший размер кадра после COBS с завершающим нулем для нагрузки length
+#define FRAME_MAX_ENCODED(length) \
+    ((length) + FRAME_HEADER_SIZE + FRAME_CRC_SIZE + \
+     ((length) + FRAME_HEADER_SIZE + FRAME_CRC_SIZE) / 254 + 2)
+
+// Наибольшая нагрузка, кадр которой гарантированно помещается в size байт
+#define FRAME_MAX_PAYLOAD(size) \
+    ((size) - FRAME_HEADER_SIZE - FRAME_CRC_SIZE - (size) / 254 - 2)
+
+typedef enum {
+    FRAME_TYPE_IMU_CAPTURE = 2, // Frame_ImuCaptureHeader + count * IMU_RawSample
+    FRAME_TYPE_SATELLITES  = 3, // Frame_SatellitesHeader + count * Frame_Satellite
+    FRAME_TYPE_TEXT        = 4, // Ответ на команду, ASCII без '\n'
+
+    // Каналы телеметрии по подписке (telemetry.h)
+    FRAME_TYPE_IMU         = 5, // Frame_Imu
+    FRAME_TYPE_ATTITUDE    = 6, // Frame_Attitude
+    FRAME_TYPE_GPS         = 7, // Frame_Gps
+    FRAME_TYPE_HALL        = 8, // Frame_Hall
+    FRAME_TYPE_MOTOR       = 9, // Frame_Motor
+    FRAME_TYPE_DIAG        = 10, // Frame_Diag
+    FRAME_TYPE_NAV         = 11, // Frame_Nav
+    FRAME_TYPE_PROFILE     = 12, // Frame_ProfileHeader + count * Frame_ProfileEntry
+    FRAME_TYPE_HISTOGRAM   = 13  // Frame_Histogram, по кадру на гистограмму (команда HIST)
+} Frame_Type;
+
+// Масштабы полей с фиксированной точкой: значение = поле / масштаб
+#define FRAME_ACCEL_SCALE  8000.0f // LSB на g, ±4.096 g
+#define FRAME_GYRO_SCALE   50.0f   // LSB на град/с, ±655 град/с
+#define FRAME_MAG_SCALE    1000.0f // LSB на Гаусс (мГс)
+#define FRAME_TEMP_SCALE   100.0f  // LSB на °C
+#define FRAME_ANGLE_SCALE  50.0f   // LSB на градус, знаковые углы ±655°
+#define FRAME_COURSE_SCALE 100.0f  // LSB на градус, курс 0..360
+#define FRAME_SPEED_SCALE  100.0f  // LSB на м/с (см/с)
+#define FRAME_ALT_SCALE    100.0f  // LSB на метр (см)
+#define FRAME_DOP_SCALE    100.0f
+
+#define FRAME_MOTOR_COUNT  10      // MOTOR_COUNT в motor_control.h
+#define FRAME_HISTOGRAM_BUCKETS 20 // HISTOGRAM_BUCKETS в histogram.h
+
+// IMU, 33 байта. Пара timestamp_us/utc - привязка локального времени
+// к UTC по PPS и для остальных каналов (Timebase_SyncState в sync)
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;       // Timebase_GetMicros отсчета
+    int16_t accel[3];            // FRAME_ACCEL_SCALE
+    int16_t gyro[3];             // FRAME_GYRO_SCALE
+    int16_t mag[3];              // FRAME_MAG_SCALE
+    int16_t temp;                // FRAME_TEMP_SCALE
+    uint8_t sync;
+    uint32_t utc_seconds;
+    uint32_t utc_micros;
+} Frame_Imu;
+
+// Ориентация, 11 байт
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;
+    int16_t attitude[3];         // Крен, тангаж, рыскание, FRAME_ANGLE_SCALE
+    uint8_t yaw_source;          // 0 - IMU, 1 - курс GPS, 2 - последний курс GPS
+} Frame_Attitude;
+
+// Решение GPS, 32 байта
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;       // Timebase_GetMicros разбора координат
+    int32_t latitude_e7;
+    int32_t longitude_e7;
+    int32_t altitude;            // FRAME_ALT_SCALE
+    uint16_t speed;              // FRAME_SPEED_SCALE
+    uint16_t course;             // FRAME_COURSE_SCALE
+    uint8_t satellites;
+    uint8_t fix;
+    uint32_t time_of_day_ms;     // Время UTC решения от начала суток
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    uint16_t hdop;               // FRAME_DOP_SCALE
+} Frame_Gps;
+
+// Датчики Холла ALF, ALR, ARF, ARR, 12 байт
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;       // Timebase_GetMicros чтения датчиков
+    int16_t hall[4];             // FRAME_ANGLE_SCALE
+} Frame_Hall;
+
+// Состояния двигателей (MotorState) в порядке MotorID, 14 байт
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;       // Timebase_GetMicros чтения состояний
+    uint8_t states[FRAME_MOTOR_COUNT];
+} Frame_Motor;
+
+// Диагностика, 40 байт
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;       // Timebase_GetMicros сбора счетчиков
+    uint32_t uptime_ms;
+    uint32_t usb_tx_dropped;     // Кадров, не поместившихся в блоки передачи
+    uint32_t usb_rx_overruns;    // Пакетов приема без свободного блока
+    uint32_t command_latency_last_us;
+    uint32_t command_latency_max_us;
+    uint32_t command_late;       // Команд сверх бюджета одного такта управления
+    uint8_t gps_protocol;        // GPS_Protocol
+    uint8_t sync;                // Timebase_SyncState
+    int32_t drift_ppb;           // Уход локального генератора по PPS
+    uint16_t cpu_idle_permille;  // Доля простоя ЦП за последнюю секунду (0.1%)
+    uint16_t stack_peak;         // Наибольшая глубина стека с запуска (байт)
+    uint16_t ram_free_min;       // Ни разу не использованная RAM (байт)
+} Frame_Diag;
+
+// Оценка фильтра GPS/IMU, 19 байт
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;       // Время отсчета IMU последнего прогноза
+    uint8_t valid;
+    int32_t latitude_e7;
+    int32_t longitude_e7;
+    int16_t vel_north;           // FRAME_SPEED_SCALE
+    int16_t vel_east;
+    uint16_t heading;            // FRAME_COURSE_SCALE
+} Frame_Nav;
+
+// Профиль времени выполнения (profile.h), 8 байт
+typedef struct __attribute__((packed)) {
+    uint32_t clock_hz;           // Частота счетчика тактов
+    uint8_t count;
+    uint8_t reserved[3];
+} Frame_ProfileHeader;
+
+// Точка профиля, 18 байт. Только точки, у которых были вызовы.
+typedef struct __attribute__((packed)) {
+    uint8_t id;                  // Profile_Id
+    uint8_t reserved;
+    uint32_t calls;
+    uint32_t min_cycles;
+    uint32_t avg_cycles;
+    uint32_t max_cycles;
+} Frame_ProfileEntry;
+
+// Гистограмма задержек (histogram.h), 88 байт
+typedef struct __attribute__((packed)) {
+    uint8_t id;                  // Histogram_Id
+    uint8_t bucket_count;
+    uint16_t reserved;
+    uint32_t max_us;
+    uint32_t counts[FRAME_HISTOGRAM_BUCKETS]; // Корзина 0 - 0 мкс, k - [2^(k-1), 2^k) мкс
+} Frame_Histogram;
+
+// Заголовок пакета захвата IMU, 8 байт: отсчеты за ним выровнены по 4
+typedef struct __attribute__((packed)) {
+    uint32_t dropped;            // Всего потеряно отсчетов с начала захвата
+    uint8_t count;
+    uint8_t reserved[3];
+} Frame_ImuCaptureHeader;
+
+typedef struct __attribute__((packed)) {
+    uint8_t count;               // Спутников в таблице (может быть больше, чем в кадре)
+    uint8_t reserved;
+    uint16_t pdop;               // FRAME_DOP_SCALE
+    uint16_t hdop;
+    uint16_t vdop;
+} Frame_SatellitesHeader;
+
+typedef struct __attribute__((packed)) {
+    uint8_t constellation;       // NMEA_Talker
+    uint8_t prn;
+    uint8_t elevation;           // Градусы
+    uint8_t snr;                 // дБГц
+    uint16_t azimuth;            // Градусы
+} Frame_Satellite;
+
+// Перевод в фиксированную точку: округление к ближайшему с насыщением
+static inline int16_t Frame_ToFixed16(float value, float scale) {
+    float scaled = value * scale;
+    if (scaled >= 32767.0f) return INT16_MAX;
+    if (scaled <= -32768.0f) return INT16_MIN;
+    return (int16_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline uint16_t Frame_ToFixedU16(float value, float scale) {
+    float scaled = value * scale;
+    if (scaled >= 65535.0f) return UINT16_MAX;
+    if (scaled <= 0.0f) return 0;
+    return (uint16_t)(scaled + 0.5f);
+}
+
+// CRC-16/CCITT-FALSE, crc - начальное значение (0xFFFF) или результат
+// предыдущего вызова
+uint16_t Frame_Crc16(uint16_t crc, const uint8_t* data, uint16_t length);
+
+// Сборка кадра в out. Возвращает длину с завершающим нулем или 0, если
+// out_size меньше FRAME_MAX_ENCODED(length).
+uint16_t Frame_Encode(uint8_t type, uint16_t sequence, const void* payload, uint16_t length,
+                      uint8_t* out, uint16_t out_size);
+
+#endif // FRAME_H
@@ -3,10 +3,30 @@
 
 #include "main.h"
 
+// Скорость UART приемника в режиме NMEA (по умолчанию после включения)
+#define GPS_UART_BAUDRATE 9600
+
+// Режим UBX (u-blox): скорость UART и период решения после настройки
+#define GPS_UBX_BAUDRATE        115200
+#define GPS_UBX_NAV_RATE_MS     100   // 10 Гц
+#define GPS_UBX_TIMEOUT_MS      2000  // Нет NAV-PVT дольше - откат или повторная настройка
+#define GPS_UBX_SWITCH_DELAY_MS 50
+#define GPS_UBX_TX_TIMEOUT_MS   100
+#define GPS_UBX_SKY_MSG_RATE    10    // GSA/GSV раз в 10 решений (1 Гц)
+
+// Размер таблицы спутников (все системы вместе)
+#define GPS_MAX_SATELLITES 32
+
+// Протокол, по которому приходят данные
+typedef enum {
+    GPS_PROTOCOL_NMEA = 0,
+    GPS_PROTOCOL_UBX
+} GPS_Protocol;
+
 // Структура для хранения данных GPS
 typedef struct {
-    float latitude;      // Широта (градусы)
-    float longitude;     // Долгота (градусы)
+    int32_t latitude_e7;  // Широта (градусы * 1e7, ~1 см)
+    int32_t longitude_e7; // Долгота (градусы * 1e7)
     float altitude;      // Высота над уровнем моря (метры)
     float speed;         // Скорость (м/с)
     float course;        // Курс (градусы)
@@ -15,19 +35,53 @@ typedef struct {
     uint8_t hour;        // Час (UTC)
     uint8_t minute;      // Минуты (UTC)
     uint8_t second;      // Секунды (UTC)
+    uint16_t millisecond; // Миллисекунды решения (UTC)
     uint8_t day;         // День
     uint8_t month;       // Месяц
     uint16_t year;       // Год
+    float pdop;          // Факторы снижения точности (GSA)
+    float hdop;
+    float vdop;
+    uint32_t position_updates; // Счетчик принятых координат (новое решение)
+    uint32_t timestamp_us; // Timebase_GetMicros разбора последних координат
 } GPS_Data;
 
+// Спутник в зоне видимости (GSV)
+typedef struct {
+    uint8_t constellation; // NMEA_Talker: 1 GPS, 2 ГЛОНАСС, 3 Galileo, 4 BeiDou
+    uint8_t prn;
+    uint8_t elevation;     // Угол места (градусы)
+    uint8_t snr;           // Сигнал/шум (дБГц), 0 - не отслеживается
+    uint16_t azimuth;      // Азимут (градусы)
+} GPS_Satellite;
+
+// Таблица спутников фиксированного размера
+typedef struct {
+    uint8_t count;
+    GPS_Satellite sats[GPS_MAX_SATELLITES];
+} GPS_SkyView;
+
 // Инициализация GPS
 void GPS_Init(void);
 
 // Обновление данных GPS
 void GPS_Update(void);
 
-// Получение текущих данных GPS
-const GPS_Data* GPS_GetData(void);
+// Согласованная копия последних данных GPS
+void GPS_GetData(GPS_Data* data);
+
+// Копия таблицы спутников в зоне видимости
+void GPS_GetSkyView(GPS_SkyView* sky);
+
+// Текущий протокол приемника
+GPS_Protocol GPS_GetProtocol(void);
+
+// Подписка на типы предложений NMEA (маска NMEA_SENTENCE_BIT). Остальные
+// предложения отбрасываются по заголовку без разбора.
+void GPS_SetNmeaSubscriptions(uint32_t mask);
+
+// Текущая маска подписки NMEA
+uint32_t GPS_GetNmeaSubscriptions(void);
 
 // Проверка наличия валидных данных
 uint8_t GPS_HasValidData(void);
@@ -38,7 +92,4 @@ float GPS_GetLastKnownCourse(void);
 // Проверка валидности курса (скорость > 1 м/с)
 uint8_t GPS_HasValidCourse(void);
 
-// Обработка UART для GPS
-void GPS_ProcessUART(void);
-
 #endif // GPS_H 
\ No newline at end of file
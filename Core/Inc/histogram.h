@@ -0,0 +1,38 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+// Гистограммы задержек с логарифмическими корзинами (мкс):
+//   корзина 0 - 0 мкс, корзина k - [2^(k-1), 2^k), последняя - от 2^(N-2).
+// Учет события - одна инструкция CLZ и инкремент счетчика. Каждую
+// гистограмму пишет один контекст; чтение и сброс из основного цикла.
+
+#define HISTOGRAM_BUCKETS 20    // Последняя корзина - от 262 мс
+
+typedef enum {
+    HISTOGRAM_TICK_JITTER,       // Отклонение интервала такта планировщика от 1 мс (TIM3)
+    HISTOGRAM_COMMAND_LATENCY,   // Прием команды движения - вывод на двигатели
+    HISTOGRAM_TELEMETRY_JITTER,  // Отклонение интервала отправки канала от его периода
+    HISTOGRAM_SENSOR_AGE,        // Возраст отсчета IMU в момент отправки телеметрии
+    HISTOGRAM_COUNT
+} Histogram_Id;
+
+typedef struct {
+    uint32_t counts[HISTOGRAM_BUCKETS];
+    uint32_t max;                // Наибольшее значение (мкс)
+} Histogram;
+
+// Учет одного значения (мкс)
+void Histogram_Record(Histogram_Id id, uint32_t value_us);
+
+// Учет модуля отклонения interval_us от expected_us
+void Histogram_RecordDeviation(Histogram_Id id, uint32_t interval_us, uint32_t expected_us);
+
+// Согласованный снимок гистограммы
+void Histogram_Get(Histogram_Id id, Histogram* out);
+
+// Сброс всех гистограмм
+void Histogram_ResetAll(void);
+
+#endif // HISTOGRAM_H
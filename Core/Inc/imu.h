@@ -4,6 +4,15 @@
 #include "main.h"
 
 #include "imu_types.h"
+#include "imu_decimator.h"
+
+// Потребители потока IMU, у каждого свой дециматор и выходная частота
+typedef enum {
+    IMU_CONSUMER_TELEMETRY,
+    IMU_CONSUMER_CONTROL,
+    IMU_CONSUMER_LOG,
+    IMU_CONSUMER_COUNT
+} IMU_Consumer;
 
 // Инициализация IMU
 void IMU_Init(void);
@@ -11,8 +20,8 @@ void IMU_Init(void);
 // Обновление данных IMU
 void IMU_Update(void);
 
-// Получение текущих данных IMU
-const IMU_Data* IMU_GetData(void);
+// Согласованная копия текущих данных IMU
+void IMU_GetData(IMU_Data* data);
 
 // Калибровка IMU
 void IMU_Calibrate(void);
@@ -29,4 +38,26 @@ uint8_t IMU_IsDataValid(void);
 // Получение состояния инициализации
 uint8_t IMU_IsInitialized(void);
 
+// Установка выходной частоты дециматора потребителя (1..IMU_SAMPLE_RATE_HZ),
+// 0 - дециматор остановлен, IMU_GetFilteredData возвращает 0
+void IMU_SetConsumerRate(IMU_Consumer consumer, uint16_t rate_hz);
+
+// Усредненные за период потребителя данные, 0 если блок еще не набран
+uint8_t IMU_GetFilteredData(IMU_Consumer consumer, IMU_Data* out);
+
+// Включение/выключение захвата сырых отсчетов в кольцевой буфер
+void IMU_SetCaptureEnabled(uint8_t enabled);
+
+// Состояние режима захвата
+uint8_t IMU_IsCaptureEnabled(void);
+
+// Количество отсчетов, ожидающих чтения
+uint16_t IMU_GetCaptureCount(void);
+
+// Чтение до max_samples отсчетов из буфера захвата, возвращает прочитанное количество
+uint16_t IMU_ReadCaptureSamples(IMU_RawSample* out, uint16_t max_samples);
+
+// Количество отсчетов, потерянных из-за переполнения буфера
+uint32_t IMU_GetCaptureDropped(void);
+
 #endif // IMU_H
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef IMU_DECIMATOR_H
+#define IMU_DECIMATOR_H
+
+#include <stdint.h>
+
+// Частота отсчетов MPU-6050: 1 кГц / (1 + SMPLRT_DIV=7)
+#define IMU_SAMPLE_RATE_HZ 125
+
+// Каналы сырого отсчета: акселерометр X/Y/Z, температура, гироскоп X/Y/Z
+#define IMU_RAW_CHANNELS 7
+
+// Дециматор с усреднением: накапливает отсчеты в целочисленных сумматорах
+// и выдает среднее по блоку. Дробный коэффициент (например 125 -> 10 Гц)
+// реализован фазовым накопителем, блоки чередуются по 12 и 13 отсчетов.
+typedef struct {
+    int32_t sum[IMU_RAW_CHANNELS]; // Сумма отсчетов текущего блока
+    uint16_t count;                // Отсчетов в текущем блоке
+    uint16_t phase;                // Фазовый накопитель, шаг = out_rate_hz
+    uint16_t out_rate_hz;          // Выходная частота (1..IMU_SAMPLE_RATE_HZ), 0 - остановлен
+    int16_t out[IMU_RAW_CHANNELS]; // Среднее последнего завершенного блока
+    uint32_t out_timestamp_us;     // Время последнего отсчета блока
+    uint8_t out_valid;             // Есть хотя бы один завершенный блок
+} IMU_Decimator;
+
+// Инициализация дециматора с выходной частотой out_rate_hz. При 0 дециматор
+// остановлен: отсчеты пропускаются, завершенных блоков нет.
+void IMU_Decimator_Init(IMU_Decimator* dec, uint16_t out_rate_hz);
+
+// Добавление отсчета, возвращает 1 если завершен очередной выходной блок
+uint8_t IMU_Decimator_Push(IMU_Decimator* dec, const int16_t sample[IMU_RAW_CHANNELS],
+                           uint32_t timestamp_us);
+
+#endif // IMU_DECIMATOR_H
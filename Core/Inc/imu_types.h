@@ -25,6 +25,17 @@ typedef struct {
     float roll;      // Крен (град)
     float pitch;     // Тангаж (град)
     float yaw;       // Рыскание (град)
+
+    uint32_t timestamp_us; // Время отсчета по Timebase_GetMicros (мкс)
 } IMU_Data;
 
+// Сырой отсчет MPU-6050 с меткой времени (для режима захвата)
+typedef struct {
+    uint32_t timestamp_us; // Время чтения отсчета (мкс)
+    int16_t accel[3];      // Акселерометр X/Y/Z (LSB)
+    int16_t temp;          // Температура (LSB)
+    int16_t gyro[3];       // Гироскоп X/Y/Z (LSB)
+    uint16_t seq;          // Номер отсчета, разрывы = потерянные отсчеты
+} IMU_RawSample;           // 20 байт
+
 #endif /* IMU_TYPES_H */
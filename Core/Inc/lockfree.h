@@ -0,0 +1,279 @@
+#ifndef LOCKFREE_H
+#define LOCKFREE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Примитивы передачи данных между прерываниями и основным циклом без
+// запрета прерываний:
+//   SpscRing       - байтовое кольцо, один писатель и один читатель
+//   SpscRecordRing - кольцо записей фиксированного размера
+//   AtomicFlag     - флаг события: установка в прерывании, взятие со сбросом
+//   EventFlags     - до 32 флагов событий в одном слове
+// Seqlock (снимок структуры целиком) - в seqlock.h, на тех же барьерах.
+//
+// Cortex-M3 выполняет команды по порядку и без кэша данных, но компилятор
+// переставляет обращения к памяти: LOCKFREE_DMB() - барьер и для него, и для
+// процессора. Чтение-модификация-запись общего слова из разных контекстов
+// идет через LDREX/STREX: монитор монопольного доступа сбрасывается при входе
+// в прерывание и выходе из него, и прерванный STREX повторяется.
+//
+// Не зависит от HAL: на хосте (без __arm__) те же операции идут через
+// атомарные встроенные функции GCC.
+
+#if defined(__arm__)
+#include "stm32f1xx.h"
+#define LOCKFREE_DMB() __DMB()
+#else
+#define LOCKFREE_DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+// Атомарное word |= bits, возвращает прежнее значение
+static inline uint32_t Lockfree_FetchOr(volatile uint32_t* word, uint32_t bits) {
+#if defined(__arm__)
+    uint32_t old;
+    do {
+        old = __LDREXW(word);
+    } while (__STREXW(old | bits, word));
+    LOCKFREE_DMB();
+    return old;
+#else
+    return __atomic_fetch_or(word, bits, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Атомарное word &= ~bits, возвращает прежнее значение
+static inline uint32_t Lockfree_FetchClear(volatile uint32_t* word, uint32_t bits) {
+#if defined(__arm__)
+    uint32_t old;
+    do {
+        old = __LDREXW(word);
+    } while (__STREXW(old & ~bits, word));
+    LOCKFREE_DMB();
+    return old;
+#else
+    return __atomic_fetch_and(word, ~bits, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// SpscRing: head пишет только писатель, tail - только читатель. Счетчики
+// считают байты с начала работы и переполняются естественно, размер -
+// степень двойки.
+
+typedef struct {
+    uint8_t* buffer;
+    uint32_t mask;              // Размер - 1
+    volatile uint32_t head;     // Всего записано
+    volatile uint32_t tail;     // Всего прочитано
+} SpscRing;
+
+static inline void SpscRing_Init(SpscRing* ring, uint8_t* buffer, uint32_t size) {
+    ring->buffer = buffer;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+static inline uint32_t SpscRing_Size(const SpscRing* ring) {
+    return ring->mask + 1;
+}
+
+// Непрочитанных байт. Больше размера только после SpscRing_Commit без
+// проверки места (приемник DMA перезаписал непрочитанное).
+static inline uint32_t SpscRing_Count(const SpscRing* ring) {
+    return ring->head - ring->tail;
+}
+
+static inline uint32_t SpscRing_Free(const SpscRing* ring) {
+    return SpscRing_Size(ring) - (ring->head - ring->tail);
+}
+
+// Писатель: запись size байт целиком. 0 - места нет, ничего не записано.
+static inline uint8_t SpscRing_Write(SpscRing* ring, const void* data, uint32_t size) {
+    uint32_t head = ring->head;
+    if (size > SpscRing_Size(ring) - (head - ring->tail)) {
+        return 0;
+    }
+
+    uint32_t offset = head & ring->mask;
+    uint32_t first = SpscRing_Size(ring) - offset;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(&ring->buffer[offset], data, first);
+    memcpy(ring->buffer, (const uint8_t*)data + first, size - first);
+
+    // Данные видны читателю раньше нового head
+    LOCKFREE_DMB();
+    ring->head = head + size;
+    return 1;
+}
+
+// Писатель: запись не больше size байт, возвращает записанное
+static inline uint32_t SpscRing_WritePartial(SpscRing* ring, const void* data, uint32_t size) {
+    uint32_t free = SpscRing_Free(ring);
+    if (size > free) {
+        size = free;
+    }
+    if (size > 0) {
+        SpscRing_Write(ring, data, size);
+    }
+    return size;
+}
+
+// Писатель: публикация size байт, уже записанных в буфер на месте
+// (приемник DMA пишет в кольцо сам)
+static inline void SpscRing_Commit(SpscRing* ring, uint32_t size) {
+    LOCKFREE_DMB();
+    ring->head += size;
+}
+
+// Читатель: непрерывный участок непрочитанных данных от tail до head или
+// до конца буфера. Возвращает длину, 0 - кольцо пусто.
+static inline uint32_t SpscRing_Peek(const SpscRing* ring, const uint8_t** data) {
+    uint32_t tail = ring->tail;
+    uint32_t count = ring->head - tail;
+    // Данные читаются после head
+    LOCKFREE_DMB();
+
+    uint32_t offset = tail & ring->mask;
+    uint32_t length = SpscRing_Size(ring) - offset;
+    if (length > count) {
+        length = count;
+    }
+    *data = &ring->buffer[offset];
+    return length;
+}
+
+// Читатель: освобождение size прочитанных байт
+static inline void SpscRing_Consume(SpscRing* ring, uint32_t size) {
+    // Данные дочитаны раньше, чем писатель увидит освободившееся место
+    LOCKFREE_DMB();
+    ring->tail += size;
+}
+
+// Читатель: чтение до size байт, возвращает прочитанное
+static inline uint32_t SpscRing_Read(SpscRing* ring, void* data, uint32_t size) {
+    uint32_t done = 0;
+    const uint8_t* chunk;
+    uint32_t length;
+
+    while (done < size && (length = SpscRing_Peek(ring, &chunk)) > 0) {
+        if (length > size - done) {
+            length = size - done;
+        }
+        memcpy((uint8_t*)data + done, chunk, length);
+        SpscRing_Consume(ring, length);
+        done += length;
+    }
+    return done;
+}
+
+// ---------------------------------------------------------------------------
+// SpscRecordRing: записи record_size байт, число записей - степень двойки.
+// Счетчики head/tail считают записи.
+
+typedef struct {
+    uint8_t* buffer;
+    uint16_t record_size;
+    uint32_t mask;              // Число записей - 1
+    volatile uint32_t head;
+    volatile uint32_t tail;
+} SpscRecordRing;
+
+static inline void SpscRecordRing_Init(SpscRecordRing* ring, void* buffer,
+                                       uint16_t record_size, uint32_t count) {
+    ring->buffer = (uint8_t*)buffer;
+    ring->record_size = record_size;
+    ring->mask = count - 1;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+static inline uint32_t SpscRecordRing_Count(const SpscRecordRing* ring) {
+    return ring->head - ring->tail;
+}
+
+// Писатель: 0 - кольцо заполнено, запись не добавлена
+static inline uint8_t SpscRecordRing_Push(SpscRecordRing* ring, const void* record) {
+    uint32_t head = ring->head;
+    if (head - ring->tail > ring->mask) {
+        return 0;
+    }
+    memcpy(&ring->buffer[(head & ring->mask) * ring->record_size], record, ring->record_size);
+    LOCKFREE_DMB();
+    ring->head = head + 1;
+    return 1;
+}
+
+// Читатель: до max записей подряд в out, возвращает число прочитанных
+static inline uint32_t SpscRecordRing_Read(SpscRecordRing* ring, void* out, uint32_t max) {
+    uint32_t tail = ring->tail;
+    uint32_t count = ring->head - tail;
+    LOCKFREE_DMB();
+
+    if (count > max) {
+        count = max;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        memcpy((uint8_t*)out + i * ring->record_size,
+               &ring->buffer[((tail + i) & ring->mask) * ring->record_size], ring->record_size);
+    }
+
+    LOCKFREE_DMB();
+    ring->tail = tail + count;
+    return count;
+}
+
+// Читатель: сброс всех непрочитанных записей
+static inline void SpscRecordRing_Clear(SpscRecordRing* ring) {
+    ring->tail = ring->head;
+}
+
+// ---------------------------------------------------------------------------
+// AtomicFlag: событие «произошло хотя бы раз». Повторная установка до
+// взятия не теряется и не копится.
+
+typedef struct {
+    volatile uint32_t value;
+} AtomicFlag;
+
+static inline void AtomicFlag_Set(AtomicFlag* flag) {
+    LOCKFREE_DMB();
+    flag->value = 1;
+}
+
+// 1 если флаг был установлен; флаг сбрасывается
+static inline uint8_t AtomicFlag_Take(AtomicFlag* flag) {
+    if (!flag->value) {
+        return 0;
+    }
+    return (uint8_t)Lockfree_FetchClear(&flag->value, 1U);
+}
+
+// ---------------------------------------------------------------------------
+// EventFlags: набор флагов в одном слове, установка из любого контекста,
+// взятие со сбросом - в основном цикле.
+
+typedef struct {
+    volatile uint32_t bits;
+} EventFlags;
+
+static inline void EventFlags_Set(EventFlags* events, uint32_t mask) {
+    Lockfree_FetchOr(&events->bits, mask);
+}
+
+// Установленные флаги из mask; взятые флаги сбрасываются
+static inline uint32_t EventFlags_Take(EventFlags* events, uint32_t mask) {
+    if (!(events->bits & mask)) {
+        return 0;
+    }
+    return Lockfree_FetchClear(&events->bits, mask) & mask;
+}
+
+static inline uint32_t EventFlags_Peek(const EventFlags* events) {
+    return events->bits;
+}
+
+#endif // LOCKFREE_H
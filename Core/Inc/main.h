@@ -50,7 +50,38 @@ extern PCD_HandleTypeDef hpcd_USB_FS;
 
 /* Exported constants --------------------------------------------------------*/
 /* USER CODE BEGIN EC */
+// Профиль тактирования от кварца 8 МГц:
+//   SYSCLK_PROFILE_72MHZ = 1 - PLL x9, 72 МГц, 2 такта ожидания flash,
+//                             USB 72 / 1.5 = 48 МГц, АЦП 72 / 6 = 12 МГц
+//   SYSCLK_PROFILE_72MHZ = 0 - PLL x6, 48 МГц, 1 такт ожидания flash,
+//                             USB 48 / 1 = 48 МГц, АЦП 48 / 4 = 12 МГц
+// В обоих профилях APB1 = HCLK / 2 (не больше 36 МГц), APB2 = HCLK.
+// Предделители таймеров вычисляются по частотам шин (TIM_PrescalerFor).
+//
+// SYSCLK_* подставлены в SystemClock_Config вне блоков USER CODE: при
+// генерации кода CubeMX запишет туда значения из Sojourner_DCU.ioc (там
+// дерево профиля 72 МГц: PLL x9, USB /1.5, АЦП /6). После генерации макросы
+// нужно вернуть, а профиль 48 МГц - выставить и в .ioc. Проверка в main()
+// (USER CODE SysInit) останавливает запуск, если частота не совпала с
+// профилем. Предделители TIM2/TIM3 выставляются в блоках USER CODE tim.c
+// поверх значений .ioc и генерацией не затираются.
+#ifndef SYSCLK_PROFILE_72MHZ
+#define SYSCLK_PROFILE_72MHZ 1
+#endif
 
+#if SYSCLK_PROFILE_72MHZ
+#define SYSCLK_HZ             72000000U
+#define SYSCLK_PLL_MUL        RCC_PLL_MUL9
+#define SYSCLK_FLASH_LATENCY  FLASH_LATENCY_2
+#define SYSCLK_USB_CLOCK      RCC_USBCLKSOURCE_PLL_DIV1_5
+#define SYSCLK_ADC_CLOCK      RCC_ADCPCLK2_DIV6
+#else
+#define SYSCLK_HZ             48000000U
+#define SYSCLK_PLL_MUL        RCC_PLL_MUL6
+#define SYSCLK_FLASH_LATENCY  FLASH_LATENCY_1
+#define SYSCLK_USB_CLOCK      RCC_USBCLKSOURCE_PLL
+#define SYSCLK_ADC_CLOCK      RCC_ADCPCLK2_DIV4
+#endif
 /* USER CODE END EC */
 
 /* Exported macro ------------------------------------------------------------*/
@@ -0,0 +1,42 @@
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <stdint.h>
+
+// Контроль RAM (20 КБ): глубина стека MSP и куча newlib.
+//
+//   [.data .bss][куча ->       свободно        <- стек MSP]
+//   _sdata      _end                                _estack
+//
+// MemoryMonitor_Init при старте заполняет свободную область между концом
+// кучи и текущей вершиной стека образцом MEMORY_MONITOR_PAINT. Фоновый
+// просмотр (MemoryMonitor_Update) ищет самое нижнее слово, затертое стеком:
+// это наибольшая глубина стека с запуска, вместе с вложенными прерываниями.
+// Оценка по цепочкам вызовов из файлов .su - Tools/stack_report.py.
+
+#define MEMORY_MONITOR_PAINT      0xA5A5A5A5U
+#define MEMORY_MONITOR_SCAN_WORDS 128  // Слов за вызов MemoryMonitor_Update
+#define MEMORY_MONITOR_GUARD      64   // Не окрашивается ниже вершины стека при окраске (байт)
+
+typedef struct {
+    uint32_t static_ram;      // .data + .bss (байт)
+    uint32_t heap_used;       // Выделено через _sbrk
+    uint32_t heap_failures;   // Отказов _sbrk (куча уперлась в резерв стека)
+    uint32_t stack_peak;      // Наибольшая глубина стека с запуска
+    uint32_t stack_reserved;  // _Min_Stack_Size из скрипта компоновщика
+    uint32_t free_min;        // Ни разу не использованная RAM между кучей и стеком
+} MemoryMonitor_Stats;
+
+// Окраска свободной RAM, вызывать в начале main
+void MemoryMonitor_Init(void);
+
+// Просмотр очередных MEMORY_MONITOR_SCAN_WORDS слов окрашенной области
+void MemoryMonitor_Update(void);
+
+void MemoryMonitor_GetStats(MemoryMonitor_Stats* stats);
+
+// Учет кучи в sysmem.c: текущий конец кучи и число отказов _sbrk
+uint8_t* Sysmem_GetHeapEnd(void);
+uint32_t Sysmem_GetFailures(void);
+
+#endif // MEMORY_MONITOR_H
@@ -35,6 +35,13 @@ void MotorControl_Init(void);
 // Установка состояния двигателя
 void MotorControl_SetMotorState(MotorID motor, MotorState state);
 
+// Текущее состояние двигателя
+MotorState MotorControl_GetMotorState(MotorID motor);
+
+// Состояние двигателей движения левого и правого борта одним обновлением
+// сдвиговых регистров
+void MotorControl_SetDrive(MotorState left, MotorState right);
+
 // Обновление состояния всех двигателей
 void MotorControl_Update(void);
 
@@ -0,0 +1,36 @@
+#ifndef NAV_H
+#define NAV_H
+
+#include "main.h"
+#include "nav_ekf.h"
+
+// Курс GPS принимается как курс корпуса только на этой скорости и выше (м/с)
+#define NAV_HEADING_MIN_SPEED 1.0f
+
+// Пропуск отсчетов IMU дольше этого интервала перезапускает шаг прогноза (с)
+#define NAV_MAX_PREDICT_DT    0.2f
+
+// Оценка положения и скорости ровера
+typedef struct {
+    float north;           // Смещение от точки первого решения GPS (м)
+    float east;
+    float vel_north;       // Скорость (м/с)
+    float vel_east;
+    float heading;         // Курс (градусы, 0..360)
+    int32_t latitude_e7;   // Координаты оценки (градусы * 1e7)
+    int32_t longitude_e7;
+    uint32_t timestamp_us; // Время отсчета IMU последнего прогноза
+    uint8_t valid;         // Фильтр инициализирован первым решением GPS
+} Nav_State;
+
+// Инициализация фильтра
+void Nav_Init(void);
+
+// Прогноз по новым отсчетам IMU (поток IMU_CONSUMER_CONTROL, 50 Гц)
+// и коррекция по новым решениям GPS
+void Nav_Update(void);
+
+// Текущая оценка
+void Nav_GetState(Nav_State* state);
+
+#endif // NAV_H
@@ -0,0 +1,72 @@
+#ifndef NAV_EKF_H
+#define NAV_EKF_H
+
+#include <stdint.h>
+
+// Слабосвязанный расширенный фильтр Калмана GPS/IMU в плоскости.
+// Состояние: x = [pN, pE, vN, vE, psi] - позиция (м) и скорость (м/с)
+// в локальной системе север/восток от точки первого решения GPS,
+// курс psi (рад, по часовой от севера).
+//
+// Прогноз: ускорение в осях ровера поворачивается на psi, psi интегрируется
+// по угловой скорости гироскопа. Коррекция: позиция, скорость и курс GPS
+// последовательными скалярными обновлениями (без обращения матриц).
+//
+// Не зависит от HAL, собирается и на хосте (Tools/ekf_replay.c).
+//
+// Бюджет на Cortex-M3 с программной плавающей точкой (__aeabi_fmul ~35,
+// __aeabi_fadd ~45, __aeabi_fdiv ~110 тактов, sinf/cosf ~1500 тактов):
+//   NavEkf_Predict        ~70 умножений + ~80 сложений + sinf/cosf  ~9 000 тактов
+//   скалярное обновление  ~35 умножений + ~35 сложений + 1 деление  ~3 000 тактов
+//   NavEkf_UpdatePosition 2 скалярных обновления                    ~6 000 тактов
+//   NavEkf_UpdateVelocity 2 скалярных обновления + sinf/cosf        ~9 000 тактов
+// Прогноз на 50 Гц - около 0.45 мс из каждых 20 мс (~1% ЦП на 48 МГц, ~0.7% на 72 МГц).
+
+#define NAV_EKF_STATES 5
+
+// Индексы состояния
+#define NAV_EKF_PN  0
+#define NAV_EKF_PE  1
+#define NAV_EKF_VN  2
+#define NAV_EKF_VE  3
+#define NAV_EKF_PSI 4
+
+// Шумы модели и измерений по умолчанию (СКО)
+#define NAV_EKF_ACCEL_NOISE    0.5f   // м/с^2, включает наклон корпуса
+#define NAV_EKF_GYRO_NOISE     0.02f  // рад/с
+#define NAV_EKF_GPS_POS_NOISE  2.5f   // м
+#define NAV_EKF_GPS_VEL_NOISE  0.3f   // м/с
+#define NAV_EKF_GPS_HDG_NOISE  0.1f   // рад, курс по вектору скорости
+
+typedef struct {
+    float x[NAV_EKF_STATES];
+    float P[NAV_EKF_STATES][NAV_EKF_STATES];
+
+    // Начало локальной системы координат (первое решение GPS)
+    int32_t origin_lat_e7;
+    int32_t origin_lon_e7;
+    float meters_per_e7_lat;
+    float meters_per_e7_lon;
+    uint8_t initialized;
+
+    // Статистика
+    uint32_t predicts;
+    uint32_t updates;
+    uint32_t rejected;     // Измерения, отброшенные по величине невязки
+} NavEkf;
+
+void NavEkf_Init(NavEkf* ekf);
+
+// Прогноз на dt секунд: ускорения в осях ровера (вперед, вправо), м/с^2,
+// угловая скорость рыскания (по часовой), рад/с
+void NavEkf_Predict(NavEkf* ekf, float dt, float accel_fwd, float accel_right, float yaw_rate);
+
+// Коррекция по координатам GPS (градусы * 1e7). Первое решение задает начало
+// локальной системы и инициализирует фильтр.
+void NavEkf_UpdatePosition(NavEkf* ekf, int32_t lat_e7, int32_t lon_e7);
+
+// Коррекция по путевой скорости (м/с) и курсу GPS (рад). Курс используется
+// как измерение psi только при движении быстрее min_speed.
+void NavEkf_UpdateVelocity(NavEkf* ekf, float speed, float course, float min_speed);
+
+#endif // NAV_EKF_H
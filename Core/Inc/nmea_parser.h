@@ -0,0 +1,137 @@
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <stdint.h>
+
+// Потоковый разбор NMEA 0183: байт за байтом, без копирования полей.
+// Не зависит от HAL, собирается и на хосте (Tools/nmea_bench.c).
+
+// По стандарту предложение не длиннее 82 символов, запас для приемников
+// с повышенной точностью координат
+#define NMEA_MAX_SENTENCE 96
+#define NMEA_MAX_FIELDS   24
+
+typedef enum {
+    NMEA_STATE_IDLE = 0,     // Ожидание '$'
+    NMEA_STATE_BODY,         // Поля предложения
+    NMEA_STATE_CHECKSUM_HI,  // Первая цифра после '*'
+    NMEA_STATE_CHECKSUM_LO,  // Вторая цифра после '*'
+    NMEA_STATE_SKIP          // Неподписанное предложение, ждем конца строки
+} NMEA_State;
+
+typedef struct {
+    char line[NMEA_MAX_SENTENCE + 1];    // Тело без '$', запятые заменены на '\0'
+    uint8_t field_start[NMEA_MAX_FIELDS]; // Смещения полей в line
+    uint8_t field_count;
+    uint8_t length;
+    uint8_t checksum;                     // XOR символов между '$' и '*'
+    uint8_t received_checksum;
+    uint8_t state;                        // NMEA_State
+    uint8_t sentence_type;                // NMEA_SentenceType по адресу предложения
+    uint32_t subscriptions;               // Маска NMEA_SENTENCE_BIT принимаемых типов
+
+    // Статистика
+    uint32_t sentences;                   // Принято с верной контрольной суммой
+    uint32_t checksum_errors;
+    uint32_t format_errors;               // Переполнение, нет '*', неверные hex-цифры
+    uint32_t skipped;                     // Отброшено по заголовку (нет подписки)
+} NMEA_Parser;
+
+// Тип разобранного предложения (независимо от источника GP/GN/GL/GA/GB)
+typedef enum {
+    NMEA_SENTENCE_NONE = 0,
+    NMEA_SENTENCE_RMC,
+    NMEA_SENTENCE_GGA,
+    NMEA_SENTENCE_GSA,
+    NMEA_SENTENCE_GSV,
+    NMEA_SENTENCE_VTG,
+    NMEA_SENTENCE_COUNT
+} NMEA_SentenceType;
+
+// Маска подписки на типы предложений
+#define NMEA_SENTENCE_BIT(type) (1U << (type))
+#define NMEA_SUBSCRIBE_ALL      (((1U << NMEA_SENTENCE_COUNT) - 1U) & ~NMEA_SENTENCE_BIT(NMEA_SENTENCE_NONE))
+
+// Источник предложения (talker ID)
+typedef enum {
+    NMEA_TALKER_UNKNOWN = 0,
+    NMEA_TALKER_GPS,      // GP
+    NMEA_TALKER_GLONASS,  // GL
+    NMEA_TALKER_GALILEO,  // GA
+    NMEA_TALKER_BEIDOU,   // GB, BD
+    NMEA_TALKER_GNSS      // GN - комбинированное решение
+} NMEA_Talker;
+
+// Спутников в одном предложении GSV
+#define NMEA_GSV_SATS_PER_MSG 4
+
+// Спутник из предложения GSV
+typedef struct {
+    uint8_t prn;
+    uint8_t elevation;     // Угол места (градусы)
+    uint16_t azimuth;      // Азимут (градусы)
+    uint8_t snr;           // Сигнал/шум (дБГц), 0 если спутник не отслеживается
+} NMEA_Satellite;
+
+// Флаги полей, присутствующих в последнем предложении
+#define NMEA_FIX_TIME       (1U << 0)
+#define NMEA_FIX_DATE       (1U << 1)
+#define NMEA_FIX_POSITION   (1U << 2)
+#define NMEA_FIX_ALTITUDE   (1U << 3)
+#define NMEA_FIX_SPEED      (1U << 4)
+#define NMEA_FIX_COURSE     (1U << 5)
+#define NMEA_FIX_SATELLITES (1U << 6)
+#define NMEA_FIX_STATUS     (1U << 7)
+#define NMEA_FIX_DOP        (1U << 8)
+#define NMEA_FIX_SKY        (1U << 9)   // Заполнены поля gsv_* и sats
+
+// Данные предложения в целочисленном виде
+typedef struct {
+    uint32_t valid;        // NMEA_FIX_*
+    uint32_t time_ms;      // Время UTC от начала суток (мс)
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    int32_t latitude_e7;   // Широта (градусы * 1e7)
+    int32_t longitude_e7;  // Долгота (градусы * 1e7)
+    int32_t altitude_cm;   // Высота над уровнем моря (см)
+    uint32_t speed_mmps;   // Скорость (мм/с)
+    uint16_t course_e2;    // Курс (градусы * 100)
+    uint8_t satellites;
+    uint8_t fix;           // RMC: 1 = 'A'; GGA: качество фиксации
+    uint8_t talker;        // NMEA_Talker
+    uint8_t fix_mode;      // GSA: 1 = нет, 2 = 2D, 3 = 3D
+    uint16_t pdop_e2;      // GSA: факторы точности * 100
+    uint16_t hdop_e2;
+    uint16_t vdop_e2;
+    uint8_t gsv_total;     // GSV: число предложений в серии
+    uint8_t gsv_index;     // GSV: номер предложения (с 1)
+    uint8_t in_view;       // GSV: спутников в зоне видимости
+    uint8_t sat_count;     // GSV: заполнено элементов sats
+    NMEA_Satellite sats[NMEA_GSV_SATS_PER_MSG];
+} NMEA_Fix;
+
+// Сброс состояния и статистики, подписка на все разбираемые типы
+void NMEA_Init(NMEA_Parser* parser);
+
+// Подписка на типы предложений (маска NMEA_SENTENCE_BIT). Предложения других
+// типов отбрасываются сразу после адреса, без копирования и контрольной суммы.
+void NMEA_SetSubscriptions(NMEA_Parser* parser, uint32_t mask);
+
+// Тип предложения по трехсимвольному коду ("RMC", "GGA", ...)
+NMEA_SentenceType NMEA_SentenceFromCode(const char* code);
+
+// Сброс незавершенного предложения (статистика сохраняется)
+void NMEA_Reset(NMEA_Parser* parser);
+
+// Разбор очередного байта, возвращает 1 когда принято предложение с верной
+// контрольной суммой. Поля доступны до прихода следующего '$'.
+uint8_t NMEA_ParseByte(NMEA_Parser* parser, uint8_t byte);
+
+// Поле по номеру (0 - адрес, например "GNRMC"), пустая строка если поля нет
+const char* NMEA_GetField(const NMEA_Parser* parser, uint8_t index);
+
+// Разбор полей принятого предложения в fix (fix->valid перезаписывается)
+NMEA_SentenceType NMEA_DecodeSentence(const NMEA_Parser* parser, NMEA_Fix* fix);
+
+#endif // NMEA_PARSER_H
@@ -0,0 +1,76 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+// Профилирование по счетчику тактов DWT CYCCNT ядра Cortex-M3: число
+// вызовов и min/среднее/max тактов для задач планировщика, обработчиков
+// прерываний и отдельных участков кода.
+//
+//   PROFILE_BEGIN(PROFILE_ISR_USB);
+//   ...
+//   PROFILE_END(PROFILE_ISR_USB);
+//
+// Каждую точку пишет только один контекст (свое прерывание или основной
+// цикл), поэтому запись идет без блокировок. На хосте (Tools/, без
+// __arm__) те же макросы считают наносекунды монотонных часов.
+
+typedef enum {
+    // Обработчики прерываний (stm32f1xx_it.c)
+    PROFILE_ISR_USART2,
+    PROFILE_ISR_DMA1_CH6,
+    PROFILE_ISR_I2C1,
+    PROFILE_ISR_ADC,
+    PROFILE_ISR_USB,
+    PROFILE_ISR_TIM2,
+    PROFILE_ISR_TIM3,
+
+    // Участки кода
+    PROFILE_IMU_READ,       // Чтение отсчета MPU-6050 по I2C
+    PROFILE_NMEA_DECODE,    // Разбор полей предложения и применение решения
+    PROFILE_MOTOR_UPDATE,   // Вывод состояний в сдвиговые регистры
+    PROFILE_FRAME_ENCODE,   // Кодирование кадра в блок передачи USB
+
+    // Задачи планировщика в порядке таблицы
+    PROFILE_TASK_FIRST,
+    PROFILE_TASK_LAST = PROFILE_TASK_FIRST + 7,
+
+    PROFILE_COUNT
+} Profile_Id;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t min;           // Такты (на хосте - нс)
+    uint32_t max;
+    uint64_t total;
+} Profile_Stats;
+
+#if defined(__arm__)
+#include "stm32f1xx.h"
+
+static inline uint32_t Profile_Now(void) {
+    return DWT->CYCCNT;
+}
+#else
+uint32_t Profile_Now(void);
+#endif
+
+#define PROFILE_BEGIN(id) uint32_t profile_start_##id = Profile_Now()
+#define PROFILE_END(id)   Profile_Record((id), Profile_Now() - profile_start_##id)
+
+// Включение счетчика CYCCNT и сброс статистики
+void Profile_Init(void);
+
+// Учет одного измерения
+void Profile_Record(Profile_Id id, uint32_t cycles);
+
+// Согласованный снимок статистики точки
+void Profile_GetStats(Profile_Id id, Profile_Stats* stats);
+
+// Частота счетчика: тактов в секунду
+uint32_t Profile_GetClockHz(void);
+
+// Сброс статистики всех точек
+void Profile_Reset(void);
+
+#endif // PROFILE_H
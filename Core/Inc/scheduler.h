@@ -0,0 +1,79 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "main.h"
+
+// Кооперативный планировщик с фиксированными периодами. Такт 1 кГц от TIM3
+// (Scheduler_Tick из HAL_TIM_PeriodElapsedCallback) только считает время,
+// задачи выполняются в основном цикле по одной, до завершения, начиная с
+// наиболее приоритетной из готовых. Поэтому задача высшего приоритета
+// ждет не дольше самой длинной из уже начатых задач.
+//
+// Кроме срока, задачу будит событие из прерывания (Scheduler_PostEvent):
+// она запускается в ближайшем цикле, не дожидаясь своего периода. Когда
+// готовых задач нет, Scheduler_Idle останавливает ядро (WFI) до следующего
+// прерывания; доля времени в WFI - запас ЦП.
+
+#define SCHEDULER_TICK_HZ   1000
+#define SCHEDULER_MAX_TASKS 8
+
+// Окно усреднения доли простоя (мкс)
+#define SCHEDULER_LOAD_WINDOW_US 1000000U
+
+// События прерываний для поля events задачи
+#define SCHEDULER_EVENT_USB_RX (1U << 0)  // Приняты данные USB CDC
+#define SCHEDULER_EVENT_GPS_RX (1U << 1)  // DMA приемника GPS передал байты
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+    uint16_t period_ms;
+    uint16_t phase_ms;      // Первый запуск: разносит задачи одного периода по тактам
+    uint16_t deadline_ms;   // Завершение позже срока + deadline_ms считается перерасходом
+    uint8_t priority;       // 0 - высший
+    uint32_t events;        // SCHEDULER_EVENT_*, внеочередной запуск по событию
+} Scheduler_Task;
+
+typedef struct {
+    uint32_t runs;
+    uint32_t event_runs;     // Из них внеочередных, по событию
+    uint32_t overruns;       // Завершений позже дедлайна
+    uint32_t skipped;        // Периодов, пропущенных целиком
+    uint32_t max_latency_us; // Наибольшая задержка старта от срока
+    uint32_t last_exec_us;
+    uint32_t max_exec_us;
+} Scheduler_Stats;
+
+// Таблица задач (не копируется, должна жить все время работы)
+void Scheduler_Init(const Scheduler_Task* tasks, uint8_t count);
+
+// Такт планировщика (прерывание TIM3)
+void Scheduler_Tick(void);
+
+// Выполнение одной готовой задачи. 0 - готовых задач нет.
+uint8_t Scheduler_Dispatch(void);
+
+// Событие для задач (из прерывания или основного цикла)
+void Scheduler_PostEvent(uint32_t events);
+
+// Сон до следующего прерывания, если с последнего Scheduler_Dispatch,
+// вернувшего 0, не было ни такта, ни события
+void Scheduler_Idle(void);
+
+// Доля простоя ЦП за последнее окно SCHEDULER_LOAD_WINDOW_US (0.1%)
+uint16_t Scheduler_GetIdlePermille(void);
+
+// Тактов с запуска
+uint32_t Scheduler_GetTicks(void);
+
+uint8_t Scheduler_GetTaskCount(void);
+
+const char* Scheduler_GetTaskName(uint8_t index);
+
+// Статистика задачи. 0 - нет задачи с таким номером.
+uint8_t Scheduler_GetStats(uint8_t index, Scheduler_Stats* stats);
+
+// Сумма перерасходов по всем задачам
+uint32_t Scheduler_GetTotalOverruns(void);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,68 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include "lockfree.h"
+#include <stddef.h>
+#include <string.h>
+
+// Seqlock: один писатель публикует структуру целиком, читатели получают
+// согласованную копию без запрета прерываний.
+//
+// Писатель увеличивает счетчик до и после записи (нечетное значение - идет
+// запись). Читатель копирует данные и повторяет копирование, если счетчик
+// был нечетным или изменился за время чтения.
+//
+// Писатель может работать в прерывании, а читатель в основном цикле, но не
+// наоборот: читатель в прерывании будет бесконечно ждать прерванного писателя.
+// Не зависит от HAL (барьеры из lockfree.h).
+
+typedef struct {
+    volatile uint32_t sequence;
+} Seqlock;
+
+static inline void Seqlock_Init(Seqlock* lock) {
+    lock->sequence = 0;
+}
+
+static inline void Seqlock_WriteBegin(Seqlock* lock) {
+    lock->sequence++;
+    LOCKFREE_DMB();
+}
+
+static inline void Seqlock_WriteEnd(Seqlock* lock) {
+    LOCKFREE_DMB();
+    lock->sequence++;
+}
+
+static inline uint32_t Seqlock_ReadBegin(const Seqlock* lock) {
+    uint32_t sequence;
+    do {
+        sequence = lock->sequence;
+    } while (sequence & 1U);
+    LOCKFREE_DMB();
+    return sequence;
+}
+
+// 1 если за время чтения данные изменились и копию нужно повторить
+static inline uint8_t Seqlock_ReadRetry(const Seqlock* lock, uint32_t sequence) {
+    LOCKFREE_DMB();
+    return lock->sequence != sequence;
+}
+
+// Публикация копии src в защищенную структуру dst
+static inline void Seqlock_Write(Seqlock* lock, void* dst, const void* src, size_t size) {
+    Seqlock_WriteBegin(lock);
+    memcpy(dst, src, size);
+    Seqlock_WriteEnd(lock);
+}
+
+// Согласованная копия защищенной структуры src в dst
+static inline void Seqlock_Read(const Seqlock* lock, void* dst, const void* src, size_t size) {
+    uint32_t sequence;
+    do {
+        sequence = Seqlock_ReadBegin(lock);
+        memcpy(dst, src, size);
+    } while (Seqlock_ReadRetry(lock, sequence));
+}
+
+#endif // SEQLOCK_H
@@ -0,0 +1,43 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "main.h"
+
+// Телеметрия по подписке: хост выбирает каналы и частоту каждого
+// (команда SUB:<канал>:<Гц>). Каждый канал планируется отдельно, кадр
+// собирается только для каналов, срок которых наступил.
+
+#define TELEMETRY_MAX_RATE_HZ 100
+
+typedef enum {
+    TELEMETRY_CH_IMU,       // Ускорения, угловые скорости, привязка к UTC
+    TELEMETRY_CH_ATTITUDE,  // Крен, тангаж, рыскание
+    TELEMETRY_CH_GPS,       // Решение приемника
+    TELEMETRY_CH_HALL,      // Углы поворотных колес
+    TELEMETRY_CH_MOTOR,     // Состояния двигателей
+    TELEMETRY_CH_DIAG,      // Счетчики потерь, задержки команд, синхронизация
+    TELEMETRY_CH_NAV,       // Оценка фильтра GPS/IMU
+    TELEMETRY_CH_PROFILE,   // Время выполнения задач и прерываний (profile.h)
+    TELEMETRY_CH_COUNT
+} Telemetry_Channel;
+
+// Подписки по умолчанию: прежний состав кадра на 10 Гц, диагностика 1 Гц
+void Telemetry_Init(void);
+
+// Частота канала (0 - отписка, не выше TELEMETRY_MAX_RATE_HZ).
+// Возвращает установленную частоту.
+uint16_t Telemetry_SetRate(Telemetry_Channel channel, uint16_t rate_hz);
+
+uint16_t Telemetry_GetRate(Telemetry_Channel channel);
+
+// Канал по имени (IMU, ATT, GPS, HALL, MOTOR, DIAG, NAV, PROF), TELEMETRY_CH_COUNT
+// если имя неизвестно
+Telemetry_Channel Telemetry_ChannelFromName(const char* name, uint16_t length);
+
+// Отправка всех подписанных каналов при следующем Telemetry_Update
+void Telemetry_RequestAll(void);
+
+// Отправка каналов, срок которых наступил (основной цикл)
+void Telemetry_Update(void);
+
+#endif // TELEMETRY_H
@@ -37,14 +37,19 @@ extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim3;
 
 /* USER CODE BEGIN Private defines */
-
+// Частота счета TIM2 (захват PPS) и TIM3 (такт планировщика)
+#define TIM_COUNT_HZ 1000000U
 /* USER CODE END Private defines */
 
 void MX_TIM2_Init(void);
 void MX_TIM3_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+// Частота тактирования таймера (Гц) по текущим настройкам RCC
+uint32_t TIM_GetClockHz(TIM_TypeDef* instance);
 
+// Предделитель (значение регистра PSC) для счета с частотой count_hz
+uint32_t TIM_PrescalerFor(TIM_TypeDef* instance, uint32_t count_hz);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
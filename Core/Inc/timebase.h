@@ -0,0 +1,50 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include "main.h"
+
+// Допуск интервала между импульсами PPS (мкс)
+#define TIMEBASE_PPS_TOLERANCE_US 1000
+// Без импульсов PPS дольше этого времени шкала переходит в режим удержания
+#define TIMEBASE_PPS_HOLDOVER_US  2500000
+
+// Состояние привязки локального времени к UTC
+typedef enum {
+    TIMEBASE_SYNC_NONE = 0,   // Нет PPS или еще не получено время от GPS
+    TIMEBASE_SYNC_LOCKED,     // Последний импульс PPS не старше TIMEBASE_PPS_HOLDOVER_US
+    TIMEBASE_SYNC_HOLDOVER    // PPS пропал, время экстраполируется по последней оценке
+} Timebase_SyncState;
+
+// Время UTC: секунды Unix и микросекунды внутри секунды
+typedef struct {
+    uint32_t seconds;
+    uint32_t micros;
+} Timebase_UtcTime;
+
+// Текущее время в микросекундах: счетчик TIM2 (1 МГц) и число его
+// переполнений. Безопасно из любого прерывания, несколько десятков тактов.
+// Переполняется примерно раз в 71 минуту, сравнивать только разностями.
+// Метки отсчетов и кадров - эти 32 бита, продолжение за переполнение
+// восстанавливает хост (frame.h).
+uint32_t Timebase_GetMicros(void);
+
+// Переполнение TIM2, вызывается из TIM2_IRQHandler до HAL_TIM_IRQHandler
+void Timebase_OnOverflow(void);
+
+// Запуск шкалы времени и захвата PPS на TIM2_CH1 (PA0)
+void Timebase_Init(void);
+
+// Время UTC от GPS (секунды Unix и миллисекунды решения).
+// Решение с нулевыми миллисекундами привязывает следующий импульс PPS.
+void Timebase_SetGpsTime(uint32_t unix_seconds, uint16_t millisecond);
+
+// Перевод локального времени Timebase_GetMicros в UTC
+Timebase_SyncState Timebase_ToUtc(uint32_t local_us, Timebase_UtcTime* utc);
+
+// Оценка ухода локального генератора относительно PPS (ppm * 1000)
+int32_t Timebase_GetDriftPpb(void);
+
+// Секунды Unix для даты и времени UTC
+uint32_t Timebase_MakeUnixTime(uint16_t year, uint8_t month, uint8_t day, uint32_t seconds_of_day);
+
+#endif // TIMEBASE_H
@@ -0,0 +1,111 @@
+#ifndef UBX_H
+#define UBX_H
+
+#include <stdint.h>
+
+// Бинарный протокол u-blox UBX: разбор кадров и сборка команд CFG.
+// Не зависит от HAL, передачу выполняет gps.c.
+
+#define UBX_SYNC1 0xB5
+#define UBX_SYNC2 0x62
+
+// Классы и идентификаторы сообщений
+#define UBX_CLASS_NAV     0x01
+#define UBX_CLASS_ACK     0x05
+#define UBX_CLASS_CFG     0x06
+#define UBX_CLASS_NMEA    0xF0
+
+#define UBX_NAV_PVT       0x07
+#define UBX_ACK_NAK       0x00
+#define UBX_ACK_ACK       0x01
+#define UBX_CFG_PRT       0x00
+#define UBX_CFG_MSG       0x01
+#define UBX_CFG_RATE      0x08
+
+#define UBX_NMEA_GGA      0x00
+#define UBX_NMEA_GLL      0x01
+#define UBX_NMEA_GSA      0x02
+#define UBX_NMEA_GSV      0x03
+#define UBX_NMEA_RMC      0x04
+#define UBX_NMEA_VTG      0x05
+
+#define UBX_NAV_PVT_LEN   92
+#define UBX_MAX_PAYLOAD   UBX_NAV_PVT_LEN  // Более длинные сообщения пропускаются
+#define UBX_FRAME_OVERHEAD 8               // sync(2) + class + id + len(2) + ck(2)
+
+typedef enum {
+    UBX_STATE_SYNC1 = 0,
+    UBX_STATE_SYNC2,
+    UBX_STATE_CLASS,
+    UBX_STATE_ID,
+    UBX_STATE_LEN1,
+    UBX_STATE_LEN2,
+    UBX_STATE_PAYLOAD,
+    UBX_STATE_CK_A,
+    UBX_STATE_CK_B
+} UBX_State;
+
+typedef struct {
+    uint8_t payload[UBX_MAX_PAYLOAD];
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint16_t length;
+    uint16_t index;
+    uint8_t ck_a;          // Контрольная сумма Флетчера по class..payload
+    uint8_t ck_b;
+    uint8_t state;         // UBX_State
+
+    // Статистика
+    uint32_t frames;
+    uint32_t checksum_errors;
+    uint32_t oversize;     // Сообщения длиннее UBX_MAX_PAYLOAD
+} UBX_Parser;
+
+// Решение навигационной задачи (NAV-PVT), поля в единицах приемника
+typedef struct {
+    uint32_t itow_ms;      // Время недели GPS (мс)
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t valid;         // Биты 0/1: дата/время достоверны
+    int32_t nano;          // Доля секунды (нс, со знаком)
+    uint8_t fix_type;      // 0 нет, 2 = 2D, 3 = 3D
+    uint8_t flags;         // Бит 0: gnssFixOK
+    uint8_t num_sv;
+    int32_t longitude_e7;
+    int32_t latitude_e7;
+    int32_t height_msl_mm;
+    uint32_t h_acc_mm;
+    int32_t vel_n_mmps;
+    int32_t vel_e_mmps;
+    int32_t vel_d_mmps;
+    int32_t ground_speed_mmps;
+    int32_t heading_e5;    // Курс движения (градусы * 1e5)
+} UBX_NavPvt;
+
+#define UBX_PVT_VALID_DATE  0x01
+#define UBX_PVT_VALID_TIME  0x02
+#define UBX_PVT_GNSS_FIX_OK 0x01
+
+void UBX_Init(UBX_Parser* parser);
+
+// Разбор очередного байта, возвращает 1 когда принят кадр с верной суммой
+uint8_t UBX_ParseByte(UBX_Parser* parser, uint8_t byte);
+
+// Парсер находится внутри кадра (байты не нужно отдавать разбору NMEA)
+uint8_t UBX_InFrame(const UBX_Parser* parser);
+
+// Разбор принятого кадра NAV-PVT, 0 если кадр другой
+uint8_t UBX_DecodeNavPvt(const UBX_Parser* parser, UBX_NavPvt* pvt);
+
+// Сборка кадров конфигурации в out, возвращают длину кадра
+uint16_t UBX_BuildFrame(uint8_t* out, uint8_t msg_class, uint8_t msg_id,
+                        const uint8_t* payload, uint16_t length);
+uint16_t UBX_BuildCfgPrt(uint8_t* out, uint32_t baudrate);
+uint16_t UBX_BuildCfgRate(uint8_t* out, uint16_t meas_rate_ms);
+uint16_t UBX_BuildCfgMsg(uint8_t* out, uint8_t msg_class, uint8_t msg_id, uint8_t rate);
+
+#endif // UBX_H
@@ -22,19 +22,57 @@ extern "C" {
 // Инициализация USB CDC
 void USB_CDC_Init(void);
 
-// Отправка данных через USB CDC
+// Отправка данных через USB CDC (постановка в очередь передачи целиком)
 void USB_CDC_SendData(const uint8_t* data, uint16_t size);
 
-// Отправка телеметрии
-void USB_CDC_SendTelemetry(const IMU_Data* imu, const GPS_Data* gps);
+// Копирование данных в блок передачи без ожидания. Только из основного
+// цикла. 0 - места нет, данные отброшены целиком и учтены в счетчике.
+uint8_t USB_CDC_QueueData(const uint8_t* data, uint16_t size);
 
-// Обработка полученных данных
+// Отправка блока передачи с накопленными кадрами, если конечная точка
+// свободна (основной цикл, после задач)
+void USB_CDC_Flush(void);
+
+// Наибольшая запись (байт), которую можно поставить в очередь сейчас
+uint32_t USB_CDC_GetTxFree(void);
+
+// Отброшено записей из-за нехватки блоков передачи
+uint32_t USB_CDC_GetTxDropped(void);
+
+// Завершение передачи на конечной точке IN (из CDC_TransmitCplt_FS)
+void USB_CDC_TransmitComplete(void);
+
+// Сброс очереди передачи при (пере)подключении (из CDC_Init_FS/CDC_DeInit_FS)
+void USB_CDC_ResetTx(void);
+
+// Пакетов приема, потерянных из-за нехватки блоков
+uint32_t USB_CDC_GetRxOverruns(void);
+
+// Задержка команд движения: последняя, максимум (мкс), число сверх бюджета
+void USB_CDC_GetCommandLatency(uint32_t* last_us, uint32_t* max_us, uint32_t* late);
+
+// Кодирование кадра (frame.h) прямо в блок передачи. Только из основного
+// цикла. 0 - кадр отброшен.
+uint8_t USB_CDC_SendFrame(uint8_t type, const void* payload, uint16_t length);
+
+// Отправка таблицы спутников (по команде SATS)
+void USB_CDC_SendSatellites(const GPS_SkyView* sky, const GPS_Data* gps);
+
+// Отправка накопленных сырых отсчетов IMU (режим захвата)
+void USB_CDC_SendImuCapture(void);
+
+// Разбор принятых байт на строки и выполнение команд (основной цикл)
 void USB_CDC_ProcessReceivedData(void);
 
-// Callback для приема данных
-void USB_CDC_ReceiveCallback(uint8_t* Buf, uint32_t *Len);
+// Блок приема под следующий пакет OUT (прерывание USB, из CDC_Init_FS).
+// NULL - свободных блоков нет, пакет принимается в буфер сброса.
+uint8_t* USB_CDC_ArmRx(void);
+
+// Callback для приема данных (прерывание USB): блок с пакетом передается
+// основному циклу. Возвращает буфер под следующий пакет, как USB_CDC_ArmRx.
+uint8_t* USB_CDC_ReceiveCallback(uint8_t* Buf, uint32_t *Len);
 
-// Внутренняя функция обработки команд
+// Выполнение одной команды (строка без '\n')
 void USB_CDC_ProcessCommand(const uint8_t* data, uint16_t size);
 
 #ifdef __cplusplus
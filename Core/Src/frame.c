@@ -0,0 +1,90 @@
+#include "frame.h"
+
+_Static_assert(sizeof(Frame_Imu) == 33, "Frame_Imu layout");
+_Static_assert(sizeof(Frame_Gps) == 32, "Frame_Gps layout");
+_Static_assert(sizeof(Frame_Diag) == 40, "Frame_Diag layout");
+_Static_assert(sizeof(Frame_Motor) == 14, "Frame_Motor layout");
+_Static_assert(sizeof(Frame_Nav) == 19, "Frame_Nav layout");
+_Static_assert(sizeof(Frame_ProfileHeader) == 8, "Frame_ProfileHeader layout");
+_Static_assert(sizeof(Frame_ProfileEntry) == 18, "Frame_ProfileEntry layout");
+_Static_assert(sizeof(Frame_Histogram) == 88, "Frame_Histogram layout");
+_Static_assert(sizeof(Frame_ImuCaptureHeader) == 8, "Frame_ImuCaptureHeader layout");
+_Static_assert(sizeof(Frame_Satellite) == 6, "Frame_Satellite layout");
+
+// Таблица по полубайтам: 32 байта flash вместо 512 у побайтовой,
+// два обращения к таблице на байт
+static const uint16_t crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// Потоковый кодер COBS: code_pos - место байта-кода текущего блока
+typedef struct {
+    uint8_t* out;
+    uint16_t length;
+    uint16_t code_pos;
+    uint8_t code;
+    uint16_t crc;
+} FrameEncoder;
+
+static inline uint16_t Crc16Byte(uint16_t crc, uint8_t byte) {
+    crc = (uint16_t)(crc << 4) ^ crc16_nibble[(crc >> 12) ^ (byte >> 4)];
+    crc = (uint16_t)(crc << 4) ^ crc16_nibble[(crc >> 12) ^ (byte & 0x0F)];
+    return crc;
+}
+
+static inline void CobsPut(FrameEncoder* enc, uint8_t byte) {
+    if (byte == 0) {
+        enc->out[enc->code_pos] = enc->code;
+        enc->code_pos = enc->length++;
+        enc->code = 1;
+        return;
+    }
+
+    enc->out[enc->length++] = byte;
+    enc->code++;
+    if (enc->code == 0xFF) {
+        // Блок из 254 ненулевых байт закрывается без нуля
+        enc->out[enc->code_pos] = enc->code;
+        enc->code_pos = enc->length++;
+        enc->code = 1;
+    }
+}
+
+static void PutBytes(FrameEncoder* enc, const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        enc->crc = Crc16Byte(enc->crc, data[i]);
+        CobsPut(enc, data[i]);
+    }
+}
+
+uint16_t Frame_Crc16(uint16_t crc, const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        crc = Crc16Byte(crc, data[i]);
+    }
+    return crc;
+}
+
+uint16_t Frame_Encode(uint8_t type, uint16_t sequence, const void* payload, uint16_t length,
+                      uint8_t* out, uint16_t out_size) {
+    // Проверка худшего случая заранее: дальше запись без проверок границ
+    if ((uint32_t)FRAME_MAX_ENCODED((uint32_t)length) > out_size) {
+        return 0;
+    }
+
+    FrameEncoder enc = { out, 1, 0, 1, 0xFFFF };
+    uint8_t header[FRAME_HEADER_SIZE] = {
+        FRAME_VERSION, type, (uint8_t)sequence, (uint8_t)(sequence >> 8)
+    };
+
+    PutBytes(&enc, header, FRAME_HEADER_SIZE);
+    PutBytes(&enc, (const uint8_t*)payload, length);
+
+    uint16_t crc = enc.crc;
+    CobsPut(&enc, (uint8_t)crc);
+    CobsPut(&enc, (uint8_t)(crc >> 8));
+
+    out[enc.code_pos] = enc.code;
+    out[enc.length++] = FRAME_DELIMITER;
+    return enc.length;
+}
@@ -1,16 +1,62 @@
 #include "main.h"
 #include "gps.h"
+#include "nmea_parser.h"
+#include "ubx.h"
+#include "seqlock.h"
+#include "lockfree.h"
+#include "timebase.h"
+#include "profile.h"
+#include "scheduler.h"
 #include <string.h>
-#include <stdlib.h>
 #include <stdint.h>
 
-// Буфер для приема данных
-#define GPS_BUFFER_SIZE 256
-static uint8_t gps_buffer[GPS_BUFFER_SIZE];
-static uint16_t buffer_index = 0;
+// Кольцевой буфер DMA приема (circular, события HT/TC/IDLE).
+// DMA пишет в кольцо сам, прерывание только публикует принятые байты
+// (SpscRing_Commit), разбор идет в GPS_Update прямо из этого буфера.
+#define GPS_DMA_BUFFER_SIZE 256 // Степень двойки
+static uint8_t gps_dma_buffer[GPS_DMA_BUFFER_SIZE];
+static SpscRing gps_rx_ring = { gps_dma_buffer, GPS_DMA_BUFFER_SIZE - 1, 0, 0 };
+static uint16_t gps_dma_write_pos = 0;      // Позиция DMA при последнем событии (ISR)
+static uint32_t gps_rx_overruns = 0;
+static volatile uint32_t gps_rx_restarts = 0;   // Перезапуски приема: ошибки UART (ISR), смена скорости
+static volatile uint32_t gps_rx_resync_pos = 0; // Запись кольца после перезапуска (ISR)
+static uint32_t gps_rx_restarts_seen = 0;
 
-// Данные GPS
+static NMEA_Parser nmea_parser;
+static UBX_Parser ubx_parser;
+
+// Протокол приемника: UBX после успешной настройки, иначе NMEA
+static GPS_Protocol gps_protocol = GPS_PROTOCOL_NMEA;
+static uint8_t gps_ubx_pending = 0;     // Ждем первый NAV-PVT после настройки
+static uint32_t gps_ubx_last_tick = 0;  // Время последнего NAV-PVT (или настройки)
+static uint32_t gps_ubx_reconfigs = 0;
+
+// Шаги настройки приемника на UBX (GPS_ConfigStep)
+typedef enum {
+    GPS_CONFIG_IDLE = 0,
+    GPS_CONFIG_START,       // Скорость 9600, передача CFG-PRT
+    GPS_CONFIG_PORT,        // Ждем окончания передачи CFG-PRT
+    GPS_CONFIG_SWITCH,      // Пауза на переключение скорости приемника
+    GPS_CONFIG_MESSAGES     // Остальные команды на новой скорости
+} GPS_ConfigState;
+
+static GPS_ConfigState gps_config_state = GPS_CONFIG_IDLE;
+static uint8_t gps_config_index = 0;
+static uint32_t gps_config_deadline = 0;
+static uint8_t gps_config_frame[UBX_FRAME_OVERHEAD + 20];  // Передается через прерывание
+
+// Рабочие копии, которые заполняет разбор в GPS_Update
 static GPS_Data gps_data;
+static GPS_SkyView gps_sky;
+static uint8_t gps_data_updated = 0;
+static uint8_t gps_sky_updated = 0;
+
+// Опубликованные снимки: читатели получают согласованную копию целиком,
+// а не широту из одного решения и долготу из следующего
+static GPS_Data gps_snapshot;
+static GPS_SkyView gps_sky_snapshot;
+static Seqlock gps_lock;
+static Seqlock gps_sky_lock;
 
 // Данные о последнем известном курсе
 static struct {
@@ -24,7 +70,7 @@ static struct {
 // Инициализация UART
 static void UART_Init(void) {
     huart2.Instance = USART2;
-    huart2.Init.BaudRate = 9600;
+    huart2.Init.BaudRate = GPS_UART_BAUDRATE;
     huart2.Init.WordLength = UART_WORDLENGTH_8B;
     huart2.Init.StopBits = UART_STOPBITS_1;
     huart2.Init.Parity = UART_PARITY_NONE;
@@ -34,147 +80,319 @@ static void UART_Init(void) {
     HAL_UART_Init(&huart2);
 }
 
-// Парсинг NMEA предложения
-static void ParseNMEA(const char* sentence) {
-    char* token;
-    char* rest = (char*)sentence;
-    
-    // Пропускаем $GPRMC или $GPGGA
-    token = strtok_r(rest, ",", &rest);
-    if(strcmp(token, "$GPRMC") == 0) {
-        // Время
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            gps_data.hour = (token[0] - '0') * 10 + (token[1] - '0');
-            gps_data.minute = (token[2] - '0') * 10 + (token[3] - '0');
-            gps_data.second = (token[4] - '0') * 10 + (token[5] - '0');
-        }
-        
-        // Статус
-        token = strtok_r(NULL, ",", &rest);
-        gps_data.fix = (token[0] == 'A') ? 1 : 0;
-        
-        // Широта
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            float lat = atof(token);
-            int degrees = (int)(lat / 100);
-            float minutes = lat - (degrees * 100);
-            gps_data.latitude = degrees + (minutes / 60.0f);
-        }
-        
-        // N/S
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] == 'S') gps_data.latitude = -gps_data.latitude;
-        
-        // Долгота
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            float lon = atof(token);
-            int degrees = (int)(lon / 100);
-            float minutes = lon - (degrees * 100);
-            gps_data.longitude = degrees + (minutes / 60.0f);
-        }
-        
-        // E/W
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] == 'W') gps_data.longitude = -gps_data.longitude;
-        
-        // Скорость
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            gps_data.speed = atof(token) * 0.514f; // Узлы в м/с
-        }
-        
-        // Курс
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            gps_data.course = atof(token);
-        }
-        
-        // Дата
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            gps_data.day = (token[0] - '0') * 10 + (token[1] - '0');
-            gps_data.month = (token[2] - '0') * 10 + (token[3] - '0');
-            gps_data.year = 2000 + (token[4] - '0') * 10 + (token[5] - '0');
+// Обновление таблицы спутников из предложения GSV. Первое предложение
+// серии удаляет спутники этой системы, остальные дописывают новые.
+static void GPS_ApplySky(const NMEA_Fix* fix) {
+    gps_sky_updated = 1;
+
+    if (fix->gsv_index == 1) {
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < gps_sky.count; i++) {
+            if (gps_sky.sats[i].constellation != fix->talker) {
+                gps_sky.sats[kept++] = gps_sky.sats[i];
+            }
         }
+        gps_sky.count = kept;
     }
-    else if(strcmp(token, "$GPGGA") == 0) {
-        // Время
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            gps_data.hour = (token[0] - '0') * 10 + (token[1] - '0');
-            gps_data.minute = (token[2] - '0') * 10 + (token[3] - '0');
-            gps_data.second = (token[4] - '0') * 10 + (token[5] - '0');
-        }
-        
-        // Широта
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            float lat = atof(token);
-            int degrees = (int)(lat / 100);
-            float minutes = lat - (degrees * 100);
-            gps_data.latitude = degrees + (minutes / 60.0f);
-        }
-        
-        // N/S
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] == 'S') gps_data.latitude = -gps_data.latitude;
-        
-        // Долгота
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            float lon = atof(token);
-            int degrees = (int)(lon / 100);
-            float minutes = lon - (degrees * 100);
-            gps_data.longitude = degrees + (minutes / 60.0f);
-        }
-        
-        // E/W
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] == 'W') gps_data.longitude = -gps_data.longitude;
-        
-        // Качество фиксации
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            gps_data.fix = atoi(token);
-        }
-        
-        // Количество спутников
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            gps_data.satellites = atoi(token);
+
+    for (uint8_t i = 0; i < fix->sat_count; i++) {
+        const NMEA_Satellite* src = &fix->sats[i];
+        GPS_Satellite* dst = NULL;
+
+        // Повтор спутника при потере первого предложения серии
+        for (uint8_t j = 0; j < gps_sky.count; j++) {
+            if (gps_sky.sats[j].constellation == fix->talker && gps_sky.sats[j].prn == src->prn) {
+                dst = &gps_sky.sats[j];
+                break;
+            }
         }
-        
-        // Высота
-        token = strtok_r(NULL, ",", &rest);
-        if(token[0] != '\0') {
-            gps_data.altitude = atof(token);
+        if (dst == NULL) {
+            if (gps_sky.count >= GPS_MAX_SATELLITES) {
+                return;
+            }
+            dst = &gps_sky.sats[gps_sky.count++];
         }
+
+        dst->constellation = fix->talker;
+        dst->prn = src->prn;
+        dst->elevation = src->elevation;
+        dst->azimuth = src->azimuth;
+        dst->snr = src->snr;
     }
 }
 
-// Обработчик прерывания UART
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
-    if(huart->Instance == USART2) {
-        // Добавляем символ в буфер
-        if(buffer_index < GPS_BUFFER_SIZE - 1) {
-            gps_buffer[buffer_index++] = gps_buffer[0];
-            
-            // Проверяем на конец строки
-            if(gps_buffer[0] == '\n') {
-                gps_buffer[buffer_index] = '\0';
-                ParseNMEA((char*)gps_buffer);
-                buffer_index = 0;
+// Перенос целочисленных полей предложения в gps_data
+static void GPS_ApplyFix(const NMEA_Fix* fix) {
+    gps_data_updated = 1;
+
+    if (fix->valid & NMEA_FIX_TIME) {
+        uint32_t seconds = fix->time_ms / 1000;
+        gps_data.hour = (uint8_t)(seconds / 3600);
+        gps_data.minute = (uint8_t)((seconds / 60) % 60);
+        gps_data.second = (uint8_t)(seconds % 60);
+        gps_data.millisecond = (uint16_t)(fix->time_ms % 1000);
+    }
+    if (fix->valid & NMEA_FIX_STATUS) {
+        gps_data.fix = fix->fix;
+    }
+    if (fix->valid & NMEA_FIX_POSITION) {
+        gps_data.latitude_e7 = fix->latitude_e7;
+        gps_data.longitude_e7 = fix->longitude_e7;
+        gps_data.position_updates++;
+        gps_data.timestamp_us = Timebase_GetMicros();
+    }
+    if (fix->valid & NMEA_FIX_SPEED) {
+        gps_data.speed = fix->speed_mmps / 1000.0f;
+    }
+    if (fix->valid & NMEA_FIX_COURSE) {
+        gps_data.course = fix->course_e2 / 100.0f;
+    }
+    if (fix->valid & NMEA_FIX_DATE) {
+        gps_data.day = fix->day;
+        gps_data.month = fix->month;
+        gps_data.year = fix->year;
+    }
+    if (fix->valid & NMEA_FIX_SATELLITES) {
+        gps_data.satellites = fix->satellites;
+    }
+    if (fix->valid & NMEA_FIX_ALTITUDE) {
+        gps_data.altitude = fix->altitude_cm / 100.0f;
+    }
+    if (fix->valid & NMEA_FIX_DOP) {
+        gps_data.pdop = fix->pdop_e2 / 100.0f;
+        gps_data.hdop = fix->hdop_e2 / 100.0f;
+        gps_data.vdop = fix->vdop_e2 / 100.0f;
+    }
+    if (fix->valid & NMEA_FIX_SKY) {
+        GPS_ApplySky(fix);
+    }
+
+    // Дата и время из одного предложения (RMC) привязывают PPS к UTC
+    if ((fix->valid & NMEA_FIX_TIME) && (fix->valid & NMEA_FIX_DATE)) {
+        Timebase_SetGpsTime(Timebase_MakeUnixTime(fix->year, fix->month, fix->day, fix->time_ms / 1000),
+                            (uint16_t)(fix->time_ms % 1000));
+    }
+}
+
+// Перенос решения NAV-PVT в gps_data
+static void GPS_ApplyPvt(const UBX_NavPvt* pvt) {
+    gps_data_updated = 1;
+
+    if (pvt->valid & UBX_PVT_VALID_TIME) {
+        gps_data.hour = pvt->hour;
+        gps_data.minute = pvt->minute;
+        gps_data.second = pvt->second;
+        gps_data.millisecond = (pvt->nano > 0) ? (uint16_t)(pvt->nano / 1000000) : 0;
+    }
+    if (pvt->valid & UBX_PVT_VALID_DATE) {
+        gps_data.day = pvt->day;
+        gps_data.month = pvt->month;
+        gps_data.year = pvt->year;
+    }
+    if ((pvt->valid & UBX_PVT_VALID_TIME) && (pvt->valid & UBX_PVT_VALID_DATE)) {
+        Timebase_SetGpsTime(Timebase_MakeUnixTime(pvt->year, pvt->month, pvt->day,
+                                                  ((uint32_t)pvt->hour * 60 + pvt->minute) * 60 + pvt->second),
+                            gps_data.millisecond);
+    }
+    gps_data.satellites = pvt->num_sv;
+
+    if (!(pvt->flags & UBX_PVT_GNSS_FIX_OK) || pvt->fix_type < 2 || pvt->fix_type > 4) {
+        gps_data.fix = 0;
+        return;
+    }
+
+    // fixType: 2 = 2D, 3 = 3D, 4 = GNSS + счисление
+    gps_data.fix = (pvt->fix_type == 2) ? 1 : 2;
+    gps_data.latitude_e7 = pvt->latitude_e7;
+    gps_data.longitude_e7 = pvt->longitude_e7;
+    gps_data.position_updates++;
+    gps_data.timestamp_us = Timebase_GetMicros();
+    gps_data.altitude = pvt->height_msl_mm / 1000.0f;
+    gps_data.speed = pvt->ground_speed_mmps / 1000.0f;
+    gps_data.course = pvt->heading_e5 / 100000.0f;
+}
+
+static void GPS_StartReception(void) {
+    gps_dma_write_pos = 0;
+    HAL_UARTEx_ReceiveToIdle_DMA(&huart2, gps_dma_buffer, GPS_DMA_BUFFER_SIZE);
+}
+
+// Перезапуск приема с нулевой позиции буфера DMA: head выравнивается на
+// начало буфера, а GPS_Update пропустит все, что было принято до этого
+static void GPS_RestartReception(void) {
+    // DMA начнет с начала буфера: запись кольца доводится до границы буфера,
+    // пропущенный хвост читатель отбрасывает по gps_rx_resync_pos
+    uint32_t pad = (0U - gps_rx_ring.head) & (GPS_DMA_BUFFER_SIZE - 1);
+    SpscRing_Commit(&gps_rx_ring, pad);
+    gps_rx_resync_pos = gps_rx_ring.head;
+    gps_rx_restarts++;
+    GPS_StartReception();
+}
+
+// Смена скорости UART на лету, прием DMA перезапускается. Из задачи
+// GPS_RestartReception пишет голову кольца, как и Commit в обработчике
+// события приема: прерывания USART2 и DMA1 Channel6 на это время
+// маскируются, чтобы у кольца оставался один производитель.
+static void GPS_SetBaudrate(uint32_t baudrate) {
+    HAL_NVIC_DisableIRQ(USART2_IRQn);
+    HAL_NVIC_DisableIRQ(DMA1_Channel6_IRQn);
+
+    HAL_UART_Abort(&huart2);
+    huart2.Init.BaudRate = baudrate;
+    HAL_UART_Init(&huart2);
+    GPS_RestartReception();
+
+    HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+// Передача кадра настройки без ожидания: окончание видно по gState
+// (HAL_UART_TxCpltCallback будит задачу), зависшая передача снимается
+// по дедлайну
+static void GPS_SendUbx(uint16_t length) {
+    HAL_UART_Transmit_IT(&huart2, gps_config_frame, length);
+    gps_config_deadline = HAL_GetTick() + GPS_UBX_TX_TIMEOUT_MS;
+}
+
+static uint8_t GPS_UbxSent(void) {
+    if (huart2.gState == HAL_UART_STATE_READY) {
+        return 1;
+    }
+    if ((int32_t)(HAL_GetTick() - gps_config_deadline) >= 0) {
+        HAL_UART_AbortTransmit(&huart2);
+        return 1;
+    }
+    return 0;
+}
+
+// Команды после переключения скорости: частота решений, отключение NMEA
+// (кроме GSA/GSV для таблицы спутников) и включение NAV-PVT.
+// 0 - команды закончились.
+static uint16_t GPS_BuildConfigMessage(uint8_t index, uint8_t* frame) {
+    static const uint8_t nmea_disabled[] = {
+        UBX_NMEA_GGA, UBX_NMEA_GLL, UBX_NMEA_RMC, UBX_NMEA_VTG
+    };
+
+    if (index == 0) {
+        return UBX_BuildCfgRate(frame, GPS_UBX_NAV_RATE_MS);
+    }
+    index--;
+    if (index < sizeof(nmea_disabled)) {
+        return UBX_BuildCfgMsg(frame, UBX_CLASS_NMEA, nmea_disabled[index], 0);
+    }
+    switch (index - sizeof(nmea_disabled)) {
+        case 0:  return UBX_BuildCfgMsg(frame, UBX_CLASS_NMEA, UBX_NMEA_GSA, GPS_UBX_SKY_MSG_RATE);
+        case 1:  return UBX_BuildCfgMsg(frame, UBX_CLASS_NMEA, UBX_NMEA_GSV, GPS_UBX_SKY_MSG_RATE);
+        case 2:  return UBX_BuildCfgMsg(frame, UBX_CLASS_NAV, UBX_NAV_PVT, 1);
+        default: return 0;
+    }
+}
+
+// Перевод приемника u-blox в режим UBX по шагам из GPS_Update, без
+// ожидания в задаче: CFG-PRT на 9600, пауза на переключение скорости
+// приемника, затем остальные команды на новой скорости по одной. Если
+// приемник остался на высокой скорости после сброса МК, CFG-PRT на 9600
+// теряется, но остальные команды все равно доходят.
+static void GPS_ConfigStep(void) {
+    uint32_t now = HAL_GetTick();
+    uint16_t length;
+
+    switch (gps_config_state) {
+        case GPS_CONFIG_START:
+            GPS_SetBaudrate(GPS_UART_BAUDRATE);
+            GPS_SendUbx(UBX_BuildCfgPrt(gps_config_frame, GPS_UBX_BAUDRATE));
+            gps_config_state = GPS_CONFIG_PORT;
+            break;
+
+        case GPS_CONFIG_PORT:
+            // Приемник переключает скорость после отправки подтверждения
+            if (GPS_UbxSent()) {
+                gps_config_deadline = now + GPS_UBX_SWITCH_DELAY_MS;
+                gps_config_state = GPS_CONFIG_SWITCH;
             }
-        }
-        else {
-            buffer_index = 0;
-        }
-        
-        // Запускаем следующее чтение
-        HAL_UART_Receive_IT(&huart2, gps_buffer, 1);
+            break;
+
+        case GPS_CONFIG_SWITCH:
+            if ((int32_t)(now - gps_config_deadline) >= 0) {
+                GPS_SetBaudrate(GPS_UBX_BAUDRATE);
+                gps_config_index = 0;
+                GPS_SendUbx(GPS_BuildConfigMessage(0, gps_config_frame));
+                gps_config_state = GPS_CONFIG_MESSAGES;
+            }
+            break;
+
+        case GPS_CONFIG_MESSAGES:
+            if (!GPS_UbxSent()) {
+                break;
+            }
+            length = GPS_BuildConfigMessage(++gps_config_index, gps_config_frame);
+            if (length > 0) {
+                GPS_SendUbx(length);
+                break;
+            }
+            // Таймаут ответа отсчитывается от последней команды
+            gps_config_state = GPS_CONFIG_IDLE;
+            gps_ubx_pending = 1;
+            gps_ubx_last_tick = now;
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Контроль потока NAV-PVT: нет ответа на настройку - возврат к NMEA 9600,
+// поток пропал в режиме UBX (сброс питания приемника) - повторная настройка
+static void GPS_CheckProtocol(void) {
+    if (gps_config_state != GPS_CONFIG_IDLE) {
+        GPS_ConfigStep();
+        return;
+    }
+    if (gps_protocol == GPS_PROTOCOL_NMEA && !gps_ubx_pending) {
+        return;
+    }
+    if (HAL_GetTick() - gps_ubx_last_tick < GPS_UBX_TIMEOUT_MS) {
+        return;
+    }
+
+    if (gps_ubx_pending) {
+        gps_ubx_pending = 0;
+        gps_protocol = GPS_PROTOCOL_NMEA;
+        GPS_SetBaudrate(GPS_UART_BAUDRATE);
+    }
+    else {
+        gps_ubx_reconfigs++;
+        gps_config_state = GPS_CONFIG_START;
+    }
+}
+
+// Событие приема: половина/конец буфера DMA или пауза на линии (IDLE).
+// Size - позиция записи DMA в кольцевом буфере.
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if(huart->Instance != USART2) {
+        return;
+    }
+
+    uint16_t received = (uint16_t)((Size - gps_dma_write_pos) & (GPS_DMA_BUFFER_SIZE - 1));
+    if (Size == GPS_DMA_BUFFER_SIZE && gps_dma_write_pos == 0) {
+        received = GPS_DMA_BUFFER_SIZE;
+    }
+    gps_dma_write_pos = Size & (GPS_DMA_BUFFER_SIZE - 1);
+    SpscRing_Commit(&gps_rx_ring, received);
+    Scheduler_PostEvent(SCHEDULER_EVENT_GPS_RX);
+}
+
+// Кадр настройки ушел: следующий шаг GPS_ConfigStep без ожидания периода
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if(huart->Instance == USART2) {
+        Scheduler_PostEvent(SCHEDULER_EVENT_GPS_RX);
+    }
+}
+
+// Ошибка UART (переполнение, шум) останавливает DMA, перезапускаем прием
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    if(huart->Instance == USART2) {
+        GPS_RestartReception();
     }
 }
 
@@ -184,13 +402,96 @@ void GPS_Init(void) {
     
     // Инициализация данных
     memset(&gps_data, 0, sizeof(GPS_Data));
+    memset(&gps_sky, 0, sizeof(GPS_SkyView));
+    Seqlock_Write(&gps_lock, &gps_snapshot, &gps_data, sizeof(GPS_Data));
+    Seqlock_Write(&gps_sky_lock, &gps_sky_snapshot, &gps_sky, sizeof(GPS_SkyView));
+    NMEA_Init(&nmea_parser);
+    UBX_Init(&ubx_parser);
     
-    // Запуск приема данных
-    HAL_UART_Receive_IT(&huart2, gps_buffer, 1);
+    // Прием через DMA на 9600. Настройка приемника на UBX идет уже из
+    // задачи GPS после калибровки, таймаут ответа отсчитывается от ее
+    // окончания; NMEA остается запасным вариантом.
+    GPS_StartReception();
+    gps_config_state = GPS_CONFIG_START;
+}
+
+// После перезапуска приема (ошибка UART, смена скорости) отбрасываются
+// дополнение кольца до границы буфера и незавершенное предложение
+static void GPS_SyncRestart(void) {
+    uint32_t restarts = gps_rx_restarts;
+    if (restarts == gps_rx_restarts_seen) {
+        return;
+    }
+
+    gps_rx_restarts_seen = restarts;
+    uint32_t skip = gps_rx_resync_pos - gps_rx_ring.tail;
+    if ((int32_t)skip > 0) {
+        SpscRing_Consume(&gps_rx_ring, skip);
+    }
+    NMEA_Reset(&nmea_parser);
+    ubx_parser.state = UBX_STATE_SYNC1;
 }
 
 void GPS_Update(void) {
-    // Обновление происходит в прерывании
+    const uint8_t* chunk;
+    uint32_t length;
+    NMEA_Fix fix;
+    UBX_NavPvt pvt;
+
+    GPS_SyncRestart();
+
+    // DMA успел перезаписать неразобранные данные: продолжаем с актуальных
+    uint32_t pending = SpscRing_Count(&gps_rx_ring);
+    if (pending > GPS_DMA_BUFFER_SIZE) {
+        gps_rx_overruns++;
+        SpscRing_Consume(&gps_rx_ring, pending - GPS_DMA_BUFFER_SIZE);
+        NMEA_Reset(&nmea_parser);
+        ubx_parser.state = UBX_STATE_SYNC1;
+    }
+
+    // Разбор принятых байт прямо из буфера DMA, непрерывными участками.
+    // Ошибка UART может перезапустить прием посреди разбора: перезапуск
+    // проверяется перед каждым участком, чтобы дополнение кольца до границы
+    // буфера не попало в разбор.
+    while ((length = SpscRing_Peek(&gps_rx_ring, &chunk)) > 0) {
+      for (uint32_t i = 0; i < length; i++) {
+        uint8_t byte = chunk[i];
+
+        // 0xB5 не встречается в тексте NMEA: с него начинается кадр UBX
+        if (byte == UBX_SYNC1 || UBX_InFrame(&ubx_parser)) {
+            if (UBX_ParseByte(&ubx_parser, byte) && UBX_DecodeNavPvt(&ubx_parser, &pvt)) {
+                GPS_ApplyPvt(&pvt);
+                gps_protocol = GPS_PROTOCOL_UBX;
+                gps_ubx_pending = 0;
+                gps_ubx_last_tick = HAL_GetTick();
+            }
+            continue;
+        }
+
+        if (NMEA_ParseByte(&nmea_parser, byte)) {
+            PROFILE_BEGIN(PROFILE_NMEA_DECODE);
+            if (NMEA_DecodeSentence(&nmea_parser, &fix) != NMEA_SENTENCE_NONE) {
+                GPS_ApplyFix(&fix);
+            }
+            PROFILE_END(PROFILE_NMEA_DECODE);
+        }
+      }
+      SpscRing_Consume(&gps_rx_ring, length);
+      GPS_SyncRestart();
+    }
+
+    GPS_CheckProtocol();
+
+    // Публикация снимков один раз после разбора всех принятых байт
+    if (gps_data_updated) {
+        gps_data_updated = 0;
+        Seqlock_Write(&gps_lock, &gps_snapshot, &gps_data, sizeof(GPS_Data));
+    }
+    if (gps_sky_updated) {
+        gps_sky_updated = 0;
+        Seqlock_Write(&gps_sky_lock, &gps_sky_snapshot, &gps_sky, sizeof(GPS_SkyView));
+    }
+
     // Обновляем статус курса
     if (gps_data.fix > 0 && gps_data.speed > 1.0f) {
         course_data.last_course = gps_data.course;
@@ -198,8 +499,25 @@ void GPS_Update(void) {
     }
 }
 
-const GPS_Data* GPS_GetData(void) {
-    return &gps_data;
+void GPS_GetData(GPS_Data* data) {
+    Seqlock_Read(&gps_lock, data, &gps_snapshot, sizeof(GPS_Data));
+}
+
+void GPS_GetSkyView(GPS_SkyView* sky) {
+    Seqlock_Read(&gps_sky_lock, sky, &gps_sky_snapshot, sizeof(GPS_SkyView));
+}
+
+GPS_Protocol GPS_GetProtocol(void) {
+    return gps_protocol;
+}
+
+void GPS_SetNmeaSubscriptions(uint32_t mask) {
+    // Вызывается из основного цикла, как и разбор в GPS_Update
+    NMEA_SetSubscriptions(&nmea_parser, mask);
+}
+
+uint32_t GPS_GetNmeaSubscriptions(void) {
+    return nmea_parser.subscriptions;
 }
 
 uint8_t GPS_HasValidData(void) {
@@ -213,16 +531,3 @@ float GPS_GetLastKnownCourse(void) {
 uint8_t GPS_HasValidCourse(void) {
     return course_data.is_valid && gps_data.fix > 0 && gps_data.speed > 1.0f;
 }
-
-// Обработка данных GPS через UART
-void GPS_ProcessUART(void) {
-    // Здесь будет логика обработки входящих UART данных
-    // Например, парсинг NMEA-сообщений
-    extern UART_HandleTypeDef huart2;
-    uint8_t rx_data[1];
-    
-    if (HAL_UART_Receive(&huart2, rx_data, 1, 10) == HAL_OK) {
-        // Логика обработки принятого байта
-        // Можно добавить буферизацию и парсинг NMEA-протокола
-    }
-} 
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "histogram.h"
+#include <string.h>
+
+#if defined(__arm__)
+#include "stm32f1xx.h"
+#endif
+
+static Histogram histograms[HISTOGRAM_COUNT];
+
+static inline uint32_t Histogram_Bucket(uint32_t value) {
+    // Номер старшего единичного бита + 1: CLZ на Cortex-M3
+    uint32_t bucket = value ? 32U - (uint32_t)__builtin_clz(value) : 0U;
+    return (bucket < HISTOGRAM_BUCKETS) ? bucket : HISTOGRAM_BUCKETS - 1;
+}
+
+void Histogram_Record(Histogram_Id id, uint32_t value_us) {
+    Histogram* h = &histograms[id];
+    h->counts[Histogram_Bucket(value_us)]++;
+    if (value_us > h->max) {
+        h->max = value_us;
+    }
+}
+
+void Histogram_RecordDeviation(Histogram_Id id, uint32_t interval_us, uint32_t expected_us) {
+    Histogram_Record(id, (interval_us > expected_us) ? interval_us - expected_us
+                                                     : expected_us - interval_us);
+}
+
+#if defined(__arm__)
+
+// Прерывания запрещаются на время копирования: гистограмму такта пишет TIM3
+void Histogram_Get(Histogram_Id id, Histogram* out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = histograms[id];
+    __set_PRIMASK(primask);
+}
+
+void Histogram_ResetAll(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(histograms, 0, sizeof(histograms));
+    __set_PRIMASK(primask);
+}
+
+#else
+
+void Histogram_Get(Histogram_Id id, Histogram* out) {
+    *out = histograms[id];
+}
+
+void Histogram_ResetAll(void) {
+    memset(histograms, 0, sizeof(histograms));
+}
+
+#endif
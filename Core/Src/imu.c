@@ -1,4 +1,8 @@
 #include "imu.h"
+#include "timebase.h"
+#include "seqlock.h"
+#include "lockfree.h"
+#include "profile.h"
 #include <math.h>
 
 // Адрес устройства MPU-6050 на I2C
@@ -11,14 +15,16 @@
 #define MPU6050_ACCEL_CONFIG 0x1C
 #define MPU6050_FIFO_EN      0x23
 #define MPU6050_INT_ENABLE   0x38
+#define MPU6050_INT_STATUS   0x3A
 #define MPU6050_ACCEL_XOUT_H 0x3B
 #define MPU6050_TEMP_OUT_H   0x41
 #define MPU6050_GYRO_XOUT_H  0x43
 #define MPU6050_PWR_MGMT_1   0x6B
 #define MPU6050_WHO_AM_I     0x75
 
-// Данные IMU
+// Данные IMU, публикуются целиком через seqlock
 static IMU_Data imu_data;
+static Seqlock imu_lock;
 
 // Калибровочные данные
 static struct {
@@ -32,6 +38,54 @@ static uint8_t consecutive_errors = 0;
 #define MAX_CONSECUTIVE_ERRORS 5
 #define IMU_UPDATE_TIMEOUT 100 // ms
 
+// Кольцевой буфер сырых отсчетов для режима захвата.
+// Один писатель (IMU_Update) и один читатель (IMU_ReadCaptureSamples), без блокировок.
+#ifndef IMU_CAPTURE_RING_SIZE
+#define IMU_CAPTURE_RING_SIZE 64 // Степень двойки, 64 * 20 байт = 1280 байт RAM
+#endif
+
+#if (IMU_CAPTURE_RING_SIZE & (IMU_CAPTURE_RING_SIZE - 1)) != 0
+#error "IMU_CAPTURE_RING_SIZE must be a power of two"
+#endif
+
+#define MPU6050_DATA_RDY_INT 0x01
+
+// Дециматоры потребителей. Частоты - по умолчанию, затем из
+// IMU_SetConsumerRate; переинициализация датчика их сохраняет.
+static IMU_Decimator decimators[IMU_CONSUMER_COUNT];
+static uint16_t consumer_rates_hz[IMU_CONSUMER_COUNT] = {
+    10,  // IMU_CONSUMER_TELEMETRY
+    50,  // IMU_CONSUMER_CONTROL
+    25   // IMU_CONSUMER_LOG
+};
+
+static IMU_RawSample capture_buffer[IMU_CAPTURE_RING_SIZE];
+static SpscRecordRing capture_ring = {
+    (uint8_t*)capture_buffer, sizeof(IMU_RawSample), IMU_CAPTURE_RING_SIZE - 1, 0, 0
+};
+static volatile uint8_t capture_enabled = 0;
+static uint32_t capture_dropped = 0;
+static uint16_t capture_seq = 0;
+
+static void CapturePush(const int16_t raw[IMU_RAW_CHANNELS], uint32_t timestamp_us) {
+    IMU_RawSample sample;
+
+    sample.timestamp_us = timestamp_us;
+    sample.accel[0] = raw[0];
+    sample.accel[1] = raw[1];
+    sample.accel[2] = raw[2];
+    sample.temp     = raw[3];
+    sample.gyro[0]  = raw[4];
+    sample.gyro[1]  = raw[5];
+    sample.gyro[2]  = raw[6];
+    sample.seq = capture_seq++;
+
+    // Буфер полон: отсчет теряется, разрыв виден по seq
+    if (!SpscRecordRing_Push(&capture_ring, &sample)) {
+        capture_dropped++;
+    }
+}
+
 static uint8_t CheckSensorLimits(float ax, float ay, float az, float gx, float gy, float gz) {
     // Проверка пределов акселерометра (±4g в единицах g)
     if (fabsf(ax) > 4.0f || fabsf(ay) > 4.0f || fabsf(az) > 4.0f) {
@@ -57,10 +111,11 @@ uint8_t IMU_IsDataValid(void) {
     }
     
     // Проверка показаний на выход за пределы
-    const IMU_Data* data = IMU_GetData();
+    IMU_Data data;
+    IMU_GetData(&data);
     return CheckSensorLimits(
-        data->accel_x, data->accel_y, data->accel_z,
-        data->gyro_x, data->gyro_y, data->gyro_z
+        data.accel_x, data.accel_y, data.accel_z,
+        data.gyro_x, data.gyro_y, data.gyro_z
     );
 }
 
@@ -115,6 +170,10 @@ static void MPU6050_Init(void) {
     // Настройка акселерометра
     data = 0x08; // ±4g для более точных измерений
     HAL_I2C_Mem_Write(&hi2c1, MPU6050_ADDR << 1, MPU6050_ACCEL_CONFIG, 1, &data, 1, 100);
+    
+    // Флаг DATA_RDY в INT_STATUS отмечает новый отсчет (сбрасывается чтением)
+    data = MPU6050_DATA_RDY_INT;
+    HAL_I2C_Mem_Write(&hi2c1, MPU6050_ADDR << 1, MPU6050_INT_ENABLE, 1, &data, 1, 100);
 }
 
 void IMU_Init(void) {
@@ -130,23 +189,67 @@ void IMU_Init(void) {
         calibration.accel_offset[i] = 0.0f;
     }
     
+    // Дециматоры перезапускаются вместе с датчиком
+    for(int i = 0; i < IMU_CONSUMER_COUNT; i++) {
+        IMU_Decimator_Init(&decimators[i], consumer_rates_hz[i]);
+    }
+    
     // В конце успешной инициализации:
     imu_initialized = 1;
     consecutive_errors = 0;
     last_update = HAL_GetTick();
 }
 
+// Преобразование сырого отсчета в физические величины и углы ориентации
+static void ConvertRaw(const int16_t raw[IMU_RAW_CHANNELS], uint32_t timestamp_us, IMU_Data* out) {
+    out->timestamp_us = timestamp_us;
+
+
+    // Акселерометр (для ±4g, 8192 LSB/g)
+    out->accel_x = (raw[0] / 8192.0f) - calibration.accel_offset[0];
+    out->accel_y = (raw[1] / 8192.0f) - calibration.accel_offset[1];
+    out->accel_z = (raw[2] / 8192.0f) - calibration.accel_offset[2];
+    
+    // Температура (MPU-6050 формула)
+    out->temp = (raw[3] / 340.0f) + 36.53f;
+    
+    // Гироскоп (для ±500°/с, LSB = 65.5)
+    out->gyro_x = (raw[4] / 65.5f) - calibration.gyro_offset[0];
+    out->gyro_y = (raw[5] / 65.5f) - calibration.gyro_offset[1];
+    out->gyro_z = (raw[6] / 65.5f) - calibration.gyro_offset[2];
+
+    // Магнитометра в MPU-6050 нет
+    out->mag_x = 0.0f;
+    out->mag_y = 0.0f;
+    out->mag_z = 0.0f;
+
+    // Roll (крен)
+    out->roll = atan2f(out->accel_y, out->accel_z) * 180.0f / 3.14159f;
+    
+    // Pitch (тангаж)
+    out->pitch = atan2f(-out->accel_x, 
+        sqrtf(out->accel_y * out->accel_y + 
+              out->accel_z * out->accel_z)) * 180.0f / 3.14159f;
+    
+    // Yaw устанавливается из GPS в main.c
+    out->yaw = 0.0f;
+}
+
 void IMU_Update(void) {
     if (!imu_initialized) {
         return;
     }
 
-    uint8_t data[14];
-    int16_t raw;
+    uint8_t frame[15];
+    int16_t raw[IMU_RAW_CHANNELS];
+    IMU_Data converted;
     HAL_StatusTypeDef status;
     
-    // Чтение всех данных за один раз (акселерометр, температура, гироскоп)
-    status = HAL_I2C_Mem_Read(&hi2c1, MPU6050_ADDR << 1, MPU6050_ACCEL_XOUT_H, 1, data, 14, 100);
+    // Чтение INT_STATUS и всех данных за один раз (акселерометр, температура, гироскоп)
+    PROFILE_BEGIN(PROFILE_IMU_READ);
+    status = HAL_I2C_Mem_Read(&hi2c1, MPU6050_ADDR << 1, MPU6050_INT_STATUS, 1, frame, 15, 100);
+    PROFILE_END(PROFILE_IMU_READ);
+    uint32_t timestamp_us = Timebase_GetMicros();
     
     if (status != HAL_OK) {
         consecutive_errors++;
@@ -155,53 +258,43 @@ void IMU_Update(void) {
         }
         return;
     }
-      // Обработка данных акселерометра (для ±4g, LSB = 8192/4 = 2048 LSB/g)
-    raw = (data[0] << 8) | data[1];
-    imu_data.accel_x = (raw / 8192.0f) - calibration.accel_offset[0];
-    raw = (data[2] << 8) | data[3];
-    imu_data.accel_y = (raw / 8192.0f) - calibration.accel_offset[1];
-    raw = (data[4] << 8) | data[5];
-    imu_data.accel_z = (raw / 8192.0f) - calibration.accel_offset[2];
-    
-    // Обработка данных температуры (MPU-6050 формула)
-    raw = (data[6] << 8) | data[7];
-    imu_data.temp = (raw / 340.0f) + 36.53f;
-    
-    // Обработка данных гироскопа (для ±500°/с, LSB = 65.5)
-    raw = (data[8] << 8) | data[9];
-    imu_data.gyro_x = (raw / 65.5f) - calibration.gyro_offset[0];
-    raw = (data[10] << 8) | data[11];
-    imu_data.gyro_y = (raw / 65.5f) - calibration.gyro_offset[1];
-    raw = (data[12] << 8) | data[13];
-    imu_data.gyro_z = (raw / 65.5f) - calibration.gyro_offset[2];
-      // Проверяем данные на валидность
-    if (!CheckSensorLimits(imu_data.accel_x, imu_data.accel_y, imu_data.accel_z,
-                          imu_data.gyro_x, imu_data.gyro_y, imu_data.gyro_z)) {
+
+    // Big-endian регистры: акселерометр, температура, гироскоп
+    for (int i = 0; i < IMU_RAW_CHANNELS; i++) {
+        raw[i] = (int16_t)((frame[1 + 2 * i] << 8) | frame[2 + 2 * i]);
+    }
+
+    // Захват пишет каждый новый отсчет датчика до проверки пределов:
+    // удары и вибрация за пределами ±4 g / ±500 °/с - то, ради чего он нужен
+    uint8_t data_ready = (frame[0] & MPU6050_DATA_RDY_INT) != 0;
+    if (data_ready && capture_enabled) {
+        CapturePush(raw, timestamp_us);
+    }
+
+    ConvertRaw(raw, timestamp_us, &converted);
+
+    // Проверяем данные на валидность: снимок и дециматоры потребителей
+    // получают только отсчеты в пределах
+    if (!CheckSensorLimits(converted.accel_x, converted.accel_y, converted.accel_z,
+                          converted.gyro_x, converted.gyro_y, converted.gyro_z)) {
         consecutive_errors++;
         return;
     }
+    Seqlock_Write(&imu_lock, &imu_data, &converted, sizeof(IMU_Data));
 
-    // Вычисление углов ориентации
-    // Roll (крен)
-    imu_data.roll = atan2f(imu_data.accel_y, imu_data.accel_z) * 180.0f / 3.14159f;
-    
-    // Pitch (тангаж)
-    imu_data.pitch = atan2f(-imu_data.accel_x, 
-        sqrtf(imu_data.accel_y * imu_data.accel_y + 
-              imu_data.accel_z * imu_data.accel_z)) * 180.0f / 3.14159f;
-    
-    // Yaw устанавливается из GPS в main.c
-    imu_data.yaw = 0.0f;
+    if (data_ready) {
+        for (int i = 0; i < IMU_CONSUMER_COUNT; i++) {
+            IMU_Decimator_Push(&decimators[i], raw, timestamp_us);
+        }
+    }
     
     // Обновляем статус успешного чтения
     consecutive_errors = 0;
     last_update = HAL_GetTick();
-    
-    last_update = HAL_GetTick();
 }
 
-const IMU_Data* IMU_GetData(void) {
-    return &imu_data;
+void IMU_GetData(IMU_Data* data) {
+    Seqlock_Read(&imu_lock, data, &imu_data, sizeof(IMU_Data));
 }
 
 void IMU_Calibrate(void) {
@@ -245,5 +338,44 @@ void IMU_Calibrate(void) {
     calibration.accel_offset[2] -= 1.0f; // Учитываем гравитацию
 }
 
+void IMU_SetConsumerRate(IMU_Consumer consumer, uint16_t rate_hz) {
+    if (consumer >= IMU_CONSUMER_COUNT) return;
+    consumer_rates_hz[consumer] = rate_hz;
+    IMU_Decimator_Init(&decimators[consumer], rate_hz);
+}
+
+uint8_t IMU_GetFilteredData(IMU_Consumer consumer, IMU_Data* out) {
+    if (consumer >= IMU_CONSUMER_COUNT || !decimators[consumer].out_valid) {
+        return 0;
+    }
+    ConvertRaw(decimators[consumer].out, decimators[consumer].out_timestamp_us, out);
+    return 1;
+}
+
+void IMU_SetCaptureEnabled(uint8_t enabled) {
+    if (enabled && !capture_enabled) {
+        // Начинаем захват с пустого буфера
+        SpscRecordRing_Clear(&capture_ring);
+        capture_dropped = 0;
+    }
+    capture_enabled = enabled ? 1 : 0;
+}
+
+uint8_t IMU_IsCaptureEnabled(void) {
+    return capture_enabled;
+}
+
+uint16_t IMU_GetCaptureCount(void) {
+    return (uint16_t)SpscRecordRing_Count(&capture_ring);
+}
+
+uint16_t IMU_ReadCaptureSamples(IMU_RawSample* out, uint16_t max_samples) {
+    return (uint16_t)SpscRecordRing_Read(&capture_ring, out, max_samples);
+}
+
+uint32_t IMU_GetCaptureDropped(void) {
+    return capture_dropped;
+}
+
 void IMU_ProcessI2C(void) {}
 void IMU_ProcessError(void) {}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "imu_decimator.h"
+#include <string.h>
+
+void IMU_Decimator_Init(IMU_Decimator* dec, uint16_t out_rate_hz) {
+    memset(dec, 0, sizeof(IMU_Decimator));
+
+    if (out_rate_hz > IMU_SAMPLE_RATE_HZ) {
+        out_rate_hz = IMU_SAMPLE_RATE_HZ;
+    }
+    dec->out_rate_hz = out_rate_hz;
+}
+
+uint8_t IMU_Decimator_Push(IMU_Decimator* dec, const int16_t sample[IMU_RAW_CHANNELS],
+                           uint32_t timestamp_us) {
+    // Остановлен: потребителя нет, отсчеты не накапливаются
+    if (dec->out_rate_hz == 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < IMU_RAW_CHANNELS; i++) {
+        dec->sum[i] += sample[i];
+    }
+    dec->count++;
+
+    // Блок завершается, когда фаза набирает полный период входного потока
+    dec->phase += dec->out_rate_hz;
+    if (dec->phase < IMU_SAMPLE_RATE_HZ) {
+        return 0;
+    }
+    dec->phase -= IMU_SAMPLE_RATE_HZ;
+
+    // Среднее с округлением к ближайшему (симметрично для отрицательных)
+    int32_t half = dec->count / 2;
+    for (int i = 0; i < IMU_RAW_CHANNELS; i++) {
+        int32_t sum = dec->sum[i];
+        dec->out[i] = (int16_t)((sum >= 0 ? sum + half : sum - half) / dec->count);
+        dec->sum[i] = 0;
+    }
+    dec->count = 0;
+    dec->out_timestamp_us = timestamp_us;
+    dec->out_valid = 1;
+
+    return 1;
+}
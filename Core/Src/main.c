@@ -19,6 +19,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "adc.h"
+#include "dma.h"
 #include "i2c.h"
 #include "tim.h"
 #include "usart.h"
@@ -27,6 +28,12 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "timebase.h"
+#include "nav.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "profile.h"
+#include "memory_monitor.h"
 
 /* USER CODE END Includes */
 
@@ -41,7 +48,6 @@ extern UART_HandleTypeDef huart2;
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-#define TELEMETRY_INTERVAL 100
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -52,8 +58,6 @@ extern UART_HandleTypeDef huart2;
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-static uint32_t last_telemetry = 0;
-static uint8_t gps_rx_buffer[1];
 static uint16_t adc_buffer[4];
 /* USER CODE END PV */
 
@@ -65,7 +69,56 @@ void SystemClock_Config(void);
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+// Команды хоста: запуск по приему пакета USB, период - страховочный
+static void Task_Commands(void) {
+  USB_CDC_ProcessReceivedData();
+}
+
+// Опрос IMU вдвое чаще выдачи отсчетов датчиком (125 Гц), чтобы флаг
+// DATA_RDY не пропускался из-за ухода генераторов
+static void Task_Imu(void) {
+  IMU_Update();
+}
+
+// Фильтр GPS/IMU: берет каждый отсчет дециматора управления (50 Гц)
+static void Task_Nav(void) {
+  Nav_Update();
+}
+
+// Разбор кольца UART приемника GPS: по событию DMA (половина буфера или
+// пауза в потоке), период - для таймаутов протокола
+static void Task_Gps(void) {
+  GPS_Update();
+}
+
+// В режиме захвата канал занят потоком сырых отсчетов IMU
+static void Task_Telemetry(void) {
+  if (IMU_IsCaptureEnabled()) {
+    USB_CDC_SendImuCapture();
+  } else {
+    Telemetry_Update();
+  }
+}
+
+// Переинициализация IMU после ошибок, повтор состояния двигателей в
+// сдвиговых регистрах и фоновый просмотр окраски стека
+static void Task_Housekeeping(void) {
+  if (!IMU_IsInitialized()) {
+    IMU_Init();
+  }
+  MotorControl_Update();
+  MemoryMonitor_Update();
+}
 
+// Период, фаза, дедлайн (мс), приоритет, события внеочередного запуска
+static const Scheduler_Task tasks[] = {
+  { "CMD",   Task_Commands,      10, 0,   1, 0, SCHEDULER_EVENT_USB_RX },
+  { "IMU",   Task_Imu,            4, 0,   4, 1, 0 },
+  { "NAV",   Task_Nav,           10, 1,  10, 2, 0 },
+  { "GPS",   Task_Gps,           10, 2,  10, 2, SCHEDULER_EVENT_GPS_RX },
+  { "TLM",   Task_Telemetry,     10, 3,  10, 3, 0 },
+  { "HOUSE", Task_Housekeeping, 100, 7, 100, 4, 0 },
+};
 /* USER CODE END 0 */
 
 /**
@@ -85,18 +138,31 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
+  // Окраска свободной RAM до первых глубоких вызовов
+  MemoryMonitor_Init();
+#ifdef DEBUG
+  // Отладчик не теряет связь с ядром, спящим в WFI
+  HAL_DBGMCU_EnableDBGSleepMode();
+#endif
   /* USER CODE END Init */
 
   /* Configure the system clock */
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  // Профиль тактирования (main.h) подставлен вне блоков USER CODE: после
+  // генерации CubeMX с другим деревом в .ioc запуск останавливается здесь
+  if (HAL_RCC_GetHCLKFreq() != SYSCLK_HZ) {
+    Error_Handler();
+  }
 
+  // Счетчик тактов DWT для профилирования задач и прерываний
+  Profile_Init();
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_ADC1_Init();
   MX_I2C1_Init();
   MX_TIM2_Init();
@@ -109,6 +175,8 @@ int main(void)
   HallSensors_Init();
   IMU_Init();
   GPS_Init();
+  Nav_Init();
+  Telemetry_Init();
   
   // ВАЖНО: Оставляем только один вызов инициализации USB
   MX_USB_DEVICE_Init();
@@ -117,16 +185,15 @@ int main(void)
   HallSensors_Calibrate();
   IMU_Calibrate();
   
-  // Запуск таймеров
-  HAL_TIM_Base_Start_IT(&htim2);
+  // Запуск таймеров: TIM2 - шкала времени и захват PPS (Timebase_Init),
+  // TIM3 - такт планировщика
+  Timebase_Init();
+  Scheduler_Init(tasks, sizeof(tasks) / sizeof(tasks[0]));
   HAL_TIM_Base_Start_IT(&htim3);
   
   // Запуск ADC
   HAL_ADC_Start_DMA(&hadc1, (uint32_t*)adc_buffer, 4);
   
-  // Запуск UART
-  HAL_UART_Receive_IT(&huart2, gps_rx_buffer, 1);
-  
   // Добавляем отладочную информацию об инициализации USB
   USBD_UsrLog("USB Device Initialized");
   /* USER CODE END 2 */
@@ -135,38 +202,17 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-    uint32_t current_time = HAL_GetTick();
-      // Обновление данных IMU и GPS
-    IMU_Update();
-    GPS_Update();
-    
-    // Проверка состояния IMU
-    if (!IMU_IsInitialized()) {
-        IMU_Init(); // Попытка переинициализации
-    }
-    
-    // Отправка телеметрии
-    if (current_time - last_telemetry >= TELEMETRY_INTERVAL) {
-      const IMU_Data* imu_data = IMU_GetData();
-      const GPS_Data* gps_data = GPS_GetData();
-      
-      if (imu_data != NULL && gps_data != NULL && IMU_IsDataValid()) {
-        // Обновляем yaw в IMU данных из GPS курса
-        if (GPS_HasValidCourse()) {
-            ((IMU_Data*)imu_data)->yaw = gps_data->course;
-        } else if (GPS_GetLastKnownCourse() != 0.0f) {
-            ((IMU_Data*)imu_data)->yaw = GPS_GetLastKnownCourse();
-        }
-        
-        USB_CDC_SendTelemetry(imu_data, gps_data);
-      }
-      
-      last_telemetry = current_time;
+    uint8_t ran = Scheduler_Dispatch();
+
+    // Кадры, накопленные задачами в блоке передачи, уходят, как только
+    // конечная точка USB свободна
+    USB_CDC_Flush();
+
+    // Готовых задач нет - сон до такта или события от прерывания
+    if (!ran) {
+      Scheduler_Idle();
     }
-    
-    // Обработка команд управления
-    USB_CDC_ProcessReceivedData();
-    
+
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -193,7 +239,7 @@ void SystemClock_Config(void)
   RCC_OscInitStruct.HSIState = RCC_HSI_ON;
   RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
   RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
-  RCC_OscInitStruct.PLL.PLLMUL = RCC_PLL_MUL6;
+  RCC_OscInitStruct.PLL.PLLMUL = SYSCLK_PLL_MUL;
   if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
   {
     Error_Handler();
@@ -208,13 +254,13 @@ void SystemClock_Config(void)
   RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
   RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
 
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_1) != HAL_OK)
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, SYSCLK_FLASH_LATENCY) != HAL_OK)
   {
     Error_Handler();
   }
   PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_ADC|RCC_PERIPHCLK_USB;
-  PeriphClkInit.AdcClockSelection = RCC_ADCPCLK2_DIV4;
-  PeriphClkInit.UsbClockSelection = RCC_USBCLKSOURCE_PLL;
+  PeriphClkInit.AdcClockSelection = SYSCLK_ADC_CLOCK;
+  PeriphClkInit.UsbClockSelection = SYSCLK_USB_CLOCK;
   if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
   {
     Error_Handler();
@@ -222,7 +268,12 @@ void SystemClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
-
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM3) {
+    Scheduler_Tick();
+  }
+}
 /* USER CODE END 4 */
 
 /**
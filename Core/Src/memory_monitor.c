@@ -0,0 +1,78 @@
+#include "memory_monitor.h"
+#include "main.h"
+
+// Символы скрипта компоновщика STM32F103C8TX_FLASH.ld
+extern uint8_t _sdata;          // Начало RAM (.data)
+extern uint8_t _end;            // Конец .bss, начало кучи
+extern uint8_t _estack;         // Конец RAM, начальная вершина стека
+extern uint8_t _Min_Stack_Size; // Адрес символа - его значение
+
+// Окрашенная область [paint_low, paint_high) и ход просмотра
+static uint32_t* paint_low = NULL;
+static uint32_t* paint_high = NULL;
+static uint32_t* scan_pos = NULL;
+
+// Самое нижнее слово, затертое стеком
+static uint32_t* stack_low = NULL;
+
+// Конец кучи, выровненный вверх до слова
+static uint32_t* MemoryMonitor_HeapTop(void) {
+    uintptr_t top = (uintptr_t)Sysmem_GetHeapEnd();
+    return (uint32_t*)((top + 3U) & ~(uintptr_t)3U);
+}
+
+void MemoryMonitor_Init(void) {
+    uint32_t* low = MemoryMonitor_HeapTop();
+    uint32_t* high = (uint32_t*)(uintptr_t)((__get_MSP() - MEMORY_MONITOR_GUARD) & ~3U);
+
+    for (volatile uint32_t* p = low; p < high; p++) {
+        *p = MEMORY_MONITOR_PAINT;
+    }
+
+    paint_low = low;
+    paint_high = high;
+    scan_pos = low;
+    stack_low = high;
+}
+
+void MemoryMonitor_Update(void) {
+    if (paint_high == NULL) {
+        return;
+    }
+
+    // Выросшая куча затирает окраску снизу: просмотр начинается выше нее
+    uint32_t* start = MemoryMonitor_HeapTop();
+    if (start < paint_low) {
+        start = paint_low;
+    }
+    if (scan_pos < start) {
+        scan_pos = start;
+    }
+
+    // Просмотр вверх до первого затертого слова, проход заканчивается на
+    // известной глубине стека. Следующий проход начинается снова снизу.
+    for (uint32_t n = 0; n < MEMORY_MONITOR_SCAN_WORDS; n++) {
+        if (scan_pos >= stack_low) {
+            scan_pos = start;
+            return;
+        }
+        if (*scan_pos != MEMORY_MONITOR_PAINT) {
+            stack_low = scan_pos;
+            scan_pos = start;
+            return;
+        }
+        scan_pos++;
+    }
+}
+
+void MemoryMonitor_GetStats(MemoryMonitor_Stats* stats) {
+    uint8_t* heap_end = Sysmem_GetHeapEnd();
+    uint8_t* stack_bottom = (stack_low != NULL) ? (uint8_t*)stack_low : (uint8_t*)(uintptr_t)__get_MSP();
+
+    stats->static_ram = (uint32_t)(&_end - &_sdata);
+    stats->heap_used = (uint32_t)(heap_end - &_end);
+    stats->heap_failures = Sysmem_GetFailures();
+    stats->stack_peak = (uint32_t)(&_estack - stack_bottom);
+    stats->stack_reserved = (uint32_t)(uintptr_t)&_Min_Stack_Size;
+    stats->free_min = (stack_bottom > heap_end) ? (uint32_t)(stack_bottom - heap_end) : 0;
+}
@@ -1,4 +1,5 @@
 #include "motor_control.h"
+#include "profile.h"
 
 // Структура для хранения состояния моторов
 static struct {
@@ -82,7 +83,24 @@ void MotorControl_SetMotorState(MotorID motor, MotorState state) {
     MotorControl_Update();
 }
 
+MotorState MotorControl_GetMotorState(MotorID motor) {
+    if(motor >= MOTOR_COUNT) return MOTOR_STOP;
+    return motor_control.states[motor];
+}
+
+void MotorControl_SetDrive(MotorState left, MotorState right) {
+    motor_control.states[MOTOR_LF] = left;
+    motor_control.states[MOTOR_LC] = left;
+    motor_control.states[MOTOR_LR] = left;
+    motor_control.states[MOTOR_RF] = right;
+    motor_control.states[MOTOR_RC] = right;
+    motor_control.states[MOTOR_RR] = right;
+    MotorControl_Update();
+}
+
 void MotorControl_Update(void) {
+    PROFILE_BEGIN(PROFILE_MOTOR_UPDATE);
+
     // Обновляем биты в сдвиговых регистрах
     for(int motor = 0; motor < MOTOR_COUNT; motor++) {
         uint8_t reg = motor_mapping[motor].register_index;
@@ -132,6 +150,8 @@ void MotorControl_Update(void) {
     }
     HAL_GPIO_WritePin(GPIOB, GPIO_PIN_4, GPIO_PIN_SET);
     HAL_GPIO_WritePin(GPIOB, GPIO_PIN_4, GPIO_PIN_RESET);
+
+    PROFILE_END(PROFILE_MOTOR_UPDATE);
 }
 
 void MotorControl_CalibrateSteering(void) {
@@ -0,0 +1,79 @@
+#include "nav.h"
+#include "imu.h"
+#include "gps.h"
+#include <math.h>
+
+#define NAV_GRAVITY    9.80665f
+#define NAV_DEG_TO_RAD 0.0174532925f
+
+static NavEkf nav_ekf;
+static Nav_State nav_state;
+static uint32_t last_imu_timestamp = 0;
+static uint8_t have_imu_timestamp = 0;
+static uint32_t last_gps_updates = 0;
+
+void Nav_Init(void) {
+    NavEkf_Init(&nav_ekf);
+    nav_state.valid = 0;
+    have_imu_timestamp = 0;
+}
+
+static void Nav_Publish(uint32_t timestamp_us) {
+    const float* x = nav_ekf.x;
+    float heading = x[NAV_EKF_PSI] / NAV_DEG_TO_RAD;
+
+    nav_state.north = x[NAV_EKF_PN];
+    nav_state.east = x[NAV_EKF_PE];
+    nav_state.vel_north = x[NAV_EKF_VN];
+    nav_state.vel_east = x[NAV_EKF_VE];
+    nav_state.heading = (heading < 0.0f) ? heading + 360.0f : heading;
+    nav_state.latitude_e7 = nav_ekf.origin_lat_e7 +
+        (int32_t)lroundf(x[NAV_EKF_PN] / nav_ekf.meters_per_e7_lat);
+    nav_state.longitude_e7 = nav_ekf.origin_lon_e7 +
+        (int32_t)lroundf(x[NAV_EKF_PE] / nav_ekf.meters_per_e7_lon);
+    nav_state.timestamp_us = timestamp_us;
+    nav_state.valid = nav_ekf.initialized;
+}
+
+void Nav_Update(void) {
+    IMU_Data imu;
+    GPS_Data gps;
+    uint8_t changed = 0;
+
+    // Прогноз на каждый новый выходной отсчет дециматора управления
+    if (IMU_GetFilteredData(IMU_CONSUMER_CONTROL, &imu) &&
+        (!have_imu_timestamp || imu.timestamp_us != last_imu_timestamp)) {
+        float dt = (imu.timestamp_us - last_imu_timestamp) * 1e-6f;
+
+        if (have_imu_timestamp && dt <= NAV_MAX_PREDICT_DT) {
+            // MPU-6050: X вперед, Y влево, Z вверх; фильтр считает вправо и по часовой
+            NavEkf_Predict(&nav_ekf, dt,
+                           imu.accel_x * NAV_GRAVITY,
+                           -imu.accel_y * NAV_GRAVITY,
+                           -imu.gyro_z * NAV_DEG_TO_RAD);
+            changed = 1;
+        }
+        last_imu_timestamp = imu.timestamp_us;
+        have_imu_timestamp = 1;
+    }
+
+    // Коррекция на каждое новое решение GPS с координатами
+    GPS_GetData(&gps);
+    if (gps.position_updates != last_gps_updates) {
+        last_gps_updates = gps.position_updates;
+        if (gps.fix > 0) {
+            NavEkf_UpdatePosition(&nav_ekf, gps.latitude_e7, gps.longitude_e7);
+            NavEkf_UpdateVelocity(&nav_ekf, gps.speed, gps.course * NAV_DEG_TO_RAD,
+                                  NAV_HEADING_MIN_SPEED);
+            changed = 1;
+        }
+    }
+
+    if (changed) {
+        Nav_Publish(last_imu_timestamp);
+    }
+}
+
+void Nav_GetState(Nav_State* state) {
+    *state = nav_state;
+}
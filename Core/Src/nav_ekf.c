@@ -0,0 +1,155 @@
+#include "nav_ekf.h"
+#include <math.h>
+#include <string.h>
+
+#define NAV_EKF_PI            3.14159265f
+#define NAV_EKF_EARTH_RADIUS  6371000.0f
+#define NAV_EKF_GATE          5.0f      // Порог невязки в СКО
+
+// Начальная неопределенность после первого решения GPS
+#define NAV_EKF_INIT_POS_VAR  25.0f
+#define NAV_EKF_INIT_VEL_VAR  1.0f
+#define NAV_EKF_INIT_PSI_VAR  (NAV_EKF_PI * NAV_EKF_PI)
+
+static float WrapPi(float angle) {
+    while (angle > NAV_EKF_PI) angle -= 2.0f * NAV_EKF_PI;
+    while (angle <= -NAV_EKF_PI) angle += 2.0f * NAV_EKF_PI;
+    return angle;
+}
+
+// Скалярное измерение i-й компоненты состояния: H = e_i, поэтому
+// S = P[i][i] + R и K = P[:,i] / S без матричных произведений
+static uint8_t ScalarUpdate(NavEkf* ekf, uint8_t i, float innovation, float variance) {
+    float s = ekf->P[i][i] + variance;
+    float k[NAV_EKF_STATES];
+    float row[NAV_EKF_STATES];
+
+    if (innovation * innovation > NAV_EKF_GATE * NAV_EKF_GATE * s) {
+        ekf->rejected++;
+        return 0;
+    }
+
+    float inv_s = 1.0f / s;
+    for (uint8_t j = 0; j < NAV_EKF_STATES; j++) {
+        k[j] = ekf->P[j][i] * inv_s;
+        row[j] = ekf->P[i][j];
+        ekf->x[j] += k[j] * innovation;
+    }
+    ekf->x[NAV_EKF_PSI] = WrapPi(ekf->x[NAV_EKF_PSI]);
+
+    // P = (I - K H) P
+    for (uint8_t j = 0; j < NAV_EKF_STATES; j++) {
+        for (uint8_t l = 0; l < NAV_EKF_STATES; l++) {
+            ekf->P[j][l] -= k[j] * row[l];
+        }
+    }
+
+    ekf->updates++;
+    return 1;
+}
+
+void NavEkf_Init(NavEkf* ekf) {
+    memset(ekf, 0, sizeof(NavEkf));
+}
+
+void NavEkf_Predict(NavEkf* ekf, float dt, float accel_fwd, float accel_right, float yaw_rate) {
+    float (*P)[NAV_EKF_STATES] = ekf->P;
+    float* x = ekf->x;
+
+    if (!ekf->initialized || dt <= 0.0f) {
+        return;
+    }
+
+    float s = sinf(x[NAV_EKF_PSI]);
+    float c = cosf(x[NAV_EKF_PSI]);
+    float accel_n = accel_fwd * c - accel_right * s;
+    float accel_e = accel_fwd * s + accel_right * c;
+    float half_dt2 = 0.5f * dt * dt;
+
+    x[NAV_EKF_PN] += x[NAV_EKF_VN] * dt + accel_n * half_dt2;
+    x[NAV_EKF_PE] += x[NAV_EKF_VE] * dt + accel_e * half_dt2;
+    x[NAV_EKF_VN] += accel_n * dt;
+    x[NAV_EKF_VE] += accel_e * dt;
+    x[NAV_EKF_PSI] = WrapPi(x[NAV_EKF_PSI] + yaw_rate * dt);
+
+    // Якобиан F = I + A, ненулевые элементы A:
+    //   dpN/dvN = dpE/dvE = dt
+    //   dpN/dpsi = -aE dt^2/2, dpE/dpsi = aN dt^2/2
+    //   dvN/dpsi = -aE dt,     dvE/dpsi = aN dt
+    float f_pn_psi = -accel_e * half_dt2;
+    float f_pe_psi = accel_n * half_dt2;
+    float f_vn_psi = -accel_e * dt;
+    float f_ve_psi = accel_n * dt;
+
+    // P = F P: строки позиции и скорости получают вклад скорости и курса.
+    // Строки скорости обновляются после позиции, которая их использует.
+    for (uint8_t j = 0; j < NAV_EKF_STATES; j++) {
+        P[NAV_EKF_PN][j] += dt * P[NAV_EKF_VN][j] + f_pn_psi * P[NAV_EKF_PSI][j];
+        P[NAV_EKF_PE][j] += dt * P[NAV_EKF_VE][j] + f_pe_psi * P[NAV_EKF_PSI][j];
+        P[NAV_EKF_VN][j] += f_vn_psi * P[NAV_EKF_PSI][j];
+        P[NAV_EKF_VE][j] += f_ve_psi * P[NAV_EKF_PSI][j];
+    }
+
+    // P = (F P) F^T: то же для столбцов
+    for (uint8_t i = 0; i < NAV_EKF_STATES; i++) {
+        P[i][NAV_EKF_PN] += dt * P[i][NAV_EKF_VN] + f_pn_psi * P[i][NAV_EKF_PSI];
+        P[i][NAV_EKF_PE] += dt * P[i][NAV_EKF_VE] + f_pe_psi * P[i][NAV_EKF_PSI];
+        P[i][NAV_EKF_VN] += f_vn_psi * P[i][NAV_EKF_PSI];
+        P[i][NAV_EKF_VE] += f_ve_psi * P[i][NAV_EKF_PSI];
+    }
+
+    // Шум процесса: белое ускорение и шум гироскопа за шаг
+    float q_accel = NAV_EKF_ACCEL_NOISE * NAV_EKF_ACCEL_NOISE;
+    P[NAV_EKF_PN][NAV_EKF_PN] += q_accel * half_dt2 * half_dt2;
+    P[NAV_EKF_PE][NAV_EKF_PE] += q_accel * half_dt2 * half_dt2;
+    P[NAV_EKF_VN][NAV_EKF_VN] += q_accel * dt * dt;
+    P[NAV_EKF_VE][NAV_EKF_VE] += q_accel * dt * dt;
+    P[NAV_EKF_PSI][NAV_EKF_PSI] += NAV_EKF_GYRO_NOISE * NAV_EKF_GYRO_NOISE * dt * dt;
+
+    ekf->predicts++;
+}
+
+void NavEkf_UpdatePosition(NavEkf* ekf, int32_t lat_e7, int32_t lon_e7) {
+    if (!ekf->initialized) {
+        // Локальная касательная плоскость в точке первого решения
+        float lat_rad = (float)lat_e7 * 1e-7f * NAV_EKF_PI / 180.0f;
+        ekf->origin_lat_e7 = lat_e7;
+        ekf->origin_lon_e7 = lon_e7;
+        ekf->meters_per_e7_lat = 1e-7f * NAV_EKF_PI / 180.0f * NAV_EKF_EARTH_RADIUS;
+        ekf->meters_per_e7_lon = ekf->meters_per_e7_lat * cosf(lat_rad);
+
+        memset(ekf->x, 0, sizeof(ekf->x));
+        memset(ekf->P, 0, sizeof(ekf->P));
+        ekf->P[NAV_EKF_PN][NAV_EKF_PN] = NAV_EKF_INIT_POS_VAR;
+        ekf->P[NAV_EKF_PE][NAV_EKF_PE] = NAV_EKF_INIT_POS_VAR;
+        ekf->P[NAV_EKF_VN][NAV_EKF_VN] = NAV_EKF_INIT_VEL_VAR;
+        ekf->P[NAV_EKF_VE][NAV_EKF_VE] = NAV_EKF_INIT_VEL_VAR;
+        ekf->P[NAV_EKF_PSI][NAV_EKF_PSI] = NAV_EKF_INIT_PSI_VAR;
+        ekf->initialized = 1;
+        return;
+    }
+
+    // Разности в целых единицах 1e-7 градуса, без потери точности float
+    float north = (float)(lat_e7 - ekf->origin_lat_e7) * ekf->meters_per_e7_lat;
+    float east = (float)(lon_e7 - ekf->origin_lon_e7) * ekf->meters_per_e7_lon;
+    float variance = NAV_EKF_GPS_POS_NOISE * NAV_EKF_GPS_POS_NOISE;
+
+    ScalarUpdate(ekf, NAV_EKF_PN, north - ekf->x[NAV_EKF_PN], variance);
+    ScalarUpdate(ekf, NAV_EKF_PE, east - ekf->x[NAV_EKF_PE], variance);
+}
+
+void NavEkf_UpdateVelocity(NavEkf* ekf, float speed, float course, float min_speed) {
+    if (!ekf->initialized) {
+        return;
+    }
+
+    float variance = NAV_EKF_GPS_VEL_NOISE * NAV_EKF_GPS_VEL_NOISE;
+    ScalarUpdate(ekf, NAV_EKF_VN, speed * cosf(course) - ekf->x[NAV_EKF_VN], variance);
+    ScalarUpdate(ekf, NAV_EKF_VE, speed * sinf(course) - ekf->x[NAV_EKF_VE], variance);
+
+    // На малой скорости курс GPS шумит и о направлении корпуса не говорит
+    if (speed > min_speed) {
+        ScalarUpdate(ekf, NAV_EKF_PSI, WrapPi(course - ekf->x[NAV_EKF_PSI]),
+                     NAV_EKF_GPS_HDG_NOISE * NAV_EKF_GPS_HDG_NOISE);
+    }
+}
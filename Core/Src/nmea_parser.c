@@ -0,0 +1,478 @@
+#include "nmea_parser.h"
+#include <string.h>
+
+// Индексы полей RMC: $GPRMC,time,status,lat,N/S,lon,E/W,speed,course,date,...
+#define RMC_TIME    1
+#define RMC_STATUS  2
+#define RMC_LAT     3
+#define RMC_LAT_NS  4
+#define RMC_LON     5
+#define RMC_LON_EW  6
+#define RMC_SPEED   7
+#define RMC_COURSE  8
+#define RMC_DATE    9
+
+// Индексы полей GGA: $GPGGA,time,lat,N/S,lon,E/W,quality,sats,hdop,alt,...
+#define GGA_TIME     1
+#define GGA_LAT      2
+#define GGA_LAT_NS   3
+#define GGA_LON      4
+#define GGA_LON_EW   5
+#define GGA_QUALITY  6
+#define GGA_SATS     7
+#define GGA_ALTITUDE 9
+
+// Индексы полей GSA: $GNGSA,mode,fix,prn1..prn12,pdop,hdop,vdop[,system]
+#define GSA_FIX_MODE 2
+#define GSA_PDOP     15
+#define GSA_HDOP     16
+#define GSA_VDOP     17
+
+// Индексы полей GSV: $GPGSV,total,index,in_view,{prn,elev,az,snr}x4[,signal]
+#define GSV_TOTAL    1
+#define GSV_INDEX    2
+#define GSV_IN_VIEW  3
+#define GSV_FIRST    4
+
+// Индексы полей VTG: $GNVTG,course,T,course_mag,M,speed_kn,N,speed_kmh,K[,mode]
+#define VTG_COURSE   1
+#define VTG_SPEED_KN 5
+
+// Код предложения из трех символов после talker ID
+#define NMEA_ID(a, b, c) (((uint32_t)(a) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(c))
+
+static int8_t HexValue(uint8_t c) {
+    if (c >= '0' && c <= '9') return (int8_t)(c - '0');
+    if (c >= 'A' && c <= 'F') return (int8_t)(c - 'A' + 10);
+    if (c >= 'a' && c <= 'f') return (int8_t)(c - 'a' + 10);
+    return -1;
+}
+
+static void StartSentence(NMEA_Parser* parser) {
+    parser->length = 0;
+    parser->field_count = 1;
+    parser->field_start[0] = 0;
+    parser->checksum = 0;
+    parser->state = NMEA_STATE_BODY;
+}
+
+void NMEA_Init(NMEA_Parser* parser) {
+    memset(parser, 0, sizeof(NMEA_Parser));
+    parser->state = NMEA_STATE_IDLE;
+    parser->subscriptions = NMEA_SUBSCRIBE_ALL;
+}
+
+void NMEA_SetSubscriptions(NMEA_Parser* parser, uint32_t mask) {
+    parser->subscriptions = mask;
+}
+
+NMEA_SentenceType NMEA_SentenceFromCode(const char* code) {
+    if (code[0] == '\0' || code[1] == '\0' || code[2] == '\0') {
+        return NMEA_SENTENCE_NONE;
+    }
+
+    // Код сравнивается одним числом без strcmp
+    switch (NMEA_ID(code[0], code[1], code[2])) {
+        case NMEA_ID('R', 'M', 'C'): return NMEA_SENTENCE_RMC;
+        case NMEA_ID('G', 'G', 'A'): return NMEA_SENTENCE_GGA;
+        case NMEA_ID('G', 'S', 'A'): return NMEA_SENTENCE_GSA;
+        case NMEA_ID('G', 'S', 'V'): return NMEA_SENTENCE_GSV;
+        case NMEA_ID('V', 'T', 'G'): return NMEA_SENTENCE_VTG;
+        default:                     return NMEA_SENTENCE_NONE;
+    }
+}
+
+// Адрес "ttSSS" принят целиком (первая запятая): тип определяется здесь
+// один раз, неподписанные предложения дальше не копируются
+static uint8_t AcceptAddress(NMEA_Parser* parser) {
+    parser->sentence_type = NMEA_SENTENCE_NONE;
+    if (parser->length == 6) { // 5 символов адреса + '\0' на месте запятой
+        parser->sentence_type = (uint8_t)NMEA_SentenceFromCode(&parser->line[2]);
+    }
+    return (parser->subscriptions & NMEA_SENTENCE_BIT(parser->sentence_type)) != 0;
+}
+
+void NMEA_Reset(NMEA_Parser* parser) {
+    parser->state = NMEA_STATE_IDLE;
+}
+
+uint8_t NMEA_ParseByte(NMEA_Parser* parser, uint8_t byte) {
+    // Быстрый путь для обычных символов поля: коды '$', '*', ',' и CR/LF меньше ','
+    if (parser->state == NMEA_STATE_BODY && byte > ',' &&
+        parser->length < NMEA_MAX_SENTENCE) {
+        parser->checksum ^= byte;
+        parser->line[parser->length++] = (char)byte;
+        return 0;
+    }
+
+    // '$' всегда начинает новое предложение, даже посреди текущего
+    if (byte == '$') {
+        if (parser->state != NMEA_STATE_IDLE && parser->state != NMEA_STATE_SKIP) {
+            parser->format_errors++;
+        }
+        StartSentence(parser);
+        return 0;
+    }
+
+    switch (parser->state) {
+        case NMEA_STATE_BODY:
+            if (byte == '*') {
+                parser->line[parser->length] = '\0';
+                parser->state = NMEA_STATE_CHECKSUM_HI;
+                return 0;
+            }
+            if (byte == '\r' || byte == '\n' || parser->length >= NMEA_MAX_SENTENCE) {
+                // Конец строки без контрольной суммы или слишком длинное предложение
+                parser->format_errors++;
+                parser->state = NMEA_STATE_IDLE;
+                return 0;
+            }
+
+            parser->checksum ^= byte;
+            if (byte == ',') {
+                // Поля разделяются на месте, пустые поля сохраняются
+                parser->line[parser->length++] = '\0';
+                if (parser->field_count == 1 && !AcceptAddress(parser)) {
+                    parser->skipped++;
+                    parser->state = NMEA_STATE_SKIP;
+                    return 0;
+                }
+                if (parser->field_count >= NMEA_MAX_FIELDS) {
+                    parser->format_errors++;
+                    parser->state = NMEA_STATE_IDLE;
+                    return 0;
+                }
+                parser->field_start[parser->field_count++] = parser->length;
+            }
+            else {
+                parser->line[parser->length++] = (char)byte;
+            }
+            return 0;
+
+        case NMEA_STATE_CHECKSUM_HI: {
+            int8_t value = HexValue(byte);
+            if (value < 0) {
+                parser->format_errors++;
+                parser->state = NMEA_STATE_IDLE;
+                return 0;
+            }
+            parser->received_checksum = (uint8_t)(value << 4);
+            parser->state = NMEA_STATE_CHECKSUM_LO;
+            return 0;
+        }
+
+        case NMEA_STATE_CHECKSUM_LO: {
+            int8_t value = HexValue(byte);
+            parser->state = NMEA_STATE_IDLE;
+            if (value < 0) {
+                parser->format_errors++;
+                return 0;
+            }
+            parser->received_checksum |= (uint8_t)value;
+            if (parser->received_checksum != parser->checksum) {
+                parser->checksum_errors++;
+                return 0;
+            }
+            parser->sentences++;
+            return 1;
+        }
+
+        case NMEA_STATE_SKIP:
+            if (byte == '\n') {
+                parser->state = NMEA_STATE_IDLE;
+            }
+            return 0;
+
+        default:
+            return 0;
+    }
+}
+
+const char* NMEA_GetField(const NMEA_Parser* parser, uint8_t index) {
+    if (index >= parser->field_count) {
+        return "";
+    }
+    return &parser->line[parser->field_start[index]];
+}
+
+// Ровно count десятичных цифр, 0 если встретился другой символ
+static uint8_t ParseDigits(const char* s, uint8_t count, uint32_t* out) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (s[i] < '0' || s[i] > '9') return 0;
+        value = value * 10 + (uint32_t)(s[i] - '0');
+    }
+    *out = value;
+    return 1;
+}
+
+// Десятичное число с фиксированной точкой: "12.3456" при decimals=2 -> 1234.
+// Лишние знаки дробной части отбрасываются, недостающие дополняются нулями.
+static uint8_t ParseFixed(const char* s, uint8_t decimals, int32_t* out) {
+    uint8_t negative = 0;
+    uint8_t digits = 0;
+    int32_t value = 0;
+
+    if (*s == '-') {
+        negative = 1;
+        s++;
+    }
+    while (*s >= '0' && *s <= '9') {
+        value = value * 10 + (*s++ - '0');
+        digits++;
+    }
+    if (*s == '.') {
+        s++;
+        for (uint8_t i = 0; i < decimals; i++) {
+            value *= 10;
+            if (*s >= '0' && *s <= '9') {
+                value += *s++ - '0';
+                digits++;
+            }
+        }
+    }
+    else {
+        for (uint8_t i = 0; i < decimals; i++) {
+            value *= 10;
+        }
+    }
+
+    if (digits == 0) return 0;
+    *out = negative ? -value : value;
+    return 1;
+}
+
+// Время "hhmmss[.sss]" в миллисекундах от начала суток
+static uint8_t ParseTime(const char* s, uint32_t* time_ms) {
+    uint32_t hh, mm, ss;
+    int32_t frac_ms = 0;
+
+    if (!ParseDigits(s, 2, &hh) || !ParseDigits(s + 2, 2, &mm) || !ParseDigits(s + 4, 2, &ss)) {
+        return 0;
+    }
+    if (s[6] == '.') {
+        ParseFixed(s + 6, 3, &frac_ms);
+    }
+
+    *time_ms = ((hh * 60 + mm) * 60 + ss) * 1000 + (uint32_t)frac_ms;
+    return 1;
+}
+
+// Координата "(d)ddmm.mmmmmm" в градусах * 1e7 без плавающей точки
+static uint8_t ParseCoordinate(const char* s, const char* hemisphere, int32_t* out) {
+    uint32_t whole = 0;
+    uint32_t frac_e6 = 0;
+    uint8_t digits = 0;
+
+    while (*s >= '0' && *s <= '9') {
+        whole = whole * 10 + (uint32_t)(*s++ - '0');
+        digits++;
+    }
+    if (digits < 3) return 0;
+
+    if (*s == '.') {
+        s++;
+        uint32_t scale = 100000;
+        while (*s >= '0' && *s <= '9' && scale > 0) {
+            frac_e6 += (uint32_t)(*s++ - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    // Минуты * 1e6, затем минуты / 60 * 1e7 = минуты_e6 / 6
+    uint32_t degrees = whole / 100;
+    uint32_t minutes_e6 = (whole % 100) * 1000000U + frac_e6;
+    int32_t value = (int32_t)(degrees * 10000000U + (minutes_e6 + 3) / 6);
+
+    if (hemisphere[0] == 'S' || hemisphere[0] == 'W') {
+        value = -value;
+    }
+    *out = value;
+    return 1;
+}
+
+// Скорость в узлах * 1000 -> мм/с (1 узел = 1852/3600 м/с)
+static uint8_t ParseSpeed(const char* s, uint32_t* speed_mmps) {
+    int32_t value;
+    if (!ParseFixed(s, 3, &value) || value < 0) return 0;
+    *speed_mmps = (uint32_t)value * 1852U / 3600U;
+    return 1;
+}
+
+static uint8_t ParseCourse(const char* s, uint16_t* course_e2) {
+    int32_t value;
+    if (!ParseFixed(s, 2, &value) || value < 0) return 0;
+    *course_e2 = (uint16_t)value;
+    return 1;
+}
+
+static void DecodeRMC(const NMEA_Parser* parser, NMEA_Fix* fix) {
+    const char* field;
+    uint32_t dd, mm, yy;
+
+    if (ParseTime(NMEA_GetField(parser, RMC_TIME), &fix->time_ms)) {
+        fix->valid |= NMEA_FIX_TIME;
+    }
+
+    field = NMEA_GetField(parser, RMC_STATUS);
+    fix->fix = (field[0] == 'A') ? 1 : 0;
+    fix->valid |= NMEA_FIX_STATUS;
+
+    if (ParseCoordinate(NMEA_GetField(parser, RMC_LAT), NMEA_GetField(parser, RMC_LAT_NS),
+                        &fix->latitude_e7) &&
+        ParseCoordinate(NMEA_GetField(parser, RMC_LON), NMEA_GetField(parser, RMC_LON_EW),
+                        &fix->longitude_e7)) {
+        fix->valid |= NMEA_FIX_POSITION;
+    }
+
+    if (ParseSpeed(NMEA_GetField(parser, RMC_SPEED), &fix->speed_mmps)) {
+        fix->valid |= NMEA_FIX_SPEED;
+    }
+
+    if (ParseCourse(NMEA_GetField(parser, RMC_COURSE), &fix->course_e2)) {
+        fix->valid |= NMEA_FIX_COURSE;
+    }
+
+    field = NMEA_GetField(parser, RMC_DATE);
+    if (ParseDigits(field, 2, &dd) && ParseDigits(field + 2, 2, &mm) && ParseDigits(field + 4, 2, &yy)) {
+        fix->day = (uint8_t)dd;
+        fix->month = (uint8_t)mm;
+        fix->year = (uint16_t)(2000 + yy);
+        fix->valid |= NMEA_FIX_DATE;
+    }
+}
+
+static void DecodeGGA(const NMEA_Parser* parser, NMEA_Fix* fix) {
+    int32_t value;
+
+    if (ParseTime(NMEA_GetField(parser, GGA_TIME), &fix->time_ms)) {
+        fix->valid |= NMEA_FIX_TIME;
+    }
+
+    if (ParseCoordinate(NMEA_GetField(parser, GGA_LAT), NMEA_GetField(parser, GGA_LAT_NS),
+                        &fix->latitude_e7) &&
+        ParseCoordinate(NMEA_GetField(parser, GGA_LON), NMEA_GetField(parser, GGA_LON_EW),
+                        &fix->longitude_e7)) {
+        fix->valid |= NMEA_FIX_POSITION;
+    }
+
+    if (ParseFixed(NMEA_GetField(parser, GGA_QUALITY), 0, &value)) {
+        fix->fix = (uint8_t)value;
+        fix->valid |= NMEA_FIX_STATUS;
+    }
+
+    if (ParseFixed(NMEA_GetField(parser, GGA_SATS), 0, &value)) {
+        fix->satellites = (uint8_t)value;
+        fix->valid |= NMEA_FIX_SATELLITES;
+    }
+
+    if (ParseFixed(NMEA_GetField(parser, GGA_ALTITUDE), 2, &value)) {
+        fix->altitude_cm = value;
+        fix->valid |= NMEA_FIX_ALTITUDE;
+    }
+}
+
+static void DecodeGSA(const NMEA_Parser* parser, NMEA_Fix* fix) {
+    int32_t mode, pdop, hdop, vdop;
+
+    if (ParseFixed(NMEA_GetField(parser, GSA_FIX_MODE), 0, &mode) &&
+        ParseFixed(NMEA_GetField(parser, GSA_PDOP), 2, &pdop) &&
+        ParseFixed(NMEA_GetField(parser, GSA_HDOP), 2, &hdop) &&
+        ParseFixed(NMEA_GetField(parser, GSA_VDOP), 2, &vdop)) {
+        fix->fix_mode = (uint8_t)mode;
+        fix->pdop_e2 = (uint16_t)pdop;
+        fix->hdop_e2 = (uint16_t)hdop;
+        fix->vdop_e2 = (uint16_t)vdop;
+        fix->valid |= NMEA_FIX_DOP;
+    }
+}
+
+static void DecodeGSV(const NMEA_Parser* parser, NMEA_Fix* fix) {
+    int32_t total, index, in_view;
+
+    if (!ParseFixed(NMEA_GetField(parser, GSV_TOTAL), 0, &total) ||
+        !ParseFixed(NMEA_GetField(parser, GSV_INDEX), 0, &index) ||
+        !ParseFixed(NMEA_GetField(parser, GSV_IN_VIEW), 0, &in_view)) {
+        return;
+    }
+
+    fix->gsv_total = (uint8_t)total;
+    fix->gsv_index = (uint8_t)index;
+    fix->in_view = (uint8_t)in_view;
+    fix->sat_count = 0;
+
+    // Блоки по 4 поля, пустой SNR - спутник не отслеживается
+    for (uint8_t i = 0; i < NMEA_GSV_SATS_PER_MSG; i++) {
+        uint8_t field = (uint8_t)(GSV_FIRST + i * 4);
+        int32_t prn, elevation = 0, azimuth = 0, snr = 0;
+
+        if (!ParseFixed(NMEA_GetField(parser, field), 0, &prn)) {
+            break;
+        }
+        ParseFixed(NMEA_GetField(parser, field + 1), 0, &elevation);
+        ParseFixed(NMEA_GetField(parser, field + 2), 0, &azimuth);
+        ParseFixed(NMEA_GetField(parser, field + 3), 0, &snr);
+
+        NMEA_Satellite* sat = &fix->sats[fix->sat_count++];
+        sat->prn = (uint8_t)prn;
+        sat->elevation = (uint8_t)elevation;
+        sat->azimuth = (uint16_t)azimuth;
+        sat->snr = (uint8_t)snr;
+    }
+    fix->valid |= NMEA_FIX_SKY;
+}
+
+static void DecodeVTG(const NMEA_Parser* parser, NMEA_Fix* fix) {
+    if (ParseCourse(NMEA_GetField(parser, VTG_COURSE), &fix->course_e2)) {
+        fix->valid |= NMEA_FIX_COURSE;
+    }
+    if (ParseSpeed(NMEA_GetField(parser, VTG_SPEED_KN), &fix->speed_mmps)) {
+        fix->valid |= NMEA_FIX_SPEED;
+    }
+}
+
+static NMEA_Talker DecodeTalker(char a, char b) {
+    switch ((a << 8) | b) {
+        case ('G' << 8) | 'P': return NMEA_TALKER_GPS;
+        case ('G' << 8) | 'L': return NMEA_TALKER_GLONASS;
+        case ('G' << 8) | 'A': return NMEA_TALKER_GALILEO;
+        case ('G' << 8) | 'B':
+        case ('B' << 8) | 'D': return NMEA_TALKER_BEIDOU;
+        case ('G' << 8) | 'N': return NMEA_TALKER_GNSS;
+        default:               return NMEA_TALKER_UNKNOWN;
+    }
+}
+
+NMEA_SentenceType NMEA_DecodeSentence(const NMEA_Parser* parser, NMEA_Fix* fix) {
+    const char* address = NMEA_GetField(parser, 0);
+
+    fix->valid = 0;
+
+    // Тип уже определен по адресу "ttSSS" в AcceptAddress, talker ID - два
+    // первых символа
+    if (parser->sentence_type == NMEA_SENTENCE_NONE) {
+        return NMEA_SENTENCE_NONE;
+    }
+    fix->talker = (uint8_t)DecodeTalker(address[0], address[1]);
+
+    switch (parser->sentence_type) {
+        case NMEA_SENTENCE_RMC:
+            DecodeRMC(parser, fix);
+            break;
+        case NMEA_SENTENCE_GGA:
+            DecodeGGA(parser, fix);
+            break;
+        case NMEA_SENTENCE_GSA:
+            DecodeGSA(parser, fix);
+            break;
+        case NMEA_SENTENCE_GSV:
+            DecodeGSV(parser, fix);
+            break;
+        case NMEA_SENTENCE_VTG:
+            DecodeVTG(parser, fix);
+            break;
+        default:
+            return NMEA_SENTENCE_NONE;
+    }
+    return (NMEA_SentenceType)parser->sentence_type;
+}
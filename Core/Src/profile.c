@@ -0,0 +1,75 @@
+#include "profile.h"
+#include <string.h>
+
+#if !defined(__arm__)
+#include <time.h>
+#endif
+
+static Profile_Stats profile_stats[PROFILE_COUNT];
+
+#if defined(__arm__)
+
+void Profile_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    Profile_Reset();
+}
+
+uint32_t Profile_GetClockHz(void) {
+    return SystemCoreClock;
+}
+
+// Прерывания запрещаются на время копирования: точку могло писать прерывание
+void Profile_GetStats(Profile_Id id, Profile_Stats* stats) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = profile_stats[id];
+    __set_PRIMASK(primask);
+}
+
+void Profile_Reset(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(profile_stats, 0, sizeof(profile_stats));
+    __set_PRIMASK(primask);
+}
+
+#else
+
+uint32_t Profile_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+void Profile_Init(void) {
+    Profile_Reset();
+}
+
+uint32_t Profile_GetClockHz(void) {
+    return 1000000000U;
+}
+
+void Profile_GetStats(Profile_Id id, Profile_Stats* stats) {
+    *stats = profile_stats[id];
+}
+
+void Profile_Reset(void) {
+    memset(profile_stats, 0, sizeof(profile_stats));
+}
+
+#endif
+
+void Profile_Record(Profile_Id id, uint32_t cycles) {
+    Profile_Stats* stats = &profile_stats[id];
+
+    if (stats->calls == 0 || cycles < stats->min) {
+        stats->min = cycles;
+    }
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+    stats->total += cycles;
+    stats->calls++;
+}
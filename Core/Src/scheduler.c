@@ -0,0 +1,215 @@
+#include "scheduler.h"
+#include "timebase.h"
+#include "profile.h"
+#include "histogram.h"
+#include "lockfree.h"
+#include <string.h>
+
+_Static_assert(PROFILE_TASK_LAST - PROFILE_TASK_FIRST + 1 == SCHEDULER_MAX_TASKS,
+               "Profile_Id task slots");
+
+static const Scheduler_Task* task_table = NULL;
+static uint8_t task_count = 0;
+
+// Срок следующего запуска задачи (в тактах) и ее статистика
+static uint32_t next_release[SCHEDULER_MAX_TASKS];
+static Scheduler_Stats task_stats[SCHEDULER_MAX_TASKS];
+
+// Счетчик тактов и время последнего такта по Timebase_GetMicros (ISR)
+static volatile uint32_t ticks = 0;
+static volatile uint32_t tick_us = 0;
+
+// События от прерываний и задачи, разбуженные ими (бит на задачу)
+static EventFlags events;
+static uint32_t signaled = 0;
+
+// Такт, на котором Scheduler_Dispatch не нашел готовых задач
+static uint32_t idle_tick = 0;
+
+// Учет простоя: время в WFI за текущее окно и доля за прошлое
+static uint32_t idle_us = 0;
+static uint32_t window_start_us = 0;
+static volatile uint16_t idle_permille = 0;
+
+void Scheduler_Init(const Scheduler_Task* tasks, uint8_t count) {
+    if (count > SCHEDULER_MAX_TASKS) {
+        count = SCHEDULER_MAX_TASKS;
+    }
+
+    task_table = tasks;
+    task_count = count;
+    memset(task_stats, 0, sizeof(task_stats));
+    signaled = 0;
+    idle_us = 0;
+    window_start_us = Timebase_GetMicros();
+
+    uint32_t now = ticks;
+    for (uint8_t i = 0; i < count; i++) {
+        next_release[i] = now + tasks[i].phase_ms;
+    }
+}
+
+void Scheduler_Tick(void) {
+    uint32_t now_us = Timebase_GetMicros();
+
+    if (ticks != 0) {
+        Histogram_RecordDeviation(HISTOGRAM_TICK_JITTER, now_us - tick_us,
+                                  1000000U / SCHEDULER_TICK_HZ);
+    }
+    tick_us = now_us;
+    ticks++;
+}
+
+// Согласованная пара счетчика тактов и времени такта
+static uint32_t Scheduler_ReadTick(uint32_t* stamp_us) {
+    uint32_t now;
+    do {
+        now = ticks;
+        *stamp_us = tick_us;
+    } while (now != ticks);
+    return now;
+}
+
+// Доля простоя по окнам: считается и без захода в Scheduler_Idle,
+// иначе при полной загрузке окно не закрылось бы
+static void Scheduler_UpdateLoad(uint32_t now_us) {
+    uint32_t elapsed = now_us - window_start_us;
+    // До первого такта now_us может быть раньше начала окна
+    if ((int32_t)elapsed < (int32_t)SCHEDULER_LOAD_WINDOW_US) {
+        return;
+    }
+    idle_permille = (uint16_t)(((uint64_t)idle_us * 1000U) / elapsed);
+    idle_us = 0;
+    window_start_us = now_us;
+}
+
+uint8_t Scheduler_Dispatch(void) {
+    uint32_t now_us;
+    uint32_t now = Scheduler_ReadTick(&now_us);
+    int8_t ready = -1;
+
+    Scheduler_UpdateLoad(now_us);
+
+    uint32_t posted = EventFlags_Take(&events, 0xFFFFFFFFU);
+    if (posted) {
+        for (uint8_t i = 0; i < task_count; i++) {
+            if (task_table[i].events & posted) {
+                signaled |= 1U << i;
+            }
+        }
+    }
+
+    // Наиболее приоритетная из готовых; при равном приоритете - первая в таблице
+    for (uint8_t i = 0; i < task_count; i++) {
+        if ((int32_t)(now - next_release[i]) < 0 && !(signaled & (1U << i))) {
+            continue;
+        }
+        if (ready < 0 || task_table[i].priority < task_table[ready].priority) {
+            ready = (int8_t)i;
+        }
+    }
+    if (ready < 0) {
+        idle_tick = now;
+        return 0;
+    }
+
+    const Scheduler_Task* task = &task_table[ready];
+    Scheduler_Stats* stats = &task_stats[ready];
+    uint32_t release = next_release[ready];
+    uint8_t due = (int32_t)(now - release) >= 0;
+    signaled &= ~(1U << ready);
+
+    uint32_t start_us = Timebase_GetMicros();
+    uint32_t start_cycles = Profile_Now();
+    task->run();
+    uint32_t cycles = Profile_Now() - start_cycles;
+    Profile_Record((Profile_Id)(PROFILE_TASK_FIRST + ready), cycles);
+
+    // Срок задачи отстоит от последнего такта на (now - release) тактов
+    uint32_t latency_us = (start_us - now_us) + (now - release) * (1000000U / SCHEDULER_TICK_HZ);
+    uint32_t exec_us = cycles / (Profile_GetClockHz() / 1000000U);
+
+    stats->runs++;
+    stats->last_exec_us = exec_us;
+    if (exec_us > stats->max_exec_us) {
+        stats->max_exec_us = exec_us;
+    }
+
+    // Внеочередной запуск по событию не сдвигает сетку периода
+    if (!due) {
+        stats->event_runs++;
+        return 1;
+    }
+
+    if (latency_us > stats->max_latency_us) {
+        stats->max_latency_us = latency_us;
+    }
+    if (latency_us + exec_us > task->deadline_ms * (1000000U / SCHEDULER_TICK_HZ)) {
+        stats->overruns++;
+    }
+
+    // Следующий срок по сетке периода. Сроки, отставшие на целый период,
+    // пропускаются: задача запускается один раз, а не пачкой подряд.
+    release += task->period_ms;
+    uint32_t after = ticks;
+    if ((int32_t)(after - release) >= (int32_t)task->period_ms) {
+        uint32_t missed = (after - release) / task->period_ms;
+        stats->skipped += missed;
+        release += missed * task->period_ms;
+    }
+    next_release[ready] = release;
+    return 1;
+}
+
+void Scheduler_PostEvent(uint32_t mask) {
+    EventFlags_Set(&events, mask);
+}
+
+void Scheduler_Idle(void) {
+    uint32_t start_us = Timebase_GetMicros();
+    uint32_t end_us = start_us;
+
+    // Проверка и WFI при запрещенных прерываниях: прерывание, пришедшее
+    // после проверки, остается отложенным и все равно будит WFI, а его
+    // обработчик выполняется сразу после __enable_irq
+    __disable_irq();
+    if (ticks == idle_tick && !EventFlags_Peek(&events)) {
+        __WFI();
+        end_us = Timebase_GetMicros();
+    }
+    __enable_irq();
+
+    idle_us += end_us - start_us;
+}
+
+uint16_t Scheduler_GetIdlePermille(void) {
+    return idle_permille;
+}
+
+uint32_t Scheduler_GetTicks(void) {
+    return ticks;
+}
+
+uint8_t Scheduler_GetTaskCount(void) {
+    return task_count;
+}
+
+const char* Scheduler_GetTaskName(uint8_t index) {
+    return (index < task_count) ? task_table[index].name : NULL;
+}
+
+uint8_t Scheduler_GetStats(uint8_t index, Scheduler_Stats* stats) {
+    if (index >= task_count) {
+        return 0;
+    }
+    *stats = task_stats[index];
+    return 1;
+}
+
+uint32_t Scheduler_GetTotalOverruns(void) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < task_count; i++) {
+        total += task_stats[i].overruns;
+    }
+    return total;
+}
@@ -33,6 +33,8 @@
 #include "imu.h"
 #include "gps.h"
 #include "usb_cdc.h"
+#include "profile.h"
+#include "timebase.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -76,6 +78,7 @@ extern ADC_HandleTypeDef hadc1;
 extern I2C_HandleTypeDef hi2c1;
 extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim3;
+extern DMA_HandleTypeDef hdma_usart2_rx;
 extern UART_HandleTypeDef huart2;
 /* USER CODE BEGIN EV */
 
@@ -219,17 +222,32 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32f1xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles DMA1 channel6 global interrupt.
+  */
+void DMA1_Channel6_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Channel6_IRQn 0 */
+  PROFILE_BEGIN(PROFILE_ISR_DMA1_CH6);
+  /* USER CODE END DMA1_Channel6_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_usart2_rx);
+  /* USER CODE BEGIN DMA1_Channel6_IRQn 1 */
+  PROFILE_END(PROFILE_ISR_DMA1_CH6);
+  /* USER CODE END DMA1_Channel6_IRQn 1 */
+}
+
 /**
   * @brief This function handles ADC1 and ADC2 global interrupts.
   */
 void ADC1_2_IRQHandler(void)
 {
   /* USER CODE BEGIN ADC1_2_IRQn 0 */
+  PROFILE_BEGIN(PROFILE_ISR_ADC);
   HallSensors_ProcessADC();
   /* USER CODE END ADC1_2_IRQn 0 */
   HAL_ADC_IRQHandler(&hadc1);
   /* USER CODE BEGIN ADC1_2_IRQn 1 */
-
+  PROFILE_END(PROFILE_ISR_ADC);
   /* USER CODE END ADC1_2_IRQn 1 */
 }
 
@@ -239,11 +257,12 @@ void ADC1_2_IRQHandler(void)
 void USB_LP_CAN1_RX0_IRQHandler(void)
 {
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 0 */
+  PROFILE_BEGIN(PROFILE_ISR_USB);
   // USB_CDC_ProcessReceivedData(); // закомментировано, требуется аргументы
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 0 */
   HAL_PCD_IRQHandler(&hpcd_USB_FS);
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 1 */
-
+  PROFILE_END(PROFILE_ISR_USB);
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 1 */
 }
 
@@ -253,11 +272,14 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
 void TIM2_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM2_IRQn 0 */
-  MotorControl_Update();
+  PROFILE_BEGIN(PROFILE_ISR_TIM2);
+  // Переполнение шкалы времени учитывается до HAL: HAL сбрасывает флаг
+  // раньше вызова обработчика, и читатель увидел бы время на 65 мс назад
+  Timebase_OnOverflow();
   /* USER CODE END TIM2_IRQn 0 */
   HAL_TIM_IRQHandler(&htim2);
   /* USER CODE BEGIN TIM2_IRQn 1 */
-
+  PROFILE_END(PROFILE_ISR_TIM2);
   /* USER CODE END TIM2_IRQn 1 */
 }
 
@@ -267,11 +289,11 @@ void TIM2_IRQHandler(void)
 void TIM3_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM3_IRQn 0 */
-  IMU_Update();
+  PROFILE_BEGIN(PROFILE_ISR_TIM3);
   /* USER CODE END TIM3_IRQn 0 */
   HAL_TIM_IRQHandler(&htim3);
   /* USER CODE BEGIN TIM3_IRQn 1 */
-
+  PROFILE_END(PROFILE_ISR_TIM3);
   /* USER CODE END TIM3_IRQn 1 */
 }
 
@@ -281,11 +303,12 @@ void TIM3_IRQHandler(void)
 void I2C1_EV_IRQHandler(void)
 {
   /* USER CODE BEGIN I2C1_EV_IRQn 0 */
+  PROFILE_BEGIN(PROFILE_ISR_I2C1);
   IMU_ProcessI2C();
   /* USER CODE END I2C1_EV_IRQn 0 */
   HAL_I2C_EV_IRQHandler(&hi2c1);
   /* USER CODE BEGIN I2C1_EV_IRQn 1 */
-
+  PROFILE_END(PROFILE_ISR_I2C1);
   /* USER CODE END I2C1_EV_IRQn 1 */
 }
 
@@ -309,11 +332,11 @@ void I2C1_ER_IRQHandler(void)
 void USART2_IRQHandler(void)
 {
   /* USER CODE BEGIN USART2_IRQn 0 */
-  GPS_ProcessUART();
+  PROFILE_BEGIN(PROFILE_ISR_USART2);
   /* USER CODE END USART2_IRQn 0 */
   HAL_UART_IRQHandler(&huart2);
   /* USER CODE BEGIN USART2_IRQn 1 */
-
+  PROFILE_END(PROFILE_ISR_USART2);
   /* USER CODE END USART2_IRQn 1 */
 }
 
@@ -29,6 +29,11 @@
  */
 static uint8_t *__sbrk_heap_end = NULL;
 
+/**
+ * Number of _sbrk() requests refused to protect the MSP stack
+ */
+static uint32_t __sbrk_failures = 0;
+
 /**
  * @brief _sbrk() allocates memory to the newlib heap and is used by malloc
  *        and others from the C library
@@ -68,6 +73,7 @@ void *_sbrk(ptrdiff_t incr)
   /* Protect heap from growing into the reserved MSP stack */
   if (__sbrk_heap_end + incr > max_heap)
   {
+    __sbrk_failures++;
     errno = ENOMEM;
     return (void *)-1;
   }
@@ -77,3 +83,23 @@ void *_sbrk(ptrdiff_t incr)
 
   return (void *)prev_heap_end;
 }
+
+/**
+ * @brief Current end of the newlib heap, for RAM usage diagnostics
+ *
+ * @return '_end' before the first allocation, otherwise the _sbrk() break
+ */
+uint8_t *Sysmem_GetHeapEnd(void)
+{
+  extern uint8_t _end; /* Symbol defined in the linker script */
+
+  return (NULL == __sbrk_heap_end) ? &_end : __sbrk_heap_end;
+}
+
+/**
+ * @brief Number of _sbrk() requests refused with ENOMEM
+ */
+uint32_t Sysmem_GetFailures(void)
+{
+  return __sbrk_failures;
+}
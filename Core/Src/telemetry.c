@@ -0,0 +1,327 @@
+#include "telemetry.h"
+#include "frame.h"
+#include "timebase.h"
+#include "nav.h"
+#include "profile.h"
+#include "histogram.h"
+#include "scheduler.h"
+#include "memory_monitor.h"
+#include <string.h>
+
+_Static_assert(MOTOR_COUNT == FRAME_MOTOR_COUNT, "Frame_Motor layout");
+
+// Расписание канала: период и время следующей отправки (мс),
+// время последней отправки по расписанию для гистограммы отклонений
+typedef struct {
+    uint16_t rate_hz;
+    uint16_t period_ms;
+    uint32_t next_ms;
+    uint32_t last_sent_us;
+    uint8_t sent;
+} Telemetry_Schedule;
+
+static Telemetry_Schedule schedule[TELEMETRY_CH_COUNT];
+static uint8_t send_all = 0;
+
+// Последний усредненный отсчет потока IMU_CONSUMER_TELEMETRY: каналы IMU
+// и ориентации берут его, не расходуя дециматор дважды
+static IMU_Data imu_cache;
+static uint8_t imu_cache_valid = 0;
+
+static const struct {
+    const char* name;
+    uint8_t length;
+} channel_names[TELEMETRY_CH_COUNT] = {
+    { "IMU", 3 }, { "ATT", 3 }, { "GPS", 3 }, { "HALL", 4 },
+    { "MOTOR", 5 }, { "DIAG", 4 }, { "NAV", 3 }, { "PROF", 4 }
+};
+
+// Нагрузка кадра профиля: все точки с вызовами
+static uint8_t profile_payload[sizeof(Frame_ProfileHeader) +
+                               PROFILE_COUNT * sizeof(Frame_ProfileEntry)];
+
+// Дециматор телеметрии IMU работает на частоте самого частого из
+// каналов IMU и ориентации
+static void Telemetry_UpdateImuRate(void) {
+    uint16_t rate = schedule[TELEMETRY_CH_IMU].rate_hz;
+    if (schedule[TELEMETRY_CH_ATTITUDE].rate_hz > rate) {
+        rate = schedule[TELEMETRY_CH_ATTITUDE].rate_hz;
+    }
+    // Оба канала выключены: дециматор останавливается, а не копит отсчеты,
+    // старое среднее после включения не отправляется
+    IMU_SetConsumerRate(IMU_CONSUMER_TELEMETRY, rate);
+    if (rate == 0) {
+        imu_cache_valid = 0;
+    }
+}
+
+void Telemetry_Init(void) {
+    memset(schedule, 0, sizeof(schedule));
+    imu_cache_valid = 0;
+
+    Telemetry_SetRate(TELEMETRY_CH_IMU, 10);
+    Telemetry_SetRate(TELEMETRY_CH_ATTITUDE, 10);
+    Telemetry_SetRate(TELEMETRY_CH_GPS, 10);
+    Telemetry_SetRate(TELEMETRY_CH_HALL, 10);
+    Telemetry_SetRate(TELEMETRY_CH_NAV, 10);
+    Telemetry_SetRate(TELEMETRY_CH_DIAG, 1);
+}
+
+uint16_t Telemetry_SetRate(Telemetry_Channel channel, uint16_t rate_hz) {
+    if (channel >= TELEMETRY_CH_COUNT) {
+        return 0;
+    }
+    if (rate_hz > TELEMETRY_MAX_RATE_HZ) {
+        rate_hz = TELEMETRY_MAX_RATE_HZ;
+    }
+
+    Telemetry_Schedule* ch = &schedule[channel];
+    ch->rate_hz = rate_hz;
+    ch->period_ms = rate_hz ? (uint16_t)(1000U / rate_hz) : 0;
+    ch->next_ms = HAL_GetTick();
+    ch->sent = 0;
+
+    if (channel == TELEMETRY_CH_IMU || channel == TELEMETRY_CH_ATTITUDE) {
+        Telemetry_UpdateImuRate();
+    }
+    return rate_hz;
+}
+
+uint16_t Telemetry_GetRate(Telemetry_Channel channel) {
+    return (channel < TELEMETRY_CH_COUNT) ? schedule[channel].rate_hz : 0;
+}
+
+Telemetry_Channel Telemetry_ChannelFromName(const char* name, uint16_t length) {
+    for (uint8_t i = 0; i < TELEMETRY_CH_COUNT; i++) {
+        if (channel_names[i].length == length && memcmp(channel_names[i].name, name, length) == 0) {
+            return (Telemetry_Channel)i;
+        }
+    }
+    return TELEMETRY_CH_COUNT;
+}
+
+void Telemetry_RequestAll(void) {
+    send_all = 1;
+}
+
+static void Telemetry_SendImu(void) {
+    Frame_Imu frame;
+    Timebase_UtcTime utc;
+
+    frame.timestamp_us = imu_cache.timestamp_us;
+    frame.accel[0] = Frame_ToFixed16(imu_cache.accel_x, FRAME_ACCEL_SCALE);
+    frame.accel[1] = Frame_ToFixed16(imu_cache.accel_y, FRAME_ACCEL_SCALE);
+    frame.accel[2] = Frame_ToFixed16(imu_cache.accel_z, FRAME_ACCEL_SCALE);
+    frame.gyro[0] = Frame_ToFixed16(imu_cache.gyro_x, FRAME_GYRO_SCALE);
+    frame.gyro[1] = Frame_ToFixed16(imu_cache.gyro_y, FRAME_GYRO_SCALE);
+    frame.gyro[2] = Frame_ToFixed16(imu_cache.gyro_z, FRAME_GYRO_SCALE);
+    frame.mag[0] = Frame_ToFixed16(imu_cache.mag_x, FRAME_MAG_SCALE);
+    frame.mag[1] = Frame_ToFixed16(imu_cache.mag_y, FRAME_MAG_SCALE);
+    frame.mag[2] = Frame_ToFixed16(imu_cache.mag_z, FRAME_MAG_SCALE);
+    frame.temp = Frame_ToFixed16(imu_cache.temp, FRAME_TEMP_SCALE);
+
+    // Метка времени UTC по PPS для отсчета IMU; остальные каналы передают
+    // локальное время, хост переводит его по этой привязке
+    frame.sync = (uint8_t)Timebase_ToUtc(imu_cache.timestamp_us, &utc);
+    frame.utc_seconds = utc.seconds;
+    frame.utc_micros = utc.micros;
+
+    Histogram_Record(HISTOGRAM_SENSOR_AGE, Timebase_GetMicros() - imu_cache.timestamp_us);
+    USB_CDC_SendFrame(FRAME_TYPE_IMU, &frame, sizeof(frame));
+}
+
+static void Telemetry_SendAttitude(void) {
+    Frame_Attitude frame;
+    float yaw = imu_cache.yaw;
+
+    // Рыскание берется из курса GPS: магнитометра на плате нет
+    frame.yaw_source = 0;
+    if (GPS_HasValidCourse()) {
+        GPS_Data gps;
+        GPS_GetData(&gps);
+        yaw = gps.course;
+        frame.yaw_source = 1;
+    } else if (GPS_GetLastKnownCourse() != 0.0f) {
+        yaw = GPS_GetLastKnownCourse();
+        frame.yaw_source = 2;
+    }
+
+    frame.timestamp_us = imu_cache.timestamp_us;
+    frame.attitude[0] = Frame_ToFixed16(imu_cache.roll, FRAME_ANGLE_SCALE);
+    frame.attitude[1] = Frame_ToFixed16(imu_cache.pitch, FRAME_ANGLE_SCALE);
+    frame.attitude[2] = Frame_ToFixed16(yaw, FRAME_ANGLE_SCALE);
+
+    USB_CDC_SendFrame(FRAME_TYPE_ATTITUDE, &frame, sizeof(frame));
+}
+
+static void Telemetry_SendGps(void) {
+    Frame_Gps frame;
+    GPS_Data gps;
+    GPS_GetData(&gps);
+
+    frame.timestamp_us = gps.timestamp_us;
+    frame.latitude_e7 = gps.latitude_e7;
+    frame.longitude_e7 = gps.longitude_e7;
+    frame.altitude = (int32_t)(gps.altitude * FRAME_ALT_SCALE);
+    frame.speed = Frame_ToFixedU16(gps.speed, FRAME_SPEED_SCALE);
+    frame.course = Frame_ToFixedU16(gps.course, FRAME_COURSE_SCALE);
+    frame.satellites = gps.satellites;
+    frame.fix = gps.fix;
+    frame.time_of_day_ms = ((gps.hour * 60UL + gps.minute) * 60UL + gps.second) * 1000UL +
+                           gps.millisecond;
+    frame.day = gps.day;
+    frame.month = gps.month;
+    frame.year = gps.year;
+    frame.hdop = Frame_ToFixedU16(gps.hdop, FRAME_DOP_SCALE);
+
+    USB_CDC_SendFrame(FRAME_TYPE_GPS, &frame, sizeof(frame));
+}
+
+static void Telemetry_SendHall(void) {
+    Frame_Hall frame;
+
+    frame.timestamp_us = Timebase_GetMicros();
+    frame.hall[0] = Frame_ToFixed16(HallSensors_GetAngle(HALL_ALF), FRAME_ANGLE_SCALE);
+    frame.hall[1] = Frame_ToFixed16(HallSensors_GetAngle(HALL_ALR), FRAME_ANGLE_SCALE);
+    frame.hall[2] = Frame_ToFixed16(HallSensors_GetAngle(HALL_ARF), FRAME_ANGLE_SCALE);
+    frame.hall[3] = Frame_ToFixed16(HallSensors_GetAngle(HALL_ARR), FRAME_ANGLE_SCALE);
+
+    USB_CDC_SendFrame(FRAME_TYPE_HALL, &frame, sizeof(frame));
+}
+
+static void Telemetry_SendMotor(void) {
+    Frame_Motor frame;
+
+    frame.timestamp_us = Timebase_GetMicros();
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        frame.states[i] = (uint8_t)MotorControl_GetMotorState((MotorID)i);
+    }
+
+    USB_CDC_SendFrame(FRAME_TYPE_MOTOR, &frame, sizeof(frame));
+}
+
+static void Telemetry_SendDiag(void) {
+    Frame_Diag frame;
+    Timebase_UtcTime utc;
+    MemoryMonitor_Stats memory;
+    uint32_t latency_last, latency_max, late;
+
+    USB_CDC_GetCommandLatency(&latency_last, &latency_max, &late);
+    MemoryMonitor_GetStats(&memory);
+
+    frame.timestamp_us = Timebase_GetMicros();
+    frame.uptime_ms = HAL_GetTick();
+    frame.usb_tx_dropped = USB_CDC_GetTxDropped();
+    frame.usb_rx_overruns = USB_CDC_GetRxOverruns();
+    frame.command_latency_last_us = latency_last;
+    frame.command_latency_max_us = latency_max;
+    frame.command_late = late;
+    frame.gps_protocol = (uint8_t)GPS_GetProtocol();
+    frame.sync = (uint8_t)Timebase_ToUtc(frame.timestamp_us, &utc);
+    frame.drift_ppb = Timebase_GetDriftPpb();
+    frame.cpu_idle_permille = Scheduler_GetIdlePermille();
+    frame.stack_peak = (uint16_t)memory.stack_peak;
+    frame.ram_free_min = (uint16_t)memory.free_min;
+
+    USB_CDC_SendFrame(FRAME_TYPE_DIAG, &frame, sizeof(frame));
+}
+
+static void Telemetry_SendNav(void) {
+    Frame_Nav frame;
+    Nav_State nav;
+    Nav_GetState(&nav);
+
+    frame.timestamp_us = nav.timestamp_us;
+    frame.valid = nav.valid;
+    frame.latitude_e7 = nav.latitude_e7;
+    frame.longitude_e7 = nav.longitude_e7;
+    frame.vel_north = Frame_ToFixed16(nav.vel_north, FRAME_SPEED_SCALE);
+    frame.vel_east = Frame_ToFixed16(nav.vel_east, FRAME_SPEED_SCALE);
+    frame.heading = Frame_ToFixedU16(nav.heading, FRAME_COURSE_SCALE);
+
+    USB_CDC_SendFrame(FRAME_TYPE_NAV, &frame, sizeof(frame));
+}
+
+static void Telemetry_SendProfile(void) {
+    Frame_ProfileHeader* header = (Frame_ProfileHeader*)profile_payload;
+    Frame_ProfileEntry* entries = (Frame_ProfileEntry*)&profile_payload[sizeof(Frame_ProfileHeader)];
+    Profile_Stats stats;
+    uint8_t count = 0;
+
+    for (uint8_t id = 0; id < PROFILE_COUNT; id++) {
+        Profile_GetStats((Profile_Id)id, &stats);
+        if (stats.calls == 0) {
+            continue;
+        }
+        Frame_ProfileEntry* entry = &entries[count++];
+        entry->id = id;
+        entry->reserved = 0;
+        entry->calls = stats.calls;
+        entry->min_cycles = stats.min;
+        entry->avg_cycles = (uint32_t)(stats.total / stats.calls);
+        entry->max_cycles = stats.max;
+    }
+
+    header->clock_hz = Profile_GetClockHz();
+    header->count = count;
+    memset(header->reserved, 0, sizeof(header->reserved));
+
+    USB_CDC_SendFrame(FRAME_TYPE_PROFILE, profile_payload,
+                      sizeof(Frame_ProfileHeader) + count * sizeof(Frame_ProfileEntry));
+}
+
+static void (* const channel_send[TELEMETRY_CH_COUNT])(void) = {
+    Telemetry_SendImu,
+    Telemetry_SendAttitude,
+    Telemetry_SendGps,
+    Telemetry_SendHall,
+    Telemetry_SendMotor,
+    Telemetry_SendDiag,
+    Telemetry_SendNav,
+    Telemetry_SendProfile
+};
+
+void Telemetry_Update(void) {
+    uint32_t now = HAL_GetTick();
+    uint8_t all = send_all;
+
+    send_all = 0;
+
+    // Новое среднее за период телеметрии, если дециматор его набрал
+    if (IMU_IsDataValid() && IMU_GetFilteredData(IMU_CONSUMER_TELEMETRY, &imu_cache)) {
+        imu_cache_valid = 1;
+    }
+
+    for (uint8_t i = 0; i < TELEMETRY_CH_COUNT; i++) {
+        Telemetry_Schedule* ch = &schedule[i];
+
+        uint8_t due = (int32_t)(now - ch->next_ms) >= 0;
+        if (ch->rate_hz == 0 || (!all && !due)) {
+            continue;
+        }
+
+        // Отставание больше периода не догоняется пачкой кадров. Отправка
+        // по запросу TELEMETRY расписание не сдвигает.
+        if (due) {
+            ch->next_ms += ch->period_ms;
+            if ((int32_t)(now - ch->next_ms) >= 0) {
+                ch->next_ms = now + ch->period_ms;
+            }
+        }
+
+        if ((i == TELEMETRY_CH_IMU || i == TELEMETRY_CH_ATTITUDE) && !imu_cache_valid) {
+            continue;
+        }
+        // Отправки по запросу вне расписания в отклонения не входят
+        if (due) {
+            uint32_t now_us = Timebase_GetMicros();
+            if (ch->sent) {
+                Histogram_RecordDeviation(HISTOGRAM_TELEMETRY_JITTER, now_us - ch->last_sent_us,
+                                          ch->period_ms * 1000U);
+            }
+            ch->last_sent_us = now_us;
+            ch->sent = 1;
+        }
+        channel_send[i]();
+    }
+}
@@ -21,7 +21,18 @@
 #include "tim.h"
 
 /* USER CODE BEGIN 0 */
-
+// Предделитель по фактической частоте шины. CubeMX пишет в Init.Prescaler
+// значение из .ioc (71 - для 72 МГц), поэтому вычисленное выставляется
+// здесь, в блоках USER CODE, и переживает генерацию кода.
+static void TIM_ApplyPrescaler(TIM_HandleTypeDef* htim)
+{
+  htim->Init.Prescaler = TIM_PrescalerFor(htim->Instance, TIM_COUNT_HZ);
+  __HAL_TIM_SET_PRESCALER(htim, htim->Init.Prescaler);
+  // PSC вступает в силу по событию обновления; его флаг сбрасывается,
+  // чтобы прерывание не пришло сразу после запуска таймера
+  HAL_TIM_GenerateEvent(htim, TIM_EVENTSOURCE_UPDATE);
+  __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+}
 /* USER CODE END 0 */
 
 TIM_HandleTypeDef htim2;
@@ -37,14 +48,16 @@ void MX_TIM2_Init(void)
 
   TIM_ClockConfigTypeDef sClockSourceConfig = {0};
   TIM_MasterConfigTypeDef sMasterConfig = {0};
+  TIM_IC_InitTypeDef sConfigIC = {0};
 
   /* USER CODE BEGIN TIM2_Init 1 */
-
+  // Свободный счет TIM_COUNT_HZ (1 МГц) на полном 16-битном периоде,
+  // канал 1 захватывает фронт PPS приемника GPS
   /* USER CODE END TIM2_Init 1 */
   htim2.Instance = TIM2;
   htim2.Init.Prescaler = 71;
   htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim2.Init.Period = 999;
+  htim2.Init.Period = 65535;
   htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
   htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
   if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
@@ -56,14 +69,26 @@ void MX_TIM2_Init(void)
   {
     Error_Handler();
   }
+  if (HAL_TIM_IC_Init(&htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
   sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
   sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
   if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
   {
     Error_Handler();
   }
+  sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_RISING;
+  sConfigIC.ICSelection = TIM_ICSELECTION_DIRECTTI;
+  sConfigIC.ICPrescaler = TIM_ICPSC_DIV1;
+  sConfigIC.ICFilter = 4;
+  if (HAL_TIM_IC_ConfigChannel(&htim2, &sConfigIC, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE BEGIN TIM2_Init 2 */
-
+  TIM_ApplyPrescaler(&htim2);
   /* USER CODE END TIM2_Init 2 */
 
 }
@@ -79,7 +104,7 @@ void MX_TIM3_Init(void)
   TIM_MasterConfigTypeDef sMasterConfig = {0};
 
   /* USER CODE BEGIN TIM3_Init 1 */
-
+  // Такт планировщика 1 кГц: счет TIM_COUNT_HZ, период 1000
   /* USER CODE END TIM3_Init 1 */
   htim3.Instance = TIM3;
   htim3.Init.Prescaler = 71;
@@ -103,7 +128,7 @@ void MX_TIM3_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN TIM3_Init 2 */
-
+  TIM_ApplyPrescaler(&htim3);
   /* USER CODE END TIM3_Init 2 */
 
 }
@@ -111,6 +136,7 @@ void MX_TIM3_Init(void)
 void HAL_TIM_Base_MspInit(TIM_HandleTypeDef* tim_baseHandle)
 {
 
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
   if(tim_baseHandle->Instance==TIM2)
   {
   /* USER CODE BEGIN TIM2_MspInit 0 */
@@ -119,6 +145,15 @@ void HAL_TIM_Base_MspInit(TIM_HandleTypeDef* tim_baseHandle)
     /* TIM2 clock enable */
     __HAL_RCC_TIM2_CLK_ENABLE();
 
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    /**TIM2 GPIO Configuration
+    PA0-WKUP     ------> TIM2_CH1
+    */
+    GPIO_InitStruct.Pin = GPIO_PIN_0;
+    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
     /* TIM2 interrupt Init */
     HAL_NVIC_SetPriority(TIM2_IRQn, 4, 0);
     HAL_NVIC_EnableIRQ(TIM2_IRQn);
@@ -154,6 +189,11 @@ void HAL_TIM_Base_MspDeInit(TIM_HandleTypeDef* tim_baseHandle)
     /* Peripheral clock disable */
     __HAL_RCC_TIM2_CLK_DISABLE();
 
+    /**TIM2 GPIO Configuration
+    PA0-WKUP     ------> TIM2_CH1
+    */
+    HAL_GPIO_DeInit(GPIOA, GPIO_PIN_0);
+
     /* TIM2 interrupt Deinit */
     HAL_NVIC_DisableIRQ(TIM2_IRQn);
   /* USER CODE BEGIN TIM2_MspDeInit 1 */
@@ -177,5 +217,26 @@ void HAL_TIM_Base_MspDeInit(TIM_HandleTypeDef* tim_baseHandle)
 }
 
 /* USER CODE BEGIN 1 */
+// TIM1 тактируется от APB2, TIM2-TIM4 от APB1. При делителе шины, отличном
+// от 1, таймеры получают удвоенную частоту шины (RM0008, 7.2).
+uint32_t TIM_GetClockHz(TIM_TypeDef* instance)
+{
+  if (instance == TIM1) {
+    uint32_t pclk2 = HAL_RCC_GetPCLK2Freq();
+    return ((RCC->CFGR & RCC_CFGR_PPRE2) == RCC_CFGR_PPRE2_DIV1) ? pclk2 : 2U * pclk2;
+  }
+  uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+  return ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_CFGR_PPRE1_DIV1) ? pclk1 : 2U * pclk1;
+}
 
+uint32_t TIM_PrescalerFor(TIM_TypeDef* instance, uint32_t count_hz)
+{
+  uint32_t prescaler = TIM_GetClockHz(instance) / count_hz;
+  if (prescaler == 0) {
+    prescaler = 1;
+  } else if (prescaler > 65536U) {
+    prescaler = 65536U;
+  }
+  return prescaler - 1;
+}
 /* USER CODE END 1 */
@@ -0,0 +1,184 @@
+#include "timebase.h"
+#include "seqlock.h"
+#include "tim.h"
+
+// Привязка к PPS, пишет только прерывание захвата
+typedef struct {
+    uint32_t anchor_local_us;  // Локальное время последнего импульса PPS
+    uint32_t anchor_seconds;   // Секунда Unix, которую отметил этот импульс
+    uint32_t period_q8;        // Локальных мкс на секунду UTC (* 256)
+    uint8_t synced;
+} Timebase_Discipline;
+
+static Timebase_Discipline discipline = {0, 0, 1000000U << 8, 0};
+static Seqlock discipline_lock;
+
+// Старшие разряды шкалы: переполнения 16-битного счетчика TIM2 (ISR)
+static volatile uint32_t tim2_wraps = 0;
+
+static volatile uint32_t pps_edges = 0;         // Принятых импульсов PPS (ISR)
+static volatile uint32_t pps_last_local_us = 0; // Локальное время последнего импульса (ISR)
+static uint32_t pps_glitches = 0;
+
+// Время для следующего импульса, выставляет GPS_Update
+static volatile uint32_t pps_pending_seconds = 0;
+static volatile uint32_t pps_pending_edge = 0;  // Номер импульса, к которому относится время
+static volatile uint8_t pps_pending = 0;
+
+// Согласованная пара: число переполнений и счетчик TIM2
+static inline uint32_t Timebase_ReadCounter(uint32_t* wraps) {
+    uint32_t counter;
+    uint32_t pending;
+
+    // Повторяем чтение, если между чтениями обработано переполнение
+    do {
+        *wraps = tim2_wraps;
+        counter = TIM2->CNT;
+        pending = TIM2->SR & TIM_SR_UIF;
+    } while (*wraps != tim2_wraps);
+
+    // Переполнение уже произошло, но еще не учтено (чтение из прерывания
+    // с более высоким приоритетом или при запрещенных прерываниях). Малое
+    // значение счетчика - он прочитан после переполнения.
+    if (pending && counter < 0x8000U) {
+        (*wraps)++;
+    }
+    return counter;
+}
+
+uint32_t Timebase_GetMicros(void) {
+    uint32_t wraps;
+    uint32_t counter = Timebase_ReadCounter(&wraps);
+    return (wraps << 16) | counter;
+}
+
+void Timebase_OnOverflow(void) {
+    // Учет переполнения и сброс флага неразделимы для читателей из
+    // прерываний с более высоким приоритетом
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (TIM2->SR & TIM_SR_UIF) {
+        TIM2->SR = ~(uint32_t)TIM_SR_UIF;
+        tim2_wraps++;
+    }
+    __set_PRIMASK(primask);
+}
+
+void Timebase_Init(void) {
+    Seqlock_Init(&discipline_lock);
+    __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+    HAL_TIM_Base_Start_IT(&htim2);
+    HAL_TIM_IC_Start_IT(&htim2, TIM_CHANNEL_1);
+}
+
+// Фронт PPS: захват и шкала Timebase_GetMicros считают один и тот же
+// счетчик TIM2, момент захвата отстоит от текущего на разницу младших 16 бит
+static void Timebase_OnPps(uint16_t capture) {
+    uint32_t now_us = Timebase_GetMicros();
+    uint32_t edge_us = now_us - (uint16_t)((uint16_t)now_us - capture);
+    Timebase_Discipline next = discipline;
+
+    if (pps_edges > 0) {
+        uint32_t interval = edge_us - pps_last_local_us;
+        uint32_t seconds = (interval + 500000U) / 1000000U;
+        int32_t error = (int32_t)(interval - seconds * 1000000U);
+
+        // Помеха на линии: импульс не в начале секунды. Следующий интервал
+        // отсчитывается от него, привязка к UTC при этом не сбивается.
+        pps_last_local_us = edge_us;
+        if (seconds == 0 || error > TIMEBASE_PPS_TOLERANCE_US * (int32_t)seconds ||
+            error < -TIMEBASE_PPS_TOLERANCE_US * (int32_t)seconds) {
+            pps_glitches++;
+            return;
+        }
+
+        // Фильтр длины секунды в локальных мкс (постоянная времени ~8 с)
+        if (seconds == 1) {
+            next.period_q8 += (uint32_t)(((int32_t)((interval << 8) - next.period_q8)) >> 3);
+        }
+    }
+
+    pps_edges++;
+    pps_last_local_us = edge_us;
+
+    if (pps_pending && pps_pending_edge == pps_edges) {
+        next.anchor_seconds = pps_pending_seconds;
+        next.synced = 1;
+    }
+    else if (next.synced) {
+        // Число секунд от прошлой привязки, с учетом пропущенных импульсов
+        uint64_t elapsed_q8 = (uint64_t)(edge_us - next.anchor_local_us) << 8;
+        next.anchor_seconds += (uint32_t)((elapsed_q8 + next.period_q8 / 2) / next.period_q8);
+    }
+    pps_pending = 0;
+    next.anchor_local_us = edge_us;
+
+    Seqlock_Write(&discipline_lock, &discipline, &next, sizeof(discipline));
+}
+
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
+    if (htim->Instance == TIM2 && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1) {
+        Timebase_OnPps((uint16_t)HAL_TIM_ReadCapturedValue(htim, TIM_CHANNEL_1));
+    }
+}
+
+void Timebase_SetGpsTime(uint32_t unix_seconds, uint16_t millisecond) {
+    uint32_t edges = pps_edges;
+
+    // Сообщение о секунде S приходит после импульса S: привязываем его время
+    // к следующему импульсу, если тот еще не наступил
+    if (millisecond != 0 || edges == 0 ||
+        Timebase_GetMicros() - pps_last_local_us > 900000U) {
+        return;
+    }
+
+    pps_pending = 0;
+    pps_pending_seconds = unix_seconds + 1;
+    pps_pending_edge = edges + 1;
+    pps_pending = 1;
+}
+
+Timebase_SyncState Timebase_ToUtc(uint32_t local_us, Timebase_UtcTime* utc) {
+    Timebase_Discipline d;
+    Seqlock_Read(&discipline_lock, &d, &discipline, sizeof(d));
+
+    if (!d.synced) {
+        utc->seconds = 0;
+        utc->micros = 0;
+        return TIMEBASE_SYNC_NONE;
+    }
+
+    // Отсчет может быть и до, и после импульса привязки
+    int32_t delta_local = (int32_t)(local_us - d.anchor_local_us);
+    int64_t delta_us = ((int64_t)delta_local * (1000000LL << 8)) / d.period_q8;
+    int64_t total_us = (int64_t)d.anchor_seconds * 1000000LL + delta_us;
+
+    utc->seconds = (uint32_t)(total_us / 1000000LL);
+    utc->micros = (uint32_t)(total_us % 1000000LL);
+
+    if (Timebase_GetMicros() - d.anchor_local_us > TIMEBASE_PPS_HOLDOVER_US) {
+        return TIMEBASE_SYNC_HOLDOVER;
+    }
+    return TIMEBASE_SYNC_LOCKED;
+}
+
+int32_t Timebase_GetDriftPpb(void) {
+    Timebase_Discipline d;
+    Seqlock_Read(&discipline_lock, &d, &discipline, sizeof(d));
+
+    // (period - 1e6) / 1e6 * 1e9, period в единицах 1/256 мкс
+    return (int32_t)(((int64_t)d.period_q8 - (1000000LL << 8)) * 1000 / 256);
+}
+
+uint32_t Timebase_MakeUnixTime(uint16_t year, uint8_t month, uint8_t day, uint32_t seconds_of_day) {
+    // Число дней от 1970-01-01 по григорианскому календарю (год с марта)
+    int32_t y = (int32_t)year - (month <= 2 ? 1 : 0);
+    int32_t era = y / 400;
+    int32_t yoe = y - era * 400;
+    int32_t mp = (month + 9) % 12;
+    int32_t doy = (153 * mp + 2) / 5 + day - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int32_t days = era * 146097 + doe - 719468;
+
+    return (uint32_t)days * 86400U + seconds_of_day;
+}
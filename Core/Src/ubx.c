@@ -0,0 +1,206 @@
+#include "ubx.h"
+#include <string.h>
+
+// Порт UART1 приемника, режим 8N1, входные протоколы UBX+NMEA
+#define UBX_PORT_UART1     1
+#define UBX_MODE_8N1       0x000008D0U
+#define UBX_PROTO_UBX_NMEA 0x0003U
+
+static uint16_t ReadU2(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t ReadU4(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void WriteU2(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void WriteU4(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static void Checksum(UBX_Parser* parser, uint8_t byte) {
+    parser->ck_a += byte;
+    parser->ck_b += parser->ck_a;
+}
+
+void UBX_Init(UBX_Parser* parser) {
+    memset(parser, 0, sizeof(UBX_Parser));
+    parser->state = UBX_STATE_SYNC1;
+}
+
+uint8_t UBX_InFrame(const UBX_Parser* parser) {
+    return parser->state != UBX_STATE_SYNC1;
+}
+
+uint8_t UBX_ParseByte(UBX_Parser* parser, uint8_t byte) {
+    switch (parser->state) {
+        case UBX_STATE_SYNC1:
+            if (byte == UBX_SYNC1) {
+                parser->state = UBX_STATE_SYNC2;
+            }
+            return 0;
+
+        case UBX_STATE_SYNC2:
+            parser->state = (byte == UBX_SYNC2) ? UBX_STATE_CLASS : UBX_STATE_SYNC1;
+            parser->ck_a = 0;
+            parser->ck_b = 0;
+            return 0;
+
+        case UBX_STATE_CLASS:
+            parser->msg_class = byte;
+            Checksum(parser, byte);
+            parser->state = UBX_STATE_ID;
+            return 0;
+
+        case UBX_STATE_ID:
+            parser->msg_id = byte;
+            Checksum(parser, byte);
+            parser->state = UBX_STATE_LEN1;
+            return 0;
+
+        case UBX_STATE_LEN1:
+            parser->length = byte;
+            Checksum(parser, byte);
+            parser->state = UBX_STATE_LEN2;
+            return 0;
+
+        case UBX_STATE_LEN2:
+            parser->length |= (uint16_t)(byte << 8);
+            Checksum(parser, byte);
+            parser->index = 0;
+            parser->state = (parser->length > 0) ? UBX_STATE_PAYLOAD : UBX_STATE_CK_A;
+            return 0;
+
+        case UBX_STATE_PAYLOAD:
+            // Длинные сообщения проходят через сумму, но не сохраняются
+            if (parser->index < UBX_MAX_PAYLOAD) {
+                parser->payload[parser->index] = byte;
+            }
+            parser->index++;
+            Checksum(parser, byte);
+            if (parser->index >= parser->length) {
+                parser->state = UBX_STATE_CK_A;
+            }
+            return 0;
+
+        case UBX_STATE_CK_A:
+            if (byte != parser->ck_a) {
+                parser->checksum_errors++;
+                parser->state = UBX_STATE_SYNC1;
+                return 0;
+            }
+            parser->state = UBX_STATE_CK_B;
+            return 0;
+
+        case UBX_STATE_CK_B:
+            parser->state = UBX_STATE_SYNC1;
+            if (byte != parser->ck_b) {
+                parser->checksum_errors++;
+                return 0;
+            }
+            if (parser->length > UBX_MAX_PAYLOAD) {
+                parser->oversize++;
+                return 0;
+            }
+            parser->frames++;
+            return 1;
+
+        default:
+            parser->state = UBX_STATE_SYNC1;
+            return 0;
+    }
+}
+
+uint8_t UBX_DecodeNavPvt(const UBX_Parser* parser, UBX_NavPvt* pvt) {
+    const uint8_t* p = parser->payload;
+
+    if (parser->msg_class != UBX_CLASS_NAV || parser->msg_id != UBX_NAV_PVT ||
+        parser->length != UBX_NAV_PVT_LEN) {
+        return 0;
+    }
+
+    // Смещения полей по описанию протокола u-blox 8 (UBX-NAV-PVT)
+    pvt->itow_ms           = ReadU4(&p[0]);
+    pvt->year              = ReadU2(&p[4]);
+    pvt->month             = p[6];
+    pvt->day               = p[7];
+    pvt->hour              = p[8];
+    pvt->minute            = p[9];
+    pvt->second            = p[10];
+    pvt->valid             = p[11];
+    pvt->nano              = (int32_t)ReadU4(&p[16]);
+    pvt->fix_type          = p[20];
+    pvt->flags             = p[21];
+    pvt->num_sv            = p[23];
+    pvt->longitude_e7      = (int32_t)ReadU4(&p[24]);
+    pvt->latitude_e7       = (int32_t)ReadU4(&p[28]);
+    pvt->height_msl_mm     = (int32_t)ReadU4(&p[36]);
+    pvt->h_acc_mm          = ReadU4(&p[40]);
+    pvt->vel_n_mmps        = (int32_t)ReadU4(&p[48]);
+    pvt->vel_e_mmps        = (int32_t)ReadU4(&p[52]);
+    pvt->vel_d_mmps        = (int32_t)ReadU4(&p[56]);
+    pvt->ground_speed_mmps = (int32_t)ReadU4(&p[60]);
+    pvt->heading_e5        = (int32_t)ReadU4(&p[64]);
+
+    return 1;
+}
+
+uint16_t UBX_BuildFrame(uint8_t* out, uint8_t msg_class, uint8_t msg_id,
+                        const uint8_t* payload, uint16_t length) {
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+
+    out[0] = UBX_SYNC1;
+    out[1] = UBX_SYNC2;
+    out[2] = msg_class;
+    out[3] = msg_id;
+    WriteU2(&out[4], length);
+    if (length > 0) {
+        memcpy(&out[6], payload, length);
+    }
+
+    for (uint16_t i = 2; i < 6 + length; i++) {
+        ck_a += out[i];
+        ck_b += ck_a;
+    }
+    out[6 + length] = ck_a;
+    out[7 + length] = ck_b;
+
+    return (uint16_t)(length + UBX_FRAME_OVERHEAD);
+}
+
+uint16_t UBX_BuildCfgPrt(uint8_t* out, uint32_t baudrate) {
+    uint8_t payload[20] = {0};
+
+    payload[0] = UBX_PORT_UART1;
+    WriteU4(&payload[4], UBX_MODE_8N1);
+    WriteU4(&payload[8], baudrate);
+    WriteU2(&payload[12], UBX_PROTO_UBX_NMEA); // inProtoMask
+    WriteU2(&payload[14], UBX_PROTO_UBX_NMEA); // outProtoMask
+
+    return UBX_BuildFrame(out, UBX_CLASS_CFG, UBX_CFG_PRT, payload, sizeof(payload));
+}
+
+uint16_t UBX_BuildCfgRate(uint8_t* out, uint16_t meas_rate_ms) {
+    uint8_t payload[6];
+
+    WriteU2(&payload[0], meas_rate_ms);
+    WriteU2(&payload[2], 1); // navRate: решение на каждое измерение
+    WriteU2(&payload[4], 1); // timeRef: время GPS
+
+    return UBX_BuildFrame(out, UBX_CLASS_CFG, UBX_CFG_RATE, payload, sizeof(payload));
+}
+
+uint16_t UBX_BuildCfgMsg(uint8_t* out, uint8_t msg_class, uint8_t msg_id, uint8_t rate) {
+    uint8_t payload[3] = {msg_class, msg_id, rate};
+
+    return UBX_BuildFrame(out, UBX_CLASS_CFG, UBX_CFG_MSG, payload, sizeof(payload));
+}
@@ -14,102 +14,637 @@
 #include "hall_sensors.h"
 #include "imu.h"
 #include "gps.h"
+#include "nmea_parser.h"
+#include "timebase.h"
+#include "nav.h"
+#include "frame.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "profile.h"
+#include "histogram.h"
+#include "lockfree.h"
+#include "buffer_pool.h"
+#include "memory_monitor.h"
 #include <string.h>
 #include <stdio.h>
 #include "usbd_desc.h"
 #include "main.h"
 
 /* USER CODE BEGIN PV */
-#define USB_CDC_BUFFER_SIZE APP_RX_DATA_SIZE
-#define USB_CDC_TX_BUFFER_SIZE 512
+#define USB_CDC_LINE_SIZE      64    // Наибольшая длина команды без '\n'
 
-static uint8_t usb_cdc_buffer[USB_CDC_BUFFER_SIZE];
-static uint16_t usb_cdc_buffer_len = 0;
-static uint8_t tx_buffer[USB_CDC_TX_BUFFER_SIZE];
+// Бюджет задержки команды от приема пакета до выхода на двигатели:
+// один такт управления (поток IMU_CONSUMER_CONTROL, 50 Гц)
+#define USB_CDC_COMMAND_BUDGET_US 20000
+
+// Пулы блоков (buffer_pool.h): пакет USB принимается прямо в блок приема,
+// кадр кодируется прямо в блок передачи, из которого его забирает USB.
+// Число блоков - степень двойки (размер очереди SpscRecordRing).
+#define USB_CDC_RX_BLOCKS      4
+#define USB_CDC_TX_BUFFER_SIZE 512   // Блок передачи, наибольший кадр после COBS
+#define USB_CDC_TX_BLOCKS      4
+
+// Отсчеты захвата IMU в одном кадре
+#define IMU_CAPTURE_BATCH      ((FRAME_MAX_PAYLOAD(USB_CDC_TX_BUFFER_SIZE) - sizeof(Frame_ImuCaptureHeader)) / sizeof(IMU_RawSample))
+#define IMU_CAPTURE_MIN_BATCH  8
+
+// Принятый пакет: блок пула приема и время прихода по Timebase_GetMicros
+typedef struct {
+    uint8_t block;
+    uint8_t length;
+    uint16_t reserved;
+    uint32_t stamp_us;
+} USB_CDC_RxPacket;
+
+// Заполненный блок передачи
+typedef struct {
+    uint8_t block;
+    uint8_t reserved;
+    uint16_t length;
+} USB_CDC_TxBlock;
+
+// Прием: блоки выделяет прерывание USB (блок под следующий пакет OUT),
+// основной цикл разбирает пакеты из очереди и возвращает блоки в пул.
+// rx_armed - блок, выставленный конечной точке OUT.
+static uint8_t rx_memory[USB_CDC_RX_BLOCKS][CDC_DATA_FS_MAX_PACKET_SIZE] __ALIGNED(4);
+static BufferPool rx_pool = {
+    &rx_memory[0][0], CDC_DATA_FS_MAX_PACKET_SIZE, USB_CDC_RX_BLOCKS, (1U << USB_CDC_RX_BLOCKS) - 1U
+};
+static USB_CDC_RxPacket rx_queue_buffer[USB_CDC_RX_BLOCKS];
+static SpscRecordRing rx_queue = { (uint8_t*)rx_queue_buffer, sizeof(USB_CDC_RxPacket), USB_CDC_RX_BLOCKS - 1, 0, 0 };
+static uint8_t rx_armed = BUFFER_POOL_NONE;
+static volatile uint32_t rx_overruns = 0;
+static AtomicFlag rx_overrun_flag;    // Пакеты потеряны с последней проверки
+
+// Сборка строки команды (только основной цикл)
+static char rx_line[USB_CDC_LINE_SIZE + 1];
+static uint8_t rx_line_len = 0;
+static uint8_t rx_line_discard = 0;   // Строка испорчена, ждем '\n'
+static uint32_t command_rx_us = 0;    // Время приема текущей команды
+
+// Задержка команд движения от приема до обновления двигателей (мкс)
+static uint32_t command_latency_last_us = 0;
+static uint32_t command_latency_max_us = 0;
+static uint32_t command_latency_late = 0; // Сверх USB_CDC_COMMAND_BUDGET_US
+// Нагрузка кадра до кодирования COBS (только основной цикл)
+static uint8_t frame_payload[FRAME_MAX_PAYLOAD(USB_CDC_TX_BUFFER_SIZE)] __ALIGNED(4);
+static uint16_t tx_sequence = 0;
+
+// Передача: основной цикл выделяет блок заполнения и дописывает в него
+// кадры, заполненный блок уходит в очередь. Прерывание USB передает блоки
+// из очереди по одному и по завершению передачи возвращает блок в пул.
+// tx_active - блок в передаче, BUFFER_POOL_NONE - конечная точка свободна.
+static uint8_t tx_memory[USB_CDC_TX_BLOCKS][USB_CDC_TX_BUFFER_SIZE] __ALIGNED(4);
+static BufferPool tx_pool = {
+    &tx_memory[0][0], USB_CDC_TX_BUFFER_SIZE, USB_CDC_TX_BLOCKS, (1U << USB_CDC_TX_BLOCKS) - 1U
+};
+static USB_CDC_TxBlock tx_queue_buffer[USB_CDC_TX_BLOCKS];
+static SpscRecordRing tx_queue = { (uint8_t*)tx_queue_buffer, sizeof(USB_CDC_TxBlock), USB_CDC_TX_BLOCKS - 1, 0, 0 };
+static volatile uint8_t tx_active = BUFFER_POOL_NONE;
+static uint8_t tx_fill = BUFFER_POOL_NONE;   // Блок заполнения (основной цикл)
+static uint16_t tx_fill_length = 0;
+static uint32_t tx_dropped = 0;
 
 // Внешнее объявление hUsbDeviceFS
 extern USBD_HandleTypeDef hUsbDeviceFS;
 /* USER CODE END PV */
 
 /* USER CODE BEGIN 0 */
-#define CDC_IN_EP  0x81U  /* EP1 for data IN */
-#define CDC_OUT_EP 0x01U  /* EP1 for data OUT */
 /* USER CODE END 0 */
 
 /* USER CODE BEGIN 1 */
 void USB_CDC_Init(void) {
     MX_USB_DEVICE_Init();
 }
+// Запуск передачи следующего блока из очереди. Вызывается из прерывания
+// USB или при запрещенном прерывании USB.
+static void USB_CDC_StartNextBlock(void) {
+    USB_CDC_TxBlock next;
+
+    if (tx_active != BUFFER_POOL_NONE || !SpscRecordRing_Read(&tx_queue, &next, 1)) {
+        return;
+    }
+
+    // Нулевой пакет после блока кратного 64 байтам отправляет класс CDC
+    // (USBD_CDC_DataIn) до вызова CDC_TransmitCplt_FS
+    USBD_CDC_SetTxBuffer(&hUsbDeviceFS, BufferPool_Data(&tx_pool, next.block), next.length);
+    if (USBD_CDC_TransmitPacket(&hUsbDeviceFS) == USBD_OK) {
+        tx_active = next.block;
+    } else {
+        // Класс CDC не готов (нет подключения): блок отбрасывается
+        BufferPool_Free(&tx_pool, next.block);
+        tx_dropped++;
+    }
+}
+
+void USB_CDC_TransmitComplete(void) {
+    if (tx_active != BUFFER_POOL_NONE) {
+        BufferPool_Free(&tx_pool, tx_active);
+        tx_active = BUFFER_POOL_NONE;
+    }
+    USB_CDC_StartNextBlock();
+}
+
+void USB_CDC_ResetTx(void) {
+    // Переподключение: блок в передаче прерван, очередь сбрасывается.
+    // Блок заполнения остается у основного цикла.
+    USB_CDC_TxBlock queued;
+
+    if (tx_active != BUFFER_POOL_NONE) {
+        BufferPool_Free(&tx_pool, tx_active);
+        tx_active = BUFFER_POOL_NONE;
+    }
+    while (SpscRecordRing_Read(&tx_queue, &queued, 1)) {
+        BufferPool_Free(&tx_pool, queued.block);
+    }
+}
+
+// Блок заполнения - в очередь передачи (только основной цикл). Место в
+// очереди есть всегда: записей в ней столько же, сколько блоков в пуле.
+static void USB_CDC_SubmitFill(void) {
+    if (tx_fill == BUFFER_POOL_NONE || tx_fill_length == 0) {
+        return;
+    }
+
+    USB_CDC_TxBlock block = { tx_fill, 0, tx_fill_length };
+    SpscRecordRing_Push(&tx_queue, &block);
+    tx_fill = BUFFER_POOL_NONE;
+    tx_fill_length = 0;
+
+    // Прерывание USB запрещено, чтобы не столкнуться с USB_CDC_TransmitComplete
+    HAL_NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+    USB_CDC_StartNextBlock();
+    HAL_NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+}
+
+// Место под size байт в блоке заполнения. Не поместившийся блок уходит в
+// очередь, под запись выделяется новый. NULL - свободных блоков нет.
+static uint8_t* USB_CDC_ReserveTx(uint16_t size) {
+    if (size == 0 || size > USB_CDC_TX_BUFFER_SIZE) {
+        return NULL;
+    }
+    if (tx_fill != BUFFER_POOL_NONE && USB_CDC_TX_BUFFER_SIZE - tx_fill_length < size) {
+        USB_CDC_SubmitFill();
+    }
+    if (tx_fill == BUFFER_POOL_NONE) {
+        tx_fill = BufferPool_Alloc(&tx_pool);
+        if (tx_fill == BUFFER_POOL_NONE) {
+            return NULL;
+        }
+    }
+    return BufferPool_Data(&tx_pool, tx_fill) + tx_fill_length;
+}
+
+// Записано length байт в блок заполнения. Конечная точка простаивает -
+// блок уходит сразу, иначе в нем копятся следующие кадры до USB_CDC_Flush.
+static void USB_CDC_CommitTx(uint16_t length) {
+    tx_fill_length += length;
+    if (tx_active == BUFFER_POOL_NONE) {
+        USB_CDC_SubmitFill();
+    }
+}
+
+void USB_CDC_Flush(void) {
+    if (tx_active == BUFFER_POOL_NONE) {
+        USB_CDC_SubmitFill();
+    }
+}
+
+uint8_t USB_CDC_QueueData(const uint8_t* data, uint16_t size) {
+    // Данные помещаются только целиком: хост не получает обрывков
+    uint8_t* out = USB_CDC_ReserveTx(size);
+    if (out == NULL) {
+        tx_dropped++;
+        return 0;
+    }
+
+    memcpy(out, data, size);
+    USB_CDC_CommitTx(size);
+    return 1;
+}
+
+uint32_t USB_CDC_GetTxFree(void) {
+    // Свободный блок вмещает наибольший кадр, иначе остаток блока заполнения
+    if (BufferPool_FreeCount(&tx_pool) > 0) {
+        return USB_CDC_TX_BUFFER_SIZE;
+    }
+    return (tx_fill != BUFFER_POOL_NONE) ? USB_CDC_TX_BUFFER_SIZE - tx_fill_length : 0;
+}
+
+uint32_t USB_CDC_GetTxDropped(void) {
+    return tx_dropped;
+}
+
+uint32_t USB_CDC_GetRxOverruns(void) {
+    return rx_overruns;
+}
+
+void USB_CDC_GetCommandLatency(uint32_t* last_us, uint32_t* max_us, uint32_t* late) {
+    *last_us = command_latency_last_us;
+    *max_us = command_latency_max_us;
+    *late = command_latency_late;
+}
 
 void USB_CDC_SendData(const uint8_t* data, uint16_t size) {
-    if (size > USB_CDC_TX_BUFFER_SIZE) {
-        size = USB_CDC_TX_BUFFER_SIZE;
+    USB_CDC_QueueData(data, size);
+}
+
+// Номер кадра растет и при отбрасывании, поэтому хост видит потери по
+// разрывам номеров. Кадр кодируется прямо в блок передачи.
+uint8_t USB_CDC_SendFrame(uint8_t type, const void* payload, uint16_t length) {
+    uint8_t sent = 0;
+
+    // Один выход: отброшенные кадры тоже попадают в профиль
+    PROFILE_BEGIN(PROFILE_FRAME_ENCODE);
+    uint16_t worst = FRAME_MAX_ENCODED(length);
+    if (worst <= USB_CDC_TX_BUFFER_SIZE) {
+        uint8_t* out = USB_CDC_ReserveTx(worst);
+        if (out == NULL) {
+            tx_sequence++;
+            tx_dropped++;
+        } else {
+            USB_CDC_CommitTx(Frame_Encode(type, tx_sequence++, payload, length, out, worst));
+            sent = 1;
+        }
     }
-    
-    memcpy(tx_buffer, data, size);
-    USBD_CDC_SetTxBuffer(&hUsbDeviceFS, tx_buffer, size);
-    USBD_CDC_TransmitPacket(&hUsbDeviceFS);
+    PROFILE_END(PROFILE_FRAME_ENCODE);
+    return sent;
 }
 
-void USB_CDC_ProcessReceivedData(void) {
-    // Проверка наличия данных в буфере
-    if (usb_cdc_buffer_len > 0) {
-        // Обработка команд
-        // Здесь можно добавить логику обработки полученных данных
-        
-        // Очистка буфера
-        usb_cdc_buffer_len = 0;
-        memset(usb_cdc_buffer, 0, USB_CDC_BUFFER_SIZE);
+void USB_CDC_SendImuCapture(void) {
+    // Отсчеты забираются из буфера только когда полный кадр поместится в
+    // блок передачи, иначе они остаются в буфере IMU и не теряются
+    if (IMU_GetCaptureCount() < IMU_CAPTURE_MIN_BATCH || USB_CDC_GetTxFree() < USB_CDC_TX_BUFFER_SIZE) {
+        return;
+    }
+
+    Frame_ImuCaptureHeader* header = (Frame_ImuCaptureHeader*)frame_payload;
+    uint16_t count = IMU_ReadCaptureSamples(
+        (IMU_RawSample*)&frame_payload[sizeof(Frame_ImuCaptureHeader)], IMU_CAPTURE_BATCH);
+
+    header->dropped = IMU_GetCaptureDropped();
+    header->count = (uint8_t)count;
+    memset(header->reserved, 0, sizeof(header->reserved));
+
+    USB_CDC_SendFrame(FRAME_TYPE_IMU_CAPTURE, frame_payload,
+                      sizeof(Frame_ImuCaptureHeader) + count * sizeof(IMU_RawSample));
+}
+
+// NMEA:ALL, NMEA:NONE или NMEA:RMC,GGA,... - подписка на предложения NMEA,
+// ответ - текстовый кадр NMEA:<маска hex>. Пустой список, неизвестный код
+// или лишний символ подписку не меняют, ответ - NMEA:ERR: отключить разбор
+// всех предложений (и вместе с ним фиксы GPS) можно только явным NONE.
+static void USB_CDC_SetNmeaSubscriptions(const char* list, uint16_t length) {
+    uint32_t mask = 0;
+    uint8_t valid = 0;
+
+    if (length == 3 && memcmp(list, "ALL", 3) == 0) {
+        mask = NMEA_SUBSCRIBE_ALL;
+        valid = 1;
+    } else if (length == 4 && memcmp(list, "NONE", 4) == 0) {
+        valid = 1;
+    } else {
+        // Коды по три буквы через запятую, код сверяется, только если он
+        // весь в аргументе
+        while (length >= 3) {
+            NMEA_SentenceType type = NMEA_SentenceFromCode(list);
+            if (type == NMEA_SENTENCE_NONE) {
+                break;
+            }
+            mask |= NMEA_SENTENCE_BIT(type);
+            list += 3;
+            length -= 3;
+            if (length == 0) {
+                valid = 1;
+                break;
+            }
+            if (*list != ',') {
+                break;
+            }
+            list++;
+            length--;
+        }
+    }
+
+    char reply[16];
+    int len;
+    if (valid) {
+        GPS_SetNmeaSubscriptions(mask);
+        len = snprintf(reply, sizeof(reply), "NMEA:%02lX",
+                       (unsigned long)GPS_GetNmeaSubscriptions());
+    } else {
+        len = snprintf(reply, sizeof(reply), "NMEA:ERR");
+    }
+    USB_CDC_SendFrame(FRAME_TYPE_TEXT, reply, len);
+}
+
+// Время от приема пакета с командой до момента вызова
+static void USB_CDC_RecordLatency(void) {
+    uint32_t latency = Timebase_GetMicros() - command_rx_us;
+
+    Histogram_Record(HISTOGRAM_COMMAND_LATENCY, latency);
+    command_latency_last_us = latency;
+    if (latency > command_latency_max_us) {
+        command_latency_max_us = latency;
+    }
+    if (latency > USB_CDC_COMMAND_BUDGET_US) {
+        command_latency_late++;
+    }
+}
+
+// MOVE:<направление>: борта двигаются как у гусеничной машины, поворот на месте
+static void USB_CDC_Move(const char* arg, uint16_t length) {
+    MotorState left = MOTOR_STOP;
+    MotorState right = MOTOR_STOP;
+
+    // Направления различаются первой буквой и длиной, строка сверяется целиком
+    switch (arg[0]) {
+        case 'F':
+            if (length != 7 || memcmp(arg, "FORWARD", 7) != 0) return;
+            left = right = MOTOR_FORWARD;
+            break;
+        case 'B':
+            if (length != 8 || memcmp(arg, "BACKWARD", 8) != 0) return;
+            left = right = MOTOR_BACKWARD;
+            break;
+        case 'R':
+            if (length == 11 && memcmp(arg, "ROTATE_LEFT", 11) == 0) {
+                left = MOTOR_BACKWARD;
+                right = MOTOR_FORWARD;
+            } else if (length == 12 && memcmp(arg, "ROTATE_RIGHT", 12) == 0) {
+                left = MOTOR_FORWARD;
+                right = MOTOR_BACKWARD;
+            } else {
+                return;
+            }
+            break;
+        case 'S':
+            if (length != 4 || memcmp(arg, "STOP", 4) != 0) return;
+            break;
+        default:
+            return;
     }
+
+    MotorControl_SetDrive(left, right);
+    USB_CDC_RecordLatency();
+}
+
+// LATENCY: ответ LATENCY:<последняя>,<максимум>,<сверх бюджета>, мкс
+static void USB_CDC_SendLatency(void) {
+    char reply[48];
+    int len = snprintf(reply, sizeof(reply), "LATENCY:%lu,%lu,%lu",
+                       (unsigned long)command_latency_last_us,
+                       (unsigned long)command_latency_max_us,
+                       (unsigned long)command_latency_late);
+    USB_CDC_SendFrame(FRAME_TYPE_TEXT, reply, len);
 }
 
-void USB_CDC_SendTelemetry(const IMU_Data* imu, const GPS_Data* gps) {
-    // Проверяем валидность указателей
-    if (!imu || !gps) {
+// SUB:<канал>:<Гц> - частота канала телеметрии (0 - отписка),
+// ответ - текстовый кадр SUB:<канал>:<установленная частота>
+static void USB_CDC_Subscribe(const char* arg, uint16_t length) {
+    const char* colon = memchr(arg, ':', length);
+    if (!colon || colon == arg || colon == arg + length - 1) {
         return;
     }
 
-    // Форматируем с фиксированной точностью для лучшей читаемости
-    int len = snprintf((char*)tx_buffer, USB_CDC_TX_BUFFER_SIZE,
-        "IMU:%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.2f,%.2f,%.2f|"
-        "GPS:%.6f,%.6f,%.2f,%.2f,%.1f,%d,%d,%02d:%02d:%02d,%02d/%02d/%04d|"
-        "HALL:%.1f,%.1f,%.1f,%.1f\n",
-        imu->accel_x, imu->accel_y, imu->accel_z,
-        imu->gyro_x, imu->gyro_y, imu->gyro_z,
-        imu->mag_x, imu->mag_y, imu->mag_z,
-        imu->temp,
-        imu->pitch, imu->roll, imu->yaw,
-        gps->latitude, gps->longitude, gps->altitude,
-        gps->speed, gps->course,
-        gps->satellites, gps->fix,
-        gps->hour, gps->minute, gps->second,
-        gps->day, gps->month, gps->year,
-        HallSensors_GetAngle(HALL_ALF),
-        HallSensors_GetAngle(HALL_ALR),
-        HallSensors_GetAngle(HALL_ARF),
-        HallSensors_GetAngle(HALL_ARR)
-    );
-    
-    if (len > 0 && len < USB_CDC_TX_BUFFER_SIZE) {
-        USB_CDC_SendData(tx_buffer, len);
+    uint16_t name_length = (uint16_t)(colon - arg);
+    Telemetry_Channel channel = Telemetry_ChannelFromName(arg, name_length);
+    if (channel == TELEMETRY_CH_COUNT) {
+        return;
+    }
+
+    // Частота выше TELEMETRY_MAX_RATE_HZ ограничивается в Telemetry_SetRate
+    uint32_t rate = 0;
+    for (const char* p = colon + 1; p < arg + length; p++) {
+        if (*p < '0' || *p > '9') {
+            return;
+        }
+        if (rate < UINT16_MAX) {
+            rate = rate * 10 + (uint32_t)(*p - '0');
+        }
     }
+
+    rate = Telemetry_SetRate(channel, (uint16_t)(rate > UINT16_MAX ? UINT16_MAX : rate));
+
+    char reply[24];
+    int len = snprintf(reply, sizeof(reply), "SUB:%.*s:%u",
+                       (int)name_length, arg, (unsigned)rate);
+    USB_CDC_SendFrame(FRAME_TYPE_TEXT, reply, len);
 }
 
-void USB_CDC_ReceiveCallback(uint8_t* Buf, uint32_t *Len) {
-    // Копируем полученные данные в буфер
-    usb_cdc_buffer_len = (*Len < USB_CDC_BUFFER_SIZE) ? *Len : USB_CDC_BUFFER_SIZE;
-    memcpy(usb_cdc_buffer, Buf, usb_cdc_buffer_len);
+_Static_assert(HISTOGRAM_BUCKETS == FRAME_HISTOGRAM_BUCKETS, "Frame_Histogram layout");
+
+// HIST: по кадру Frame_Histogram на гистограмму, HIST:RESET - сброс
+static void USB_CDC_SendHistograms(void) {
+    Frame_Histogram frame;
+    Histogram histogram;
+
+    for (uint8_t id = 0; id < HISTOGRAM_COUNT; id++) {
+        Histogram_Get((Histogram_Id)id, &histogram);
+        frame.id = id;
+        frame.bucket_count = HISTOGRAM_BUCKETS;
+        frame.reserved = 0;
+        frame.max_us = histogram.max;
+        memcpy(frame.counts, histogram.counts, sizeof(frame.counts));
+        USB_CDC_SendFrame(FRAME_TYPE_HISTOGRAM, &frame, sizeof(frame));
+    }
+}
+
+// TASKS: по текстовому кадру на задачу планировщика
+// TASK:<имя>:<запусков>,<перерасходов>,<пропусков>,<макс. задержка>,<макс. время>,<по событию>
+// (время в мкс)
+static void USB_CDC_SendTasks(void) {
+    char reply[80];
+    Scheduler_Stats stats;
+
+    for (uint8_t i = 0; Scheduler_GetStats(i, &stats); i++) {
+        int len = snprintf(reply, sizeof(reply), "TASK:%s:%lu,%lu,%lu,%lu,%lu,%lu",
+                           Scheduler_GetTaskName(i),
+                           (unsigned long)stats.runs,
+                           (unsigned long)stats.overruns,
+                           (unsigned long)stats.skipped,
+                           (unsigned long)stats.max_latency_us,
+                           (unsigned long)stats.max_exec_us,
+                           (unsigned long)stats.event_runs);
+        USB_CDC_SendFrame(FRAME_TYPE_TEXT, reply, len);
+    }
+}
+
+// MEM:<.data+.bss>,<куча>,<отказов кучи>,<пик стека>,<резерв стека>,<свободно мин.>, байт
+static void USB_CDC_SendMemory(void) {
+    char reply[80];
+    MemoryMonitor_Stats stats;
+    MemoryMonitor_GetStats(&stats);
+
+    int len = snprintf(reply, sizeof(reply), "MEM:%lu,%lu,%lu,%lu,%lu,%lu",
+                       (unsigned long)stats.static_ram,
+                       (unsigned long)stats.heap_used,
+                       (unsigned long)stats.heap_failures,
+                       (unsigned long)stats.stack_peak,
+                       (unsigned long)stats.stack_reserved,
+                       (unsigned long)stats.free_min);
+    USB_CDC_SendFrame(FRAME_TYPE_TEXT, reply, len);
+}
+
+void USB_CDC_ProcessCommand(const uint8_t* data, uint16_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    // <ключевое слово>[:<аргумент>]
+    const char* line = (const char*)data;
+    const char* colon = memchr(line, ':', size);
+    uint16_t key_length = colon ? (uint16_t)(colon - line) : size;
+    const char* arg = colon ? colon + 1 : line + size;
+    uint16_t arg_length = (uint16_t)(size - (arg - line));
+
+    // Ключевые слова различаются первой буквой: один переход по switch
+    // и сверка слова целиком
+    switch (line[0]) {
+        case 'M':
+            if (key_length == 4 && memcmp(line, "MOVE", 4) == 0 && arg_length > 0) {
+                USB_CDC_Move(arg, arg_length);
+            } else if (key_length == 3 && memcmp(line, "MEM", 3) == 0) {
+                USB_CDC_SendMemory();
+            }
+            break;
+        case 'T':
+            if (key_length == 9 && memcmp(line, "TELEMETRY", 9) == 0) {
+                Telemetry_RequestAll();
+            } else if (key_length == 5 && memcmp(line, "TASKS", 5) == 0) {
+                USB_CDC_SendTasks();
+            }
+            break;
+        case 'S':
+            if (key_length == 4 && memcmp(line, "SATS", 4) == 0) {
+                GPS_SkyView sky;
+                GPS_Data gps;
+                GPS_GetSkyView(&sky);
+                GPS_GetData(&gps);
+                USB_CDC_SendSatellites(&sky, &gps);
+            } else if (key_length == 3 && memcmp(line, "SUB", 3) == 0) {
+                USB_CDC_Subscribe(arg, arg_length);
+            }
+            break;
+        case 'C':
+            if (key_length == 7 && memcmp(line, "CAPTURE", 7) == 0) {
+                if (arg_length == 2 && memcmp(arg, "ON", 2) == 0) {
+                    IMU_SetCaptureEnabled(1);
+                } else if (arg_length == 3 && memcmp(arg, "OFF", 3) == 0) {
+                    IMU_SetCaptureEnabled(0);
+                }
+            }
+            break;
+        case 'N':
+            if (key_length == 4 && memcmp(line, "NMEA", 4) == 0) {
+                USB_CDC_SetNmeaSubscriptions(arg, arg_length);
+            }
+            break;
+        case 'H':
+            if (key_length == 4 && memcmp(line, "HIST", 4) == 0) {
+                if (arg_length == 5 && memcmp(arg, "RESET", 5) == 0) {
+                    Histogram_ResetAll();
+                } else if (arg_length == 0) {
+                    USB_CDC_SendHistograms();
+                }
+            }
+            break;
+        case 'L':
+            if (key_length == 7 && memcmp(line, "LATENCY", 7) == 0) {
+                USB_CDC_SendLatency();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void USB_CDC_ProcessReceivedData(void) {
+    USB_CDC_RxPacket packet;
+
+    // Пакет строки потерян при переполнении: строка не выполняется
+    if (AtomicFlag_Take(&rx_overrun_flag)) {
+        rx_line_discard = 1;
+    }
+
+    // Разбор прямо в блоке, куда пакет принят; блок возвращается в пул
+    while (SpscRecordRing_Read(&rx_queue, &packet, 1)) {
+        const uint8_t* data = BufferPool_Data(&rx_pool, packet.block);
+        command_rx_us = packet.stamp_us;
+
+        for (uint32_t i = 0; i < packet.length; i++) {
+            uint8_t byte = data[i];
+
+            if (byte == '\n') {
+                if (!rx_line_discard) {
+                    rx_line[rx_line_len] = '\0';
+                    USB_CDC_ProcessCommand((const uint8_t*)rx_line, rx_line_len);
+                }
+                rx_line_len = 0;
+                rx_line_discard = 0;
+            } else if (byte == '\r') {
+                continue;
+            } else if (rx_line_len < USB_CDC_LINE_SIZE) {
+                rx_line[rx_line_len++] = (char)byte;
+            } else {
+                rx_line_discard = 1;
+            }
+        }
+        BufferPool_Free(&rx_pool, packet.block);
+    }
+}
+
+void USB_CDC_SendSatellites(const GPS_SkyView* sky, const GPS_Data* gps) {
+    if (!sky || !gps) {
+        return;
+    }
+
+    Frame_SatellitesHeader* header = (Frame_SatellitesHeader*)frame_payload;
+    Frame_Satellite* entries = (Frame_Satellite*)&frame_payload[sizeof(Frame_SatellitesHeader)];
+    const uint8_t capacity = (sizeof(frame_payload) - sizeof(Frame_SatellitesHeader)) / sizeof(Frame_Satellite);
+
+    header->count = sky->count;
+    header->reserved = 0;
+    header->pdop = Frame_ToFixedU16(gps->pdop, FRAME_DOP_SCALE);
+    header->hdop = Frame_ToFixedU16(gps->hdop, FRAME_DOP_SCALE);
+    header->vdop = Frame_ToFixedU16(gps->vdop, FRAME_DOP_SCALE);
+
+    // Спутники, не поместившиеся в кадр, отбрасываются (count остается полным)
+    uint8_t n = (sky->count < capacity) ? sky->count : capacity;
+    for (uint8_t i = 0; i < n; i++) {
+        entries[i].constellation = sky->sats[i].constellation;
+        entries[i].prn = sky->sats[i].prn;
+        entries[i].elevation = sky->sats[i].elevation;
+        entries[i].snr = sky->sats[i].snr;
+        entries[i].azimuth = sky->sats[i].azimuth;
+    }
+
+    USB_CDC_SendFrame(FRAME_TYPE_SATELLITES, frame_payload,
+                      sizeof(Frame_SatellitesHeader) + n * sizeof(Frame_Satellite));
 }
 
-void HAL_PCD_DataOutStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum) {
-    if (epnum == CDC_OUT_EP) {
-        USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+uint8_t* USB_CDC_ArmRx(void) {
+    if (rx_armed == BUFFER_POOL_NONE) {
+        rx_armed = BufferPool_Alloc(&rx_pool);
     }
+    return (rx_armed != BUFFER_POOL_NONE) ? BufferPool_Data(&rx_pool, rx_armed) : NULL;
 }
 
-void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum) {
-    if (epnum == CDC_IN_EP) {
-        USBD_CDC_TransmitPacket(&hUsbDeviceFS);
+uint8_t* USB_CDC_ReceiveCallback(uint8_t* Buf, uint32_t *Len) {
+    // Прерывание USB: блок с пакетом уходит основному циклу вместе со временем
+    // прихода. Место в очереди есть всегда: записей столько же, сколько блоков.
+    if (*Len > 0) {
+        if (rx_armed != BUFFER_POOL_NONE && Buf == BufferPool_Data(&rx_pool, rx_armed)) {
+            USB_CDC_RxPacket packet = { rx_armed, (uint8_t)*Len, 0, Timebase_GetMicros() };
+            SpscRecordRing_Push(&rx_queue, &packet);
+            rx_armed = BUFFER_POOL_NONE;
+            Scheduler_PostEvent(SCHEDULER_EVENT_USB_RX);
+        } else {
+            // Блоков не было, пакет принят в буфер сброса
+            rx_overruns++;
+            AtomicFlag_Set(&rx_overrun_flag);
+        }
     }
+    return USB_CDC_ArmRx();
 }
 /* USER CODE END 1 */
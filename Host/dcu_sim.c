@@ -0,0 +1,573 @@
+// Симуляция платы на хосте: прошивка (main.c без изменений) поверх имитации
+// HAL из Host/hal. Сценарий подключает модели датчиков и хост USB:
+//   - MPU-6050 на I2C1 (0x68): покой, +1 g по Z, 25 °C, небольшой шум;
+//   - приемник GPS только с NMEA (RMC + GGA раз в секунду на 9600 после
+//     PPS): настройку UBX он не понимает, прошивка откатывается на NMEA
+//     через GPS_UBX_TIMEOUT_MS;
+//   - датчики Холла на ADC1 (каналы 4-7) в среднем положении;
+//   - три сдвиговых регистра 74HC595 на выводах motor_control.c;
+//   - хост USB: команды по расписанию, разбор кадров (COBS, CRC16).
+//
+//   ./dcu_sim [секунды] [КОМАНДА@мс ...]
+//   ./dcu_sim 60 MOVE:BACKWARD@50000 MOVE:STOP@52000
+//
+// По завершении - отчет: кадры по типам, потери, записи GPIO, статистика
+// планировщика (время симуляции) и профиль участков (нс хоста). Код
+// возврата 1 (проверка ctest): ошибки кадров, CRC или номеров, команды без
+// ответа, потери GPS сверх окна отката с UBX на NMEA.
+
+#include "host_hal.h"
+#include "frame.h"
+#include "gps.h"
+#include "profile.h"
+#include "scheduler.h"
+#include "usb_cdc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_DEFAULT_SECONDS 60U
+#define SIM_MAX_COMMANDS    32
+#define SIM_FRAME_MAX       1024
+
+int DcuFirmware_Main(void);
+
+// ---------------------------------------------------------------------------
+// MPU-6050
+
+#define MPU_WHO_AM_I     0x75
+#define MPU_SMPLRT_DIV   0x19
+#define MPU_CONFIG       0x1A
+#define MPU_ACCEL_CONFIG 0x1C
+#define MPU_INT_STATUS   0x3A
+#define MPU_ACCEL_XOUT_H 0x3B
+#define MPU_PWR_MGMT_1   0x6B
+
+static uint8_t mpu_regs[128];
+static uint64_t mpu_next_sample_us = 0;
+static uint32_t mpu_noise = 12345;
+static uint32_t mpu_samples = 0;
+
+static int16_t Mpu_Noise(void) {
+    // Детерминированный шум ±8 LSB (LCG), прогоны повторяются
+    mpu_noise = mpu_noise * 1103515245U + 12345U;
+    return (int16_t)((int32_t)((mpu_noise >> 16) & 0x0F) - 8);
+}
+
+static void Mpu_Put16(uint8_t reg, int32_t value) {
+    mpu_regs[reg] = (uint8_t)((uint16_t)value >> 8);
+    mpu_regs[reg + 1] = (uint8_t)value;
+}
+
+// Новый отсчет с частотой, заданной SMPLRT_DIV и DLPF (CONFIG)
+static void Mpu_Update(uint64_t now_us) {
+    if (mpu_regs[MPU_PWR_MGMT_1] & 0x40) {
+        return;     // SLEEP
+    }
+
+    uint32_t base_hz = ((mpu_regs[MPU_CONFIG] & 0x07) == 0) ? 8000U : 1000U;
+    uint64_t period_us = 1000000U * (1U + mpu_regs[MPU_SMPLRT_DIV]) / base_hz;
+    if (now_us < mpu_next_sample_us) {
+        return;
+    }
+    mpu_next_sample_us = now_us + period_us;
+
+    int32_t lsb_per_g = 16384 >> ((mpu_regs[MPU_ACCEL_CONFIG] >> 3) & 0x03);
+    Mpu_Put16(MPU_ACCEL_XOUT_H + 0, Mpu_Noise());
+    Mpu_Put16(MPU_ACCEL_XOUT_H + 2, Mpu_Noise());
+    Mpu_Put16(MPU_ACCEL_XOUT_H + 4, lsb_per_g + Mpu_Noise());
+    Mpu_Put16(MPU_ACCEL_XOUT_H + 6, (int32_t)((25.0f - 36.53f) * 340.0f));
+    Mpu_Put16(MPU_ACCEL_XOUT_H + 8, Mpu_Noise());
+    Mpu_Put16(MPU_ACCEL_XOUT_H + 10, Mpu_Noise());
+    Mpu_Put16(MPU_ACCEL_XOUT_H + 12, Mpu_Noise());
+    mpu_regs[MPU_INT_STATUS] |= 0x01;   // DATA_RDY
+    mpu_samples++;
+}
+
+static void Mpu_Read(uint8_t reg, uint8_t* data, uint16_t size) {
+    for (uint16_t i = 0; i < size; i++) {
+        data[i] = mpu_regs[(reg + i) & 0x7F];
+    }
+    // DATA_RDY сбрасывается чтением INT_STATUS
+    if (reg <= MPU_INT_STATUS && reg + size > MPU_INT_STATUS) {
+        mpu_regs[MPU_INT_STATUS] &= (uint8_t)~0x01;
+    }
+}
+
+static void Mpu_Write(uint8_t reg, const uint8_t* data, uint16_t size) {
+    for (uint16_t i = 0; i < size; i++) {
+        uint8_t r = (reg + i) & 0x7F;
+        if (r == MPU_PWR_MGMT_1 && (data[i] & 0x80)) {
+            // DEVICE_RESET: регистры по умолчанию, сон
+            memset(mpu_regs, 0, sizeof(mpu_regs));
+            mpu_regs[MPU_WHO_AM_I] = 0x68;
+            mpu_regs[MPU_PWR_MGMT_1] = 0x40;
+            continue;
+        }
+        if (r != MPU_WHO_AM_I) {
+            mpu_regs[r] = data[i];
+        }
+    }
+}
+
+static const HostHal_I2cDevice mpu_device = { 0x68, Mpu_Read, Mpu_Write };
+
+// ---------------------------------------------------------------------------
+// Приемник GPS (NMEA)
+
+#define GPS_NMEA_BAUD     9600U
+#define GPS_NMEA_DELAY_US 50000U    // Выдача решения после PPS
+
+static uint32_t gps_sentences = 0;
+static uint32_t gps_feed_failures = 0;
+static uint32_t gps_fed_bytes = 0;
+static uint32_t gps_outputs = 0;
+static uint32_t gps_ubx_bytes = 0;
+
+static void Gps_Sentence(const char* body) {
+    char line[128];
+    uint8_t checksum = 0;
+
+    for (const char* p = body; *p; p++) {
+        checksum ^= (uint8_t)*p;
+    }
+    int len = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, checksum);
+    if (HostHal_UartFeed((const uint8_t*)line, (uint16_t)len, GPS_NMEA_BAUD)) {
+        gps_sentences++;
+        gps_fed_bytes += (uint32_t)len;
+    } else {
+        gps_feed_failures++;
+    }
+}
+
+// Решение за секунду second от начала: стоянка, фикс 3D, 9 спутников
+static void Gps_Output(uint32_t second) {
+    char body[100];
+    uint32_t t = 12U * 3600U + second;
+    unsigned hh = (t / 3600U) % 24U, mm = (t / 60U) % 60U, ss = t % 60U;
+
+    gps_outputs++;
+
+    snprintf(body, sizeof(body),
+             "GPRMC,%02u%02u%02u.00,A,5545.3482,N,03737.0394,E,0.02,87.40,191026,,,A",
+             hh, mm, ss);
+    Gps_Sentence(body);
+    snprintf(body, sizeof(body),
+             "GPGGA,%02u%02u%02u.00,5545.3482,N,03737.0394,E,1,09,0.92,152.4,M,14.4,M,,",
+             hh, mm, ss);
+    Gps_Sentence(body);
+}
+
+// Настройка UBX от прошивки: приемник ее не понимает, байты только считаются
+static void Gps_UartTx(const uint8_t* data, uint16_t length) {
+    gps_ubx_bytes += length;
+}
+
+// ---------------------------------------------------------------------------
+// Сдвиговые регистры 74HC595 (motor_control.c)
+
+typedef struct {
+    const char* name;
+    GPIO_TypeDef* data_port;
+    uint16_t data_pin;
+    GPIO_TypeDef* clock_port;
+    uint16_t clock_pin;
+    GPIO_TypeDef* latch_port;
+    uint16_t latch_pin;
+    uint8_t data;
+    uint8_t shift;
+    uint8_t output;
+    uint32_t latches;
+} Sim_ShiftRegister;
+
+// Биты в порядке прошивки: первый выдвинутый бит - младший
+static Sim_ShiftRegister shift_registers[] = {
+    { "U2", GPIOB, GPIO_PIN_12, GPIOB, GPIO_PIN_14, GPIOB, GPIO_PIN_13, 0, 0, 0, 0 },
+    { "U3", GPIOB, GPIO_PIN_15, GPIOA, GPIO_PIN_9,  GPIOB, GPIO_PIN_11, 0, 0, 0, 0 },
+    { "U4", GPIOA, GPIO_PIN_10, GPIOB, GPIO_PIN_5,  GPIOB, GPIO_PIN_4,  0, 0, 0, 0 },
+};
+#define SIM_SHIFT_REGISTERS (sizeof(shift_registers) / sizeof(shift_registers[0]))
+
+static void Sim_Gpio(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+    for (uint32_t i = 0; i < SIM_SHIFT_REGISTERS; i++) {
+        Sim_ShiftRegister* sr = &shift_registers[i];
+
+        if (port == sr->data_port && pin == sr->data_pin) {
+            sr->data = (state == GPIO_PIN_SET);
+        } else if (port == sr->clock_port && pin == sr->clock_pin && state == GPIO_PIN_SET) {
+            sr->shift = (uint8_t)((sr->shift >> 1) | (sr->data << 7));
+        } else if (port == sr->latch_port && pin == sr->latch_pin && state == GPIO_PIN_SET) {
+            sr->latches++;
+            if (sr->output != sr->shift) {
+                sr->output = sr->shift;
+                printf("[%9.3f] %s = 0x%02X\n", HostHal_GetMicros() / 1e6, sr->name, sr->output);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Хост USB: команды и разбор кадров
+
+// Ответ, которым прошивка подтверждает команду: кадр типа frame_type,
+// текстовый - с началом reply. Команда с ':' на конце сравнивается по
+// началу, иначе целиком (HIST:RESET ответа не дает). Команды без ответа
+// (MOVE, CAPTURE) подтверждаются доставкой.
+typedef struct {
+    const char* command;
+    uint8_t frame_type;
+    const char* reply;
+} Sim_Reply;
+
+static const Sim_Reply sim_replies[] = {
+    { "SUB:",    FRAME_TYPE_TEXT,       "SUB:" },
+    { "NMEA:",   FRAME_TYPE_TEXT,       "NMEA:" },
+    { "TASKS",   FRAME_TYPE_TEXT,       "TASK:" },
+    { "MEM",     FRAME_TYPE_TEXT,       "MEM:" },
+    { "LATENCY", FRAME_TYPE_TEXT,       "LATENCY:" },
+    { "HIST",    FRAME_TYPE_HISTOGRAM,  NULL },
+    { "SATS",    FRAME_TYPE_SATELLITES, NULL },
+};
+#define SIM_REPLIES (sizeof(sim_replies) / sizeof(sim_replies[0]))
+
+typedef struct {
+    uint32_t at_ms;
+    char text[48];
+    const Sim_Reply* reply;
+    uint8_t acked;
+} Sim_Command;
+
+// Сценарий по умолчанию. Калибровка в main.c (датчики Холла 4 x 6 с, IMU
+// около 2 с) идет до запуска планировщика, команды - после нее.
+static const struct {
+    uint32_t at_ms;
+    const char* text;
+} default_commands[] = {
+    { 30000, "SUB:DIAG:1" },
+    { 30000, "SUB:IMU:50" },
+    { 30000, "SUB:GPS:1" },
+    { 32000, "NMEA:RMC" },
+    { 35000, "TASKS" },
+    { 35000, "MEM" },
+    { 40000, "MOVE:FORWARD" },
+    { 42000, "MOVE:STOP" },
+    { 45000, "LATENCY" },
+    { 45000, "HIST" },
+};
+
+static Sim_Command commands[SIM_MAX_COMMANDS];
+static uint32_t command_count = 0;
+static uint32_t commands_sent = 0;
+
+static uint8_t usb_frame[SIM_FRAME_MAX];
+static uint32_t usb_frame_length = 0;
+static uint8_t usb_frame_overflow = 0;
+static uint64_t usb_bytes = 0;
+static uint32_t usb_transfers = 0;
+static uint32_t frames_by_type[256];
+static uint32_t frame_errors = 0;
+static uint32_t sequence_gaps = 0;
+static uint8_t sequence_valid = 0;
+static uint16_t sequence_next = 0;
+
+// COBS: data - байты кадра без завершающего нуля. Возвращает длину или 0.
+static uint32_t Sim_CobsDecode(const uint8_t* data, uint32_t length, uint8_t* out) {
+    uint32_t pos = 0;
+    uint32_t n = 0;
+
+    while (pos < length) {
+        uint8_t code = data[pos++];
+        if (code == 0 || pos + code - 1U > length) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            out[n++] = data[pos++];
+        }
+        if (code != 0xFF && pos < length) {
+            out[n++] = 0;
+        }
+    }
+    return n;
+}
+
+static void Sim_Frame(const uint8_t* data, uint32_t length) {
+    uint8_t decoded[SIM_FRAME_MAX];
+    uint32_t n = Sim_CobsDecode(data, length, decoded);
+
+    if (n < FRAME_HEADER_SIZE + FRAME_CRC_SIZE || decoded[0] != FRAME_VERSION) {
+        frame_errors++;
+        return;
+    }
+    uint16_t crc = (uint16_t)(decoded[n - 2] | (decoded[n - 1] << 8));
+    if (Frame_Crc16(0xFFFF, decoded, (uint16_t)(n - FRAME_CRC_SIZE)) != crc) {
+        frame_errors++;
+        return;
+    }
+
+    uint8_t type = decoded[1];
+    const char* text = (const char*)&decoded[FRAME_HEADER_SIZE];
+    uint32_t text_length = n - FRAME_HEADER_SIZE - FRAME_CRC_SIZE;
+    uint16_t sequence = (uint16_t)(decoded[2] | (decoded[3] << 8));
+    if (sequence_valid && sequence != sequence_next) {
+        sequence_gaps += (uint16_t)(sequence - sequence_next);
+    }
+    sequence_valid = 1;
+    sequence_next = (uint16_t)(sequence + 1);
+    frames_by_type[type]++;
+
+    if (type == FRAME_TYPE_TEXT) {
+        printf("[%9.3f] USB: %.*s\n", HostHal_GetMicros() / 1e6, (int)text_length, text);
+    }
+
+    // Ответ подтверждает самую раннюю отправленную команду, которая его ждет
+    for (uint32_t i = 0; i < commands_sent; i++) {
+        const Sim_Reply* reply = commands[i].reply;
+        if (commands[i].acked || reply == NULL || reply->frame_type != type) {
+            continue;
+        }
+        if (reply->reply == NULL ||
+            (text_length >= strlen(reply->reply) &&
+             memcmp(text, reply->reply, strlen(reply->reply)) == 0)) {
+            commands[i].acked = 1;
+            break;
+        }
+    }
+}
+
+static void Sim_UsbIn(const uint8_t* data, uint32_t length) {
+    usb_bytes += length;
+    usb_transfers++;
+
+    for (uint32_t i = 0; i < length; i++) {
+        if (data[i] == FRAME_DELIMITER) {
+            if (usb_frame_overflow) {
+                frame_errors++;
+            } else if (usb_frame_length > 0) {
+                Sim_Frame(usb_frame, usb_frame_length);
+            }
+            usb_frame_length = 0;
+            usb_frame_overflow = 0;
+        } else if (usb_frame_length < SIM_FRAME_MAX) {
+            usb_frame[usb_frame_length++] = data[i];
+        } else {
+            usb_frame_overflow = 1;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Сценарий и отчет
+
+static uint64_t sim_end_us;
+static uint64_t wall_start_ns;
+
+static uint64_t Sim_WallNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void Sim_Tick(uint64_t now_us) {
+    Mpu_Update(now_us);
+
+    if (now_us % 1000000U == GPS_NMEA_DELAY_US) {
+        Gps_Output((uint32_t)(now_us / 1000000U));
+    }
+
+    while (commands_sent < command_count && commands[commands_sent].at_ms * 1000ULL <= now_us) {
+        char line[sizeof(commands[0].text) + 1];
+        int len = snprintf(line, sizeof(line), "%s\n", commands[commands_sent].text);
+        if (!HostHal_UsbSend((const uint8_t*)line, (uint16_t)len)) {
+            break;  // Очередь OUT полна: повтор в следующем такте
+        }
+        commands[commands_sent].acked = (commands[commands_sent].reply == NULL);
+        commands_sent++;
+    }
+}
+
+static const char* const profile_names[PROFILE_TASK_FIRST] = {
+    "ISR USART2", "ISR DMA1_CH6", "ISR I2C1", "ISR ADC", "ISR USB", "ISR TIM2", "ISR TIM3",
+    "IMU read", "NMEA decode", "Motor update", "Frame encode"
+};
+
+static void Sim_PrintProfile(const char* name, Profile_Id id) {
+    Profile_Stats stats;
+
+    Profile_GetStats(id, &stats);
+    if (stats.calls == 0) {
+        return;
+    }
+    printf("  %-14s %8lu %10lu %10lu %10lu\n", name, (unsigned long)stats.calls,
+           (unsigned long)stats.min, (unsigned long)(stats.total / stats.calls),
+           (unsigned long)stats.max);
+}
+
+static void Sim_Report(void) {
+    double wall_s = (Sim_WallNs() - wall_start_ns) / 1e9;
+    HostHal_UartStats uart;
+    HostHal_GetUartStats(&uart);
+
+    printf("\n=== %.1f с симуляции за %.3f с (x%.0f)\n", sim_end_us / 1e6, wall_s,
+           wall_s > 0 ? sim_end_us / 1e6 / wall_s : 0.0);
+
+    printf("USB IN: %llu байт, %lu передач, ошибок кадров %lu, пропусков номеров %lu\n",
+           (unsigned long long)usb_bytes, (unsigned long)usb_transfers,
+           (unsigned long)frame_errors, (unsigned long)sequence_gaps);
+    printf("  кадры по типам:");
+    for (uint32_t t = 0; t < 256; t++) {
+        if (frames_by_type[t]) {
+            printf(" %lu:%lu", (unsigned long)t, (unsigned long)frames_by_type[t]);
+        }
+    }
+    printf("\n  прошивка: отброшено TX %lu, переполнений RX %lu, команд отправлено %lu/%lu\n",
+           (unsigned long)USB_CDC_GetTxDropped(), (unsigned long)USB_CDC_GetRxOverruns(),
+           (unsigned long)commands_sent, (unsigned long)command_count);
+
+    printf("GPS: предложений %lu (не встало в линию %lu), UART принято %lu, потеряно %lu, "
+           "UBX от прошивки %lu байт\n",
+           (unsigned long)gps_sentences, (unsigned long)gps_feed_failures,
+           (unsigned long)uart.rx_bytes, (unsigned long)uart.rx_lost,
+           (unsigned long)gps_ubx_bytes);
+    printf("IMU: отсчетов %lu\n", (unsigned long)mpu_samples);
+    printf("GPIO: записей %lu", (unsigned long)HostHal_GetGpioWrites());
+    for (uint32_t i = 0; i < SIM_SHIFT_REGISTERS; i++) {
+        printf(", %s 0x%02X (%lu защелок)", shift_registers[i].name, shift_registers[i].output,
+               (unsigned long)shift_registers[i].latches);
+    }
+    printf("\n");
+
+    printf("Задачи (время симуляции, мкс):\n");
+    printf("  %-14s %8s %8s %8s %8s %8s\n", "", "runs", "events", "overrun", "max_lat", "max_exec");
+    for (uint8_t i = 0; i < Scheduler_GetTaskCount(); i++) {
+        Scheduler_Stats stats;
+        Scheduler_GetStats(i, &stats);
+        printf("  %-14s %8lu %8lu %8lu %8lu %8lu\n", Scheduler_GetTaskName(i),
+               (unsigned long)stats.runs, (unsigned long)stats.event_runs,
+               (unsigned long)stats.overruns, (unsigned long)stats.max_latency_us,
+               (unsigned long)stats.max_exec_us);
+    }
+    printf("  простой %u‰\n", Scheduler_GetIdlePermille());
+
+    printf("Профиль (нс хоста):\n");
+    printf("  %-14s %8s %10s %10s %10s\n", "", "calls", "min", "avg", "max");
+    for (uint32_t id = 0; id < PROFILE_TASK_FIRST; id++) {
+        Sim_PrintProfile(profile_names[id], (Profile_Id)id);
+    }
+    for (uint8_t i = 0; i < Scheduler_GetTaskCount(); i++) {
+        Sim_PrintProfile(Scheduler_GetTaskName(i), (Profile_Id)(PROFILE_TASK_FIRST + i));
+    }
+    fflush(stdout);
+}
+
+// Проверки по итогам прогона, число нарушений. Потери GPS допустимы только
+// в окне отката на NMEA: GPS_UBX_TIMEOUT_MS после настройки плюс секунда
+// на выдачу, пришедшую во время переключения скорости.
+static uint32_t Sim_Check(void) {
+    uint32_t failures = 0;
+    HostHal_UartStats uart;
+    HostHal_GetUartStats(&uart);
+
+    if (frame_errors > 0 || sequence_gaps > 0) {
+        fprintf(stderr, "FAIL: ошибок кадров %lu, пропусков номеров %lu\n",
+                (unsigned long)frame_errors, (unsigned long)sequence_gaps);
+        failures++;
+    }
+    for (uint32_t i = 0; i < command_count; i++) {
+        if (!commands[i].acked) {
+            fprintf(stderr, "FAIL: команда %s@%lu %s\n", commands[i].text,
+                    (unsigned long)commands[i].at_ms, (i < commands_sent) ? "без ответа" : "не отправлена");
+            failures++;
+        }
+    }
+
+    uint32_t per_output = gps_outputs ? gps_fed_bytes / gps_outputs : 0;
+    uint32_t lost_limit = (GPS_UBX_TIMEOUT_MS / 1000U + 1U) * per_output;
+    if (uart.rx_lost > lost_limit || gps_feed_failures > 0) {
+        fprintf(stderr, "FAIL: GPS потеряно %lu байт (допустимо %lu), не встало в линию %lu\n",
+                (unsigned long)uart.rx_lost, (unsigned long)lost_limit,
+                (unsigned long)gps_feed_failures);
+        failures++;
+    }
+    return failures;
+}
+
+// Конец симуляции: HostHal завершает процесс с кодом 0 после отчета
+static void Sim_End(void) {
+    Sim_Report();
+    if (Sim_Check() > 0) {
+        exit(1);
+    }
+}
+
+static void Sim_AddCommand(const char* text, uint32_t at_ms) {
+    if (command_count >= SIM_MAX_COMMANDS) {
+        fprintf(stderr, "dcu_sim: больше %d команд\n", SIM_MAX_COMMANDS);
+        exit(2);
+    }
+    Sim_Command* command = &commands[command_count++];
+    command->at_ms = at_ms;
+    snprintf(command->text, sizeof(command->text), "%s", text);
+    command->reply = NULL;
+    command->acked = 0;
+    for (uint32_t i = 0; i < SIM_REPLIES; i++) {
+        const char* pattern = sim_replies[i].command;
+        size_t length = strlen(pattern);
+        if ((pattern[length - 1] == ':') ? strncmp(text, pattern, length) == 0
+                                         : strcmp(text, pattern) == 0) {
+            command->reply = &sim_replies[i];
+            break;
+        }
+    }
+}
+
+static int Sim_CompareCommands(const void* a, const void* b) {
+    const Sim_Command* x = a;
+    const Sim_Command* y = b;
+    return (x->at_ms > y->at_ms) - (x->at_ms < y->at_ms);
+}
+
+int main(int argc, char** argv) {
+    uint32_t seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : SIM_DEFAULT_SECONDS;
+    if (seconds == 0) {
+        fprintf(stderr, "usage: %s [seconds] [COMMAND@ms ...]\n", argv[0]);
+        return 2;
+    }
+
+    for (uint32_t i = 0; i < sizeof(default_commands) / sizeof(default_commands[0]); i++) {
+        Sim_AddCommand(default_commands[i].text, default_commands[i].at_ms);
+    }
+    for (int i = 2; i < argc; i++) {
+        char text[sizeof(commands[0].text)];
+        char* at = strrchr(argv[i], '@');
+        if (at == NULL || at == argv[i]) {
+            fprintf(stderr, "dcu_sim: ожидается КОМАНДА@мс: %s\n", argv[i]);
+            return 2;
+        }
+        snprintf(text, sizeof(text), "%.*s", (int)(at - argv[i]), argv[i]);
+        Sim_AddCommand(text, (uint32_t)strtoul(at + 1, NULL, 10));
+    }
+    // Порядок команд с одним временем не важен: qsort без устойчивости
+    qsort(commands, command_count, sizeof(commands[0]), Sim_CompareCommands);
+
+    mpu_regs[MPU_WHO_AM_I] = 0x68;
+    mpu_regs[MPU_PWR_MGMT_1] = 0x40;
+    HostHal_AttachI2c(&mpu_device);
+    for (uint32_t channel = ADC_CHANNEL_4; channel <= ADC_CHANNEL_7; channel++) {
+        HostHal_SetAdc(channel, 2048);
+    }
+    HostHal_SetUartTxHook(Gps_UartTx);
+    HostHal_SetPps(1);
+    HostHal_SetGpioHook(Sim_Gpio);
+    HostHal_SetUsbHook(Sim_UsbIn);
+    HostHal_SetTickHook(Sim_Tick);
+
+    sim_end_us = (uint64_t)seconds * 1000000U;
+    HostHal_SetEndTime(sim_end_us, Sim_End);
+    wall_start_ns = Sim_WallNs();
+
+    // Возврата нет: симуляция завершается в HostHal по времени конца
+    DcuFirmware_Main();
+    return 1;
+}
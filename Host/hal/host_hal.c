@@ -0,0 +1,995 @@
+#include "host_hal.h"
+#include "stm32f1xx_it.h"
+#include "usbd_cdc.h"
+#include "usbd_desc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_HAL_SYSTICK_US      1000U
+#define HOST_HAL_I2C_HZ          400000U
+#define HOST_HAL_UART_QUEUE_SIZE 4096   // Степень двойки
+#define HOST_HAL_UART_EVENTS     8      // Степень двойки
+#define HOST_HAL_USB_QUEUE_SIZE  1024   // Степень двойки
+#define HOST_HAL_USB_PACKET_US   50U    // Пакет bulk full-speed с накладными расходами
+#define HOST_HAL_SYSTICK_IRQ     63U    // Бит SysTick в масках прерываний
+#define HOST_HAL_NEVER           UINT64_MAX
+
+// Регистры периферии (stm32f1xx_hal.h в Host/hal)
+RCC_TypeDef HostHal_RCC;
+GPIO_TypeDef HostHal_GPIOA, HostHal_GPIOB, HostHal_GPIOC;
+AFIO_TypeDef HostHal_AFIO;
+TIM_TypeDef HostHal_TIM1, HostHal_TIM2, HostHal_TIM3, HostHal_TIM4;
+ADC_TypeDef HostHal_ADC1;
+I2C_TypeDef HostHal_I2C1;
+USART_TypeDef HostHal_USART1, HostHal_USART2, HostHal_USART3;
+DMA_TypeDef HostHal_DMA1;
+DMA_Channel_TypeDef HostHal_DMA1_Channel[7];
+DWT_Type HostHal_DWT;
+CoreDebug_Type HostHal_CoreDebug;
+
+// Переменные system_stm32f1xx.c и stm32f1xx_hal.c
+uint32_t SystemCoreClock = HSI_VALUE;
+__IO uint32_t uwTick;
+uint32_t uwTickPrio = (1UL << __NVIC_PRIO_BITS);
+HAL_TickFreqTypeDef uwTickFreq = HAL_TICK_FREQ_DEFAULT;
+
+// Обработчики usb_device.c / usbd_conf.c
+PCD_HandleTypeDef hpcd_USB_FS;
+USBD_ClassTypeDef USBD_CDC;
+USBD_DescriptorsTypeDef FS_Desc;
+
+// Время и прерывания
+static uint64_t now_us = 0;
+static uint64_t end_us = HOST_HAL_NEVER;
+static void (*end_hook)(void) = NULL;
+static void (*tick_hook)(uint64_t now_us) = NULL;
+static uint8_t systick_running = 0;
+static uint64_t next_systick_us = HOST_HAL_NEVER;
+
+static uint32_t primask = 0;
+static uint8_t in_isr = 0;
+static uint64_t irq_enabled = 1ULL << HOST_HAL_SYSTICK_IRQ;
+static uint64_t irq_pending = 0;
+
+// Таймеры TIM2/TIM3: счетчик и флаги SR считаются от времени симуляции.
+// sr - флаги, выставленные "аппаратурой": SR сбрасывается записью нуля
+// (rc_w0), а в памяти хоста запись ~флага выставила бы остальные биты.
+typedef struct {
+    TIM_TypeDef* instance;
+    IRQn_Type irq;
+    uint8_t running;
+    uint32_t count_hz;
+    uint64_t start_us;
+    uint64_t period_us;
+    uint64_t next_update_us;
+    uint32_t sr;
+} HostHal_Timer;
+
+static HostHal_Timer timers[] = {
+    { &HostHal_TIM2, TIM2_IRQn, 0, 0, 0, 0, HOST_HAL_NEVER, 0 },
+    { &HostHal_TIM3, TIM3_IRQn, 0, 0, 0, 0, HOST_HAL_NEVER, 0 },
+};
+#define HOST_HAL_TIMERS (sizeof(timers) / sizeof(timers[0]))
+
+static uint8_t pps_enabled = 0;
+static uint64_t next_pps_us = HOST_HAL_NEVER;
+
+// GPIO
+static HostHal_GpioHook gpio_hook = NULL;
+static uint32_t gpio_writes = 0;
+
+// ADC1: каналы регулярной группы по рангам и значения каналов
+static uint16_t adc_values[18];
+static uint32_t adc_ranks[16];
+static uint8_t adc_rank_count = 0;
+static uint8_t adc_poll_index = 0;
+
+// I2C1
+#define HOST_HAL_I2C_DEVICES 4
+static const HostHal_I2cDevice* i2c_devices[HOST_HAL_I2C_DEVICES];
+
+// USART2: очередь линии, прием DMA (circular) и события приема
+static uint8_t uart_queue[HOST_HAL_UART_QUEUE_SIZE];
+static uint32_t uart_head = 0;
+static uint32_t uart_tail = 0;
+static uint32_t uart_line_baud = 9600;
+static uint64_t uart_burst_start_us = 0;
+static uint32_t uart_burst_index = 0;
+static uint64_t uart_next_byte_us = HOST_HAL_NEVER;
+static uint64_t uart_idle_us = HOST_HAL_NEVER;
+static UART_HandleTypeDef* uart_rx_handle = NULL;
+static uint8_t* uart_dma_buffer = NULL;
+static uint16_t uart_dma_size = 0;
+static uint16_t uart_dma_pos = 0;
+static uint16_t uart_reported_pos = 0;
+static uint16_t uart_events[HOST_HAL_UART_EVENTS];
+static uint32_t uart_event_head = 0;
+static uint32_t uart_event_tail = 0;
+static HostHal_UartTxHook uart_tx_hook = NULL;
+static UART_HandleTypeDef* uart_tx_handle = NULL;
+static uint64_t uart_tx_done_us = HOST_HAL_NEVER;  // Конец передачи через прерывание
+static uint8_t uart_tx_done = 0;
+static HostHal_UartStats uart_stats;
+
+// USB: класс CDC, очередь хоста в конечную точку OUT, передача IN
+static USBD_CDC_ItfTypeDef* usb_fops = NULL;
+static uint8_t usb_configured = 0;
+static uint8_t usb_config_pending = 0;
+static uint8_t* usb_rx_buffer = NULL;
+static uint8_t usb_rx_armed = 0;
+static uint32_t usb_rx_length = 0;       // Пакет OUT ждет обработчика
+static uint64_t usb_rx_ready_us = 0;
+static uint8_t usb_out[HOST_HAL_USB_QUEUE_SIZE];
+static uint32_t usb_out_head = 0;
+static uint32_t usb_out_tail = 0;
+static uint8_t* usb_tx_buffer = NULL;
+static uint32_t usb_tx_length = 0;
+static uint8_t usb_tx_busy = 0;
+static uint64_t usb_tx_done_us = HOST_HAL_NEVER;
+static uint8_t usb_tx_done = 0;
+static HostHal_UsbHook usb_hook = NULL;
+
+static void HostHal_Pend(IRQn_Type irq) {
+    irq_pending |= 1ULL << (uint32_t)irq;
+}
+
+static void HostHal_CallHandler(uint32_t irq) {
+    switch (irq) {
+        case HOST_HAL_SYSTICK_IRQ:     SysTick_Handler(); break;
+        case TIM2_IRQn:                TIM2_IRQHandler(); break;
+        case TIM3_IRQn:                TIM3_IRQHandler(); break;
+        case USART2_IRQn:              USART2_IRQHandler(); break;
+        case DMA1_Channel6_IRQn:       DMA1_Channel6_IRQHandler(); break;
+        case USB_LP_CAN1_RX0_IRQn:     USB_LP_CAN1_RX0_IRQHandler(); break;
+        default: break;
+    }
+}
+
+// Обработчики разрешенных прерываний по очереди, SysTick первым
+static void HostHal_ServiceIrqs(void) {
+    if (primask || in_isr) {
+        return;
+    }
+
+    in_isr = 1;
+    uint64_t ready;
+    while ((ready = irq_pending & irq_enabled) != 0) {
+        uint32_t irq = (ready & (1ULL << HOST_HAL_SYSTICK_IRQ)) ? HOST_HAL_SYSTICK_IRQ
+                                                                : (uint32_t)__builtin_ctzll(ready);
+        irq_pending &= ~(1ULL << irq);
+        HostHal_CallHandler(irq);
+    }
+    in_isr = 0;
+}
+
+static HostHal_Timer* HostHal_FindTimer(TIM_TypeDef* instance) {
+    for (uint32_t i = 0; i < HOST_HAL_TIMERS; i++) {
+        if (timers[i].instance == instance) {
+            return &timers[i];
+        }
+    }
+    return NULL;
+}
+
+// Флаги, сброшенные прошивкой записью нуля, снимаются и в модели
+static void HostHal_SyncTimerFlags(HostHal_Timer* timer) {
+    timer->sr &= timer->instance->SR;
+    timer->instance->SR = timer->sr;
+}
+
+static void HostHal_SetTimerFlags(HostHal_Timer* timer, uint32_t flags) {
+    HostHal_SyncTimerFlags(timer);
+    timer->sr |= flags;
+    timer->instance->SR = timer->sr;
+}
+
+static uint32_t HostHal_TimerCounter(const HostHal_Timer* timer) {
+    uint64_t counts = (now_us - timer->start_us) * timer->count_hz / 1000000U;
+    return (uint32_t)(counts % ((uint64_t)timer->instance->ARR + 1U));
+}
+
+// Регистры счетчиков, которые прошивка читает напрямую
+static void HostHal_UpdateCounters(void) {
+    for (uint32_t i = 0; i < HOST_HAL_TIMERS; i++) {
+        if (timers[i].running) {
+            timers[i].instance->CNT = HostHal_TimerCounter(&timers[i]);
+        }
+    }
+    HostHal_DWT.CYCCNT = (uint32_t)(now_us * (SystemCoreClock / 1000000U));
+}
+
+static uint32_t HostHal_UartByteUs(uint32_t index) {
+    // 10 бит на байт (8N1)
+    return (uint32_t)((uint64_t)index * 10000000U / uart_line_baud);
+}
+
+static void HostHal_UartEvent(uint16_t size, IRQn_Type irq) {
+    if (uart_event_head - uart_event_tail < HOST_HAL_UART_EVENTS) {
+        uart_events[uart_event_head++ & (HOST_HAL_UART_EVENTS - 1)] = size;
+    }
+    uart_reported_pos = size % uart_dma_size;
+    HostHal_Pend(irq);
+}
+
+static void HostHal_UartReceiveByte(void) {
+    uint8_t byte = uart_queue[uart_tail++ & (HOST_HAL_UART_QUEUE_SIZE - 1)];
+    uart_burst_index++;
+
+    if (uart_dma_buffer == NULL || uart_rx_handle->Init.BaudRate != uart_line_baud) {
+        uart_stats.rx_lost++;
+    } else {
+        // Половина и конец буфера - прерывания DMA (HT/TC), как в HAL
+        uart_dma_buffer[uart_dma_pos++] = byte;
+        uart_stats.rx_bytes++;
+        if (uart_dma_pos == uart_dma_size / 2) {
+            HostHal_UartEvent(uart_dma_pos, DMA1_Channel6_IRQn);
+        } else if (uart_dma_pos == uart_dma_size) {
+            HostHal_UartEvent(uart_dma_pos, DMA1_Channel6_IRQn);
+            uart_dma_pos = 0;
+        }
+    }
+
+    if (uart_head == uart_tail) {
+        // Пауза на линии длиной в байт - событие IDLE
+        uart_next_byte_us = HOST_HAL_NEVER;
+        uart_idle_us = now_us + HostHal_UartByteUs(1);
+    } else {
+        uart_next_byte_us = uart_burst_start_us + HostHal_UartByteUs(uart_burst_index);
+    }
+}
+
+static uint8_t HostHal_UsbOutReady(void) {
+    return usb_configured && usb_rx_armed && usb_out_head != usb_out_tail;
+}
+
+static uint64_t HostHal_NextEvent(void) {
+    uint64_t t = HOST_HAL_NEVER;
+
+    if (systick_running && next_systick_us < t) t = next_systick_us;
+    for (uint32_t i = 0; i < HOST_HAL_TIMERS; i++) {
+        if (timers[i].running && timers[i].next_update_us < t) t = timers[i].next_update_us;
+    }
+    if (next_pps_us < t) t = next_pps_us;
+    if (uart_next_byte_us < t) t = uart_next_byte_us;
+    if (uart_idle_us < t) t = uart_idle_us;
+    if (uart_tx_done_us < t) t = uart_tx_done_us;
+    if (usb_tx_done_us < t) t = usb_tx_done_us;
+    if (HostHal_UsbOutReady()) {
+        uint64_t ready = (usb_rx_ready_us > now_us) ? usb_rx_ready_us : now_us;
+        if (ready < t) t = ready;
+    }
+    return t;
+}
+
+// События периферии, наступившие к now_us
+static void HostHal_ProcessEvents(void) {
+    if (systick_running && next_systick_us <= now_us) {
+        next_systick_us += HOST_HAL_SYSTICK_US;
+        irq_pending |= 1ULL << HOST_HAL_SYSTICK_IRQ;
+        if (tick_hook != NULL) {
+            tick_hook(now_us);
+        }
+    }
+
+    for (uint32_t i = 0; i < HOST_HAL_TIMERS; i++) {
+        HostHal_Timer* timer = &timers[i];
+        if (timer->running && timer->next_update_us <= now_us) {
+            timer->next_update_us += timer->period_us;
+            HostHal_SetTimerFlags(timer, TIM_SR_UIF);
+            if (timer->instance->DIER & TIM_DIER_UIE) {
+                HostHal_Pend(timer->irq);
+            }
+        }
+    }
+
+    if (next_pps_us <= now_us) {
+        next_pps_us += 1000000U;
+        HostHal_Timer* timer = &timers[0];
+        if (timer->running && (timer->instance->CCER & TIM_CCER_CC1E)) {
+            uint32_t flags = (timer->sr & TIM_SR_CC1IF) ? TIM_SR_CC1IF | TIM_SR_CC1OF : TIM_SR_CC1IF;
+            timer->instance->CCR1 = timer->instance->CNT;
+            HostHal_SetTimerFlags(timer, flags);
+            if (timer->instance->DIER & TIM_DIER_CC1IE) {
+                HostHal_Pend(timer->irq);
+            }
+        }
+    }
+
+    while (uart_next_byte_us <= now_us) {
+        HostHal_UartReceiveByte();
+    }
+    if (uart_idle_us <= now_us) {
+        uart_idle_us = HOST_HAL_NEVER;
+        if (uart_dma_buffer != NULL && uart_dma_pos != uart_reported_pos) {
+            HostHal_UartEvent(uart_dma_pos, USART2_IRQn);
+        }
+    }
+    if (uart_tx_done_us <= now_us) {
+        uart_tx_done_us = HOST_HAL_NEVER;
+        uart_tx_done = 1;
+        HostHal_Pend(USART2_IRQn);
+    }
+
+    if (usb_tx_done_us <= now_us) {
+        usb_tx_done_us = HOST_HAL_NEVER;
+        usb_tx_done = 1;
+        HostHal_Pend(USB_LP_CAN1_RX0_IRQn);
+    }
+    if (HostHal_UsbOutReady() && usb_rx_ready_us <= now_us) {
+        uint32_t length = usb_out_head - usb_out_tail;
+        if (length > CDC_DATA_FS_MAX_PACKET_SIZE) {
+            length = CDC_DATA_FS_MAX_PACKET_SIZE;
+        }
+        for (uint32_t i = 0; i < length; i++) {
+            usb_rx_buffer[i] = usb_out[usb_out_tail++ & (HOST_HAL_USB_QUEUE_SIZE - 1)];
+        }
+        usb_rx_armed = 0;
+        usb_rx_length = length;
+        usb_rx_ready_us = now_us + HOST_HAL_USB_PACKET_US;
+        HostHal_Pend(USB_LP_CAN1_RX0_IRQn);
+    }
+}
+
+// Переход к ближайшему событию не позже limit
+static void HostHal_Step(uint64_t limit) {
+    uint64_t t = HostHal_NextEvent();
+    if (t > limit) {
+        t = limit;
+    }
+    if (t == HOST_HAL_NEVER) {
+        fprintf(stderr, "host_hal: нет событий, ядро спит навсегда\n");
+        exit(1);
+    }
+    if (t >= end_us) {
+        now_us = end_us;
+        HostHal_UpdateCounters();
+        if (end_hook != NULL) {
+            end_hook();
+        }
+        exit(0);
+    }
+
+    now_us = t;
+    HostHal_UpdateCounters();
+    HostHal_ProcessEvents();
+    HostHal_ServiceIrqs();
+}
+
+uint64_t HostHal_GetMicros(void) {
+    return now_us;
+}
+
+void HostHal_Advance(uint32_t us) {
+    uint64_t target = now_us + us;
+    do {
+        HostHal_Step(target);
+    } while (now_us < target);
+}
+
+void HostHal_SetEndTime(uint64_t us, void (*on_end)(void)) {
+    end_us = us;
+    end_hook = on_end;
+}
+
+void HostHal_SetTickHook(void (*hook)(uint64_t now_us)) {
+    tick_hook = hook;
+}
+
+uint32_t HostHal_GetPrimask(void) {
+    return primask;
+}
+
+void HostHal_SetPrimask(uint32_t value) {
+    primask = value & 1U;
+    HostHal_ServiceIrqs();
+}
+
+// Сон до прерывания: пробуждает и ожидающее при PRIMASK = 1, обработчик
+// выполняется после __enable_irq
+void HostHal_WaitForInterrupt(void) {
+    while ((irq_pending & irq_enabled) == 0) {
+        HostHal_Step(HOST_HAL_NEVER);
+    }
+}
+
+void HostHal_SetGpioHook(HostHal_GpioHook hook) {
+    gpio_hook = hook;
+}
+
+uint32_t HostHal_GetGpioWrites(void) {
+    return gpio_writes;
+}
+
+void HostHal_SetAdc(uint32_t channel, uint16_t value) {
+    if (channel < sizeof(adc_values) / sizeof(adc_values[0])) {
+        adc_values[channel] = value;
+    }
+}
+
+void HostHal_AttachI2c(const HostHal_I2cDevice* device) {
+    for (uint32_t i = 0; i < HOST_HAL_I2C_DEVICES; i++) {
+        if (i2c_devices[i] == NULL) {
+            i2c_devices[i] = device;
+            return;
+        }
+    }
+}
+
+uint8_t HostHal_UartFeed(const uint8_t* data, uint16_t length, uint32_t baudrate) {
+    if (HOST_HAL_UART_QUEUE_SIZE - (uart_head - uart_tail) < length) {
+        return 0;
+    }
+
+    // Новая посылка после паузы на линии начинается с текущего момента
+    if (uart_head == uart_tail) {
+        uart_line_baud = baudrate;
+        uart_burst_start_us = now_us;
+        uart_burst_index = 0;
+        uart_next_byte_us = now_us + HostHal_UartByteUs(1);
+    }
+    for (uint16_t i = 0; i < length; i++) {
+        uart_queue[uart_head++ & (HOST_HAL_UART_QUEUE_SIZE - 1)] = data[i];
+    }
+    return 1;
+}
+
+void HostHal_SetUartTxHook(HostHal_UartTxHook hook) {
+    uart_tx_hook = hook;
+}
+
+void HostHal_GetUartStats(HostHal_UartStats* stats) {
+    *stats = uart_stats;
+}
+
+void HostHal_SetPps(uint8_t enabled) {
+    pps_enabled = enabled;
+    next_pps_us = enabled ? (now_us / 1000000U + 1U) * 1000000U : HOST_HAL_NEVER;
+}
+
+uint8_t HostHal_UsbSend(const uint8_t* data, uint16_t length) {
+    if (HOST_HAL_USB_QUEUE_SIZE - (usb_out_head - usb_out_tail) < length) {
+        return 0;
+    }
+    for (uint16_t i = 0; i < length; i++) {
+        usb_out[usb_out_head++ & (HOST_HAL_USB_QUEUE_SIZE - 1)] = data[i];
+    }
+    return 1;
+}
+
+void HostHal_SetUsbHook(HostHal_UsbHook hook) {
+    usb_hook = hook;
+}
+
+// ---------------------------------------------------------------------------
+// Обратные вызовы, которые прошивка может не определять (weak в HAL)
+
+__weak void HAL_MspInit(void) {}
+__weak void HAL_TIM_Base_MspInit(TIM_HandleTypeDef* htim) {}
+__weak void HAL_TIM_IC_MspInit(TIM_HandleTypeDef* htim) {}
+__weak void HAL_UART_MspInit(UART_HandleTypeDef* huart) {}
+__weak void HAL_I2C_MspInit(I2C_HandleTypeDef* hi2c) {}
+__weak void HAL_ADC_MspInit(ADC_HandleTypeDef* hadc) {}
+__weak void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {}
+__weak void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef* htim) {}
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size) {}
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart) {}
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart) {}
+
+// ---------------------------------------------------------------------------
+// Ядро HAL, RCC, NVIC
+
+HAL_StatusTypeDef HAL_Init(void) {
+    systick_running = 1;
+    next_systick_us = now_us + HOST_HAL_SYSTICK_US;
+    HAL_MspInit();
+    return HAL_OK;
+}
+
+void HAL_IncTick(void) {
+    uwTick += uwTickFreq;
+}
+
+uint32_t HAL_GetTick(void) {
+    return uwTick;
+}
+
+void HAL_Delay(uint32_t Delay) {
+    // Как в HAL: не меньше Delay полных периодов SysTick
+    uint32_t start = HAL_GetTick();
+    uint32_t wait = (Delay < HAL_MAX_DELAY) ? Delay + uwTickFreq : Delay;
+    while (HAL_GetTick() - start < wait) {
+        HostHal_Step(HOST_HAL_NEVER);
+    }
+}
+
+void HAL_DBGMCU_EnableDBGSleepMode(void) {}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef* RCC_OscInitStruct) {
+    HostHal_RCC.CFGR = (HostHal_RCC.CFGR & ~RCC_CFGR_PLLMULL) | RCC_OscInitStruct->PLL.PLLMUL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef* RCC_ClkInitStruct, uint32_t FLatency) {
+    uint32_t cfgr = HostHal_RCC.CFGR;
+    cfgr = (cfgr & ~RCC_CFGR_PPRE1) | RCC_ClkInitStruct->APB1CLKDivider;
+    cfgr = (cfgr & ~RCC_CFGR_PPRE2) | (RCC_ClkInitStruct->APB2CLKDivider << 3);
+    HostHal_RCC.CFGR = cfgr;
+
+    // PLL от HSE без делителя, как в SystemClock_Config
+    if (RCC_ClkInitStruct->SYSCLKSource == RCC_SYSCLKSOURCE_PLLCLK) {
+        uint32_t mul = ((cfgr & RCC_CFGR_PLLMULL) >> RCC_CFGR_PLLMULL_Pos) + 2U;
+        SystemCoreClock = HSE_VALUE * mul;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef* PeriphClkInit) {
+    return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void) {
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void) {
+    return SystemCoreClock;
+}
+
+static uint32_t HostHal_ApbShift(uint32_t ppre) {
+    // PPRE: 0xx - без деления, 100 - /2, 101 - /4, 110 - /8, 111 - /16
+    return (ppre & 4U) ? (ppre & 3U) + 1U : 0U;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+    return SystemCoreClock >> HostHal_ApbShift((HostHal_RCC.CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos);
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void) {
+    return SystemCoreClock >> HostHal_ApbShift((HostHal_RCC.CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos);
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    irq_enabled |= 1ULL << (uint32_t)IRQn;
+    HostHal_ServiceIrqs();
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    irq_enabled &= ~(1ULL << (uint32_t)IRQn);
+}
+
+// ---------------------------------------------------------------------------
+// GPIO, DMA
+
+void HAL_GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_Init) {}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef* GPIOx, uint32_t GPIO_Pin) {}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    if (PinState == GPIO_PIN_SET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+    gpio_writes++;
+    if (gpio_hook != NULL) {
+        gpio_hook(GPIOx, GPIO_Pin, PinState);
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+    HAL_GPIO_WritePin(GPIOx, GPIO_Pin, (GPIOx->ODR & GPIO_Pin) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma) {
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef* hdma) {
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+// Прерывание DMA1 Channel6 (прием USART2): половина и конец буфера
+static void HostHal_UartDeliverEvents(void) {
+    while (uart_event_tail != uart_event_head) {
+        uint16_t size = uart_events[uart_event_tail++ & (HOST_HAL_UART_EVENTS - 1)];
+        if (uart_rx_handle != NULL) {
+            HAL_UARTEx_RxEventCallback(uart_rx_handle, size);
+        }
+    }
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma) {
+    HostHal_UartDeliverEvents();
+}
+
+// ---------------------------------------------------------------------------
+// ADC1: опрос по рангам регулярной группы, DMA - снимок значений каналов
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef* hadc) {
+    if (hadc->State == HAL_ADC_STATE_RESET) {
+        HAL_ADC_MspInit(hadc);
+    }
+    hadc->State = HAL_ADC_STATE_READY;
+    adc_rank_count = (uint8_t)hadc->Init.NbrOfConversion;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef* hadc, ADC_ChannelConfTypeDef* sConfig) {
+    if (sConfig->Rank >= 1 && sConfig->Rank <= 16) {
+        adc_ranks[sConfig->Rank - 1] = sConfig->Channel;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef* hadc) {
+    adc_poll_index = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Stop(ADC_HandleTypeDef* hadc) {
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef* hadc, uint32_t Timeout) {
+    return HAL_OK;
+}
+
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef* hadc) {
+    uint8_t count = adc_rank_count ? adc_rank_count : 1;
+    uint32_t channel = adc_ranks[adc_poll_index % count];
+    adc_poll_index = (uint8_t)((adc_poll_index + 1U) % count);
+    return adc_values[channel];
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef* hadc, uint32_t* pData, uint32_t Length) {
+    uint16_t* out = (uint16_t*)pData;
+    uint8_t count = adc_rank_count ? adc_rank_count : 1;
+    for (uint32_t i = 0; i < Length; i++) {
+        out[i] = adc_values[adc_ranks[i % count]];
+    }
+    return HAL_OK;
+}
+
+void HAL_ADC_IRQHandler(ADC_HandleTypeDef* hadc) {}
+
+// ---------------------------------------------------------------------------
+// I2C1: обмен занимает время передачи на шине (9 бит на байт)
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef* hi2c) {
+    if (hi2c->State == HAL_I2C_STATE_RESET) {
+        HAL_I2C_MspInit(hi2c);
+    }
+    hi2c->State = HAL_I2C_STATE_READY;
+    return HAL_OK;
+}
+
+static const HostHal_I2cDevice* HostHal_FindI2c(uint16_t DevAddress) {
+    for (uint32_t i = 0; i < HOST_HAL_I2C_DEVICES; i++) {
+        if (i2c_devices[i] != NULL && i2c_devices[i]->address == (DevAddress >> 1)) {
+            return i2c_devices[i];
+        }
+    }
+    return NULL;
+}
+
+static void HostHal_I2cBusTime(uint32_t bytes) {
+    HostHal_Advance((uint32_t)((uint64_t)bytes * 9U * 1000000U / HOST_HAL_I2C_HZ));
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+    const HostHal_I2cDevice* device = HostHal_FindI2c(DevAddress);
+    if (device == NULL) {
+        HostHal_I2cBusTime(1);
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+        return HAL_ERROR;
+    }
+
+    // Адрес, регистр, повторный старт с адресом, данные
+    HostHal_I2cBusTime(3U + Size);
+    device->read((uint8_t)MemAddress, pData, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+    const HostHal_I2cDevice* device = HostHal_FindI2c(DevAddress);
+    if (device == NULL) {
+        HostHal_I2cBusTime(1);
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+        return HAL_ERROR;
+    }
+
+    HostHal_I2cBusTime(2U + Size);
+    device->write((uint8_t)MemAddress, pData, Size);
+    return HAL_OK;
+}
+
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef* hi2c) {}
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef* hi2c) {}
+
+// ---------------------------------------------------------------------------
+// TIM2/TIM3: счет от времени симуляции, прерывания переполнения и захвата
+
+static HAL_StatusTypeDef HostHal_TimInit(TIM_HandleTypeDef* htim) {
+    htim->Instance->PSC = htim->Init.Prescaler;
+    htim->Instance->ARR = htim->Init.Period;
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef* htim) {
+    if (htim->State == HAL_TIM_STATE_RESET) {
+        HAL_TIM_Base_MspInit(htim);
+    }
+    return HostHal_TimInit(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef* htim) {
+    if (htim->State == HAL_TIM_STATE_RESET) {
+        HAL_TIM_IC_MspInit(htim);
+    }
+    return HostHal_TimInit(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef* htim, const TIM_ClockConfigTypeDef* sClockSourceConfig) {
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef* htim,
+                                                        const TIM_MasterConfigTypeDef* sMasterConfig) {
+    return HAL_OK;
+}
+
+// PSC читается при запуске счета: событие обновления ничего не меняет
+HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef* htim, uint32_t EventSource) {
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef* htim, const TIM_IC_InitTypeDef* sConfig, uint32_t Channel) {
+    return HAL_OK;
+}
+
+// Частота счета: TIMxCLK = PCLK, умноженная на 2 при делителе APB > 1
+static void HostHal_TimStart(TIM_HandleTypeDef* htim) {
+    HostHal_Timer* timer = HostHal_FindTimer(htim->Instance);
+    if (timer == NULL || timer->running) {
+        return;
+    }
+
+    uint32_t clock = HAL_RCC_GetPCLK1Freq();
+    if (HostHal_RCC.CFGR & (4U << RCC_CFGR_PPRE1_Pos)) {
+        clock *= 2U;
+    }
+    timer->count_hz = clock / (htim->Instance->PSC + 1U);
+    timer->period_us = ((uint64_t)htim->Instance->ARR + 1U) * 1000000U / timer->count_hz;
+    timer->start_us = now_us;
+    timer->next_update_us = now_us + timer->period_us;
+    timer->running = 1;
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef* htim) {
+    HostHal_TimStart(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* htim) {
+    htim->Instance->DIER |= TIM_DIER_UIE;
+    HostHal_TimStart(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Start_IT(TIM_HandleTypeDef* htim, uint32_t Channel) {
+    if (Channel == TIM_CHANNEL_1) {
+        htim->Instance->DIER |= TIM_DIER_CC1IE;
+        htim->Instance->CCER |= TIM_CCER_CC1E;
+    }
+    HostHal_TimStart(htim);
+    return HAL_OK;
+}
+
+uint32_t HAL_TIM_ReadCapturedValue(const TIM_HandleTypeDef* htim, uint32_t Channel) {
+    return (Channel == TIM_CHANNEL_1) ? htim->Instance->CCR1 : 0U;
+}
+
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef* htim) {
+    HostHal_Timer* timer = HostHal_FindTimer(htim->Instance);
+    if (timer == NULL) {
+        return;
+    }
+
+    HostHal_SyncTimerFlags(timer);
+    if ((timer->sr & TIM_SR_CC1IF) && (htim->Instance->DIER & TIM_DIER_CC1IE)) {
+        timer->sr &= ~(uint32_t)(TIM_SR_CC1IF | TIM_SR_CC1OF);
+        htim->Instance->SR = timer->sr;
+        htim->Channel = HAL_TIM_ACTIVE_CHANNEL_1;
+        HAL_TIM_IC_CaptureCallback(htim);
+        htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+    }
+    HostHal_SyncTimerFlags(timer);
+    if ((timer->sr & TIM_SR_UIF) && (htim->Instance->DIER & TIM_DIER_UIE)) {
+        timer->sr &= ~(uint32_t)TIM_SR_UIF;
+        htim->Instance->SR = timer->sr;
+        HAL_TIM_PeriodElapsedCallback(htim);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// USART2: передача занимает время на линии, прием - DMA в кольцевой буфер
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef* huart) {
+    if (huart->gState == HAL_UART_STATE_RESET) {
+        HAL_UART_MspInit(huart);
+    }
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size,
+                                    uint32_t Timeout) {
+    uart_stats.tx_bytes += Size;
+    if (uart_tx_hook != NULL) {
+        uart_tx_hook(pData, Size);
+    }
+    HostHal_Advance((uint32_t)((uint64_t)Size * 10000000U / huart->Init.BaudRate));
+    return HAL_OK;
+}
+
+// Байты уходят хуку сразу, прерывание завершения - через время на линии
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size) {
+    if (huart->gState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    uart_tx_handle = huart;
+    uart_stats.tx_bytes += Size;
+    if (uart_tx_hook != NULL) {
+        uart_tx_hook(pData, Size);
+    }
+    uart_tx_done_us = now_us + (uint64_t)Size * 10000000U / huart->Init.BaudRate;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef* huart) {
+    if (huart == uart_tx_handle) {
+        uart_tx_done_us = HOST_HAL_NEVER;
+        uart_tx_done = 0;
+    }
+    huart->gState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Abort(UART_HandleTypeDef* huart) {
+    if (huart == uart_rx_handle) {
+        uart_dma_buffer = NULL;
+        uart_event_tail = uart_event_head;
+    }
+    HAL_UART_AbortTransmit(huart);
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size) {
+    uart_rx_handle = huart;
+    uart_dma_buffer = pData;
+    uart_dma_size = Size;
+    uart_dma_pos = 0;
+    uart_reported_pos = 0;
+    uart_event_tail = uart_event_head;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    return HAL_OK;
+}
+
+// Прерывание USART2: пауза на линии (IDLE) и конец передачи (TC)
+void HAL_UART_IRQHandler(UART_HandleTypeDef* huart) {
+    HostHal_UartDeliverEvents();
+    if (uart_tx_done && huart == uart_tx_handle) {
+        uart_tx_done = 0;
+        huart->gState = HAL_UART_STATE_READY;
+        HAL_UART_TxCpltCallback(huart);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// USB device: ядро и класс CDC. Хост конфигурирует устройство сразу после
+// USBD_Start; пакеты OUT и завершения IN приходят в прерывании USB.
+
+USBD_StatusTypeDef USBD_Init(USBD_HandleTypeDef* pdev, USBD_DescriptorsTypeDef* pdesc, uint8_t id) {
+    pdev->id = id;
+    pdev->pDesc = pdesc;
+    // NVIC прерывания USB включает HAL_PCD_MspInit (usbd_conf.c)
+    HAL_NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_RegisterClass(USBD_HandleTypeDef* pdev, USBD_ClassTypeDef* pclass) {
+    pdev->pClass = pclass;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_RegisterInterface(USBD_HandleTypeDef* pdev, USBD_CDC_ItfTypeDef* fops) {
+    pdev->pUserData = fops;
+    usb_fops = fops;
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_Start(USBD_HandleTypeDef* pdev) {
+    usb_config_pending = 1;
+    HostHal_Pend(USB_LP_CAN1_RX0_IRQn);
+    HostHal_ServiceIrqs();
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_SetTxBuffer(USBD_HandleTypeDef* pdev, uint8_t* pbuff, uint16_t length) {
+    usb_tx_buffer = pbuff;
+    usb_tx_length = length;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_SetRxBuffer(USBD_HandleTypeDef* pdev, uint8_t* pbuff) {
+    usb_rx_buffer = pbuff;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_ReceivePacket(USBD_HandleTypeDef* pdev) {
+    if (!usb_configured) {
+        return USBD_FAIL;
+    }
+    usb_rx_armed = 1;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_TransmitPacket(USBD_HandleTypeDef* pdev) {
+    if (!usb_configured) {
+        return USBD_FAIL;
+    }
+    if (usb_tx_busy) {
+        return USBD_BUSY;
+    }
+
+    // Пакеты по 64 байта, по HOST_HAL_USB_PACKET_US на пакет
+    uint32_t packets = usb_tx_length / CDC_DATA_FS_MAX_PACKET_SIZE + 1U;
+    usb_tx_busy = 1;
+    usb_tx_done_us = now_us + packets * HOST_HAL_USB_PACKET_US;
+    return USBD_OK;
+}
+
+void HAL_PCD_IRQHandler(PCD_HandleTypeDef* hpcd) {
+    if (usb_config_pending) {
+        // SET_CONFIGURATION: класс CDC вызывает Init интерфейса и
+        // выставляет конечную точку OUT на прием
+        usb_config_pending = 0;
+        usb_configured = 1;
+        usb_tx_busy = 0;
+        usb_fops->Init();
+        usb_rx_armed = 1;
+    }
+
+    if (usb_tx_done) {
+        uint32_t length = usb_tx_length;
+        usb_tx_done = 0;
+        usb_tx_busy = 0;
+        if (usb_hook != NULL) {
+            usb_hook(usb_tx_buffer, length);
+        }
+        usb_fops->TransmitCplt(usb_tx_buffer, &length, CDC_IN_EP);
+    }
+
+    if (usb_rx_length > 0) {
+        uint32_t length = usb_rx_length;
+        usb_rx_length = 0;
+        usb_fops->Receive(usb_rx_buffer, &length);
+    }
+}
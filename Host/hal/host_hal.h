@@ -0,0 +1,81 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdint.h>
+// Через main.h: подмена stm32f1xx_hal.h находится по путям -I, и ее
+// #include_next доходит до настоящего заголовка
+#include "main.h"
+
+// Имитация периферии STM32F103 для хостовой сборки прошивки (Host/).
+//
+// Время симуляции идет только внутри имитации: при сне ядра (__WFI) - до
+// ближайшего события, в блокирующих вызовах HAL - на время обмена по шине
+// (I2C 400 кГц, передача UART, HAL_Delay) и в HostHal_Advance. Код прошивки
+// между ними выполняется за нулевое время; его стоимость на хосте меряет
+// profile.c (монотонные часы) в тех же точках PROFILE_BEGIN/END.
+//
+// События периферии (SysTick, переполнения TIM2/TIM3, PPS на TIM2 CH1, байты
+// UART через DMA, пакеты USB) вызывают обработчики stm32f1xx_it.c, если
+// прерывание разрешено в NVIC и PRIMASK сброшен, как на плате. Вложенность
+// прерываний по приоритетам не моделируется: обработчики идут по очереди.
+
+// Время симуляции (мкс от сброса)
+uint64_t HostHal_GetMicros(void);
+
+// Ход времени из основного контекста, прерывания обрабатываются по пути
+void HostHal_Advance(uint32_t us);
+
+// Конец симуляции: по достижении времени вызывается on_end и exit(0)
+void HostHal_SetEndTime(uint64_t us, void (*on_end)(void));
+
+// Вызов каждую миллисекунду (сценарий: источники данных, команды хоста),
+// вне контекста прерываний прошивки
+void HostHal_SetTickHook(void (*hook)(uint64_t now_us));
+
+// Маска прерываний и сон ядра (подмена __disable_irq, __WFI и др.)
+uint32_t HostHal_GetPrimask(void);
+void HostHal_SetPrimask(uint32_t primask);
+void HostHal_WaitForInterrupt(void);
+
+// GPIO: каждая запись выхода через HAL_GPIO_WritePin/TogglePin
+typedef void (*HostHal_GpioHook)(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+void HostHal_SetGpioHook(HostHal_GpioHook hook);
+uint32_t HostHal_GetGpioWrites(void);
+
+// ADC1: значение канала (ADC_CHANNEL_x) для опроса и DMA
+void HostHal_SetAdc(uint32_t channel, uint16_t value);
+
+// Устройство на шине I2C1: чтение и запись с адреса регистра
+typedef struct {
+    uint8_t address;    // 7 бит
+    void (*read)(uint8_t reg, uint8_t* data, uint16_t size);
+    void (*write)(uint8_t reg, const uint8_t* data, uint16_t size);
+} HostHal_I2cDevice;
+void HostHal_AttachI2c(const HostHal_I2cDevice* device);
+
+// USART2 (приемник GPS): байты выходят на линию со скоростью baudrate
+// следом за уже поставленными. Байты, пришедшие без приема DMA или на
+// другой скорости UART, теряются. 0 - очередь линии заполнена.
+uint8_t HostHal_UartFeed(const uint8_t* data, uint16_t length, uint32_t baudrate);
+
+// Байты, переданные прошивкой в USART2 (HAL_UART_Transmit, HAL_UART_Transmit_IT)
+typedef void (*HostHal_UartTxHook)(const uint8_t* data, uint16_t length);
+void HostHal_SetUartTxHook(HostHal_UartTxHook hook);
+
+typedef struct {
+    uint32_t rx_bytes;      // Принято в буфер DMA
+    uint32_t rx_lost;       // Потеряно: прием не запущен или скорость не совпала
+    uint32_t tx_bytes;
+} HostHal_UartStats;
+void HostHal_GetUartStats(HostHal_UartStats* stats);
+
+// Импульсы PPS на входе захвата TIM2 CH1 в начале каждой секунды
+void HostHal_SetPps(uint8_t enabled);
+
+// USB CDC со стороны хоста: команды в конечную точку OUT пакетами по 64
+// байта, 0 - очередь заполнена. Хук получает каждую завершенную передачу IN.
+uint8_t HostHal_UsbSend(const uint8_t* data, uint16_t length);
+typedef void (*HostHal_UsbHook)(const uint8_t* data, uint32_t length);
+void HostHal_SetUsbHook(HostHal_UsbHook hook);
+
+#endif // HOST_HAL_H
@@ -0,0 +1,16 @@
+#include "memory_monitor.h"
+#include <string.h>
+
+// memory_monitor.c на хосте не собирается: окраска стека идет по символам
+// скрипта компоновщика и регистру MSP. Раскладку RAM платы здесь не
+// воспроизвести, поэтому команда MEM и поля Frame_Diag получают нули.
+
+void MemoryMonitor_Init(void) {
+}
+
+void MemoryMonitor_Update(void) {
+}
+
+void MemoryMonitor_GetStats(MemoryMonitor_Stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+}
@@ -0,0 +1,93 @@
+#ifndef HOST_STM32F1XX_HAL_H
+#define HOST_STM32F1XX_HAL_H
+
+// Хостовая подмена stm32f1xx_hal.h: типы, константы и макросы берутся из
+// настоящих заголовков HAL и CMSIS, функции HAL реализует host_hal.c.
+//
+// Каталог Host/hal стоит в путях поиска раньше Drivers/STM32F1xx_HAL_Driver/Inc,
+// поэтому модули прошивки собираются без изменений. После настоящего заголовка:
+//   - регистры периферии, к которым прошивка обращается напрямую (TIM2->CNT,
+//     RCC->CFGR в __HAL_RCC_*_CLK_ENABLE, DWT), переносятся в память хоста;
+//   - встроенные функции CMSIS с ассемблером Cortex-M (cpsid, wfi, dmb)
+//     заменяются моделью маски прерываний и сна из host_hal.c.
+
+#include_next "stm32f1xx_hal.h"
+
+#include "host_hal.h"
+
+// Регистры периферии в памяти хоста
+extern RCC_TypeDef HostHal_RCC;
+extern GPIO_TypeDef HostHal_GPIOA, HostHal_GPIOB, HostHal_GPIOC;
+extern AFIO_TypeDef HostHal_AFIO;
+extern TIM_TypeDef HostHal_TIM1, HostHal_TIM2, HostHal_TIM3, HostHal_TIM4;
+extern ADC_TypeDef HostHal_ADC1;
+extern I2C_TypeDef HostHal_I2C1;
+extern USART_TypeDef HostHal_USART1, HostHal_USART2, HostHal_USART3;
+extern DMA_TypeDef HostHal_DMA1;
+extern DMA_Channel_TypeDef HostHal_DMA1_Channel[7];
+extern DWT_Type HostHal_DWT;
+extern CoreDebug_Type HostHal_CoreDebug;
+
+#undef RCC
+#define RCC (&HostHal_RCC)
+#undef GPIOA
+#define GPIOA (&HostHal_GPIOA)
+#undef GPIOB
+#define GPIOB (&HostHal_GPIOB)
+#undef GPIOC
+#define GPIOC (&HostHal_GPIOC)
+#undef AFIO
+#define AFIO (&HostHal_AFIO)
+#undef TIM1
+#define TIM1 (&HostHal_TIM1)
+#undef TIM2
+#define TIM2 (&HostHal_TIM2)
+#undef TIM3
+#define TIM3 (&HostHal_TIM3)
+#undef TIM4
+#define TIM4 (&HostHal_TIM4)
+#undef ADC1
+#define ADC1 (&HostHal_ADC1)
+#undef I2C1
+#define I2C1 (&HostHal_I2C1)
+#undef USART1
+#define USART1 (&HostHal_USART1)
+#undef USART2
+#define USART2 (&HostHal_USART2)
+#undef USART3
+#define USART3 (&HostHal_USART3)
+#undef DMA1
+#define DMA1 (&HostHal_DMA1)
+#undef DMA1_Channel1
+#define DMA1_Channel1 (&HostHal_DMA1_Channel[0])
+#undef DMA1_Channel2
+#define DMA1_Channel2 (&HostHal_DMA1_Channel[1])
+#undef DMA1_Channel3
+#define DMA1_Channel3 (&HostHal_DMA1_Channel[2])
+#undef DMA1_Channel4
+#define DMA1_Channel4 (&HostHal_DMA1_Channel[3])
+#undef DMA1_Channel5
+#define DMA1_Channel5 (&HostHal_DMA1_Channel[4])
+#undef DMA1_Channel6
+#define DMA1_Channel6 (&HostHal_DMA1_Channel[5])
+#undef DMA1_Channel7
+#define DMA1_Channel7 (&HostHal_DMA1_Channel[6])
+#undef DWT
+#define DWT (&HostHal_DWT)
+#undef CoreDebug
+#define CoreDebug (&HostHal_CoreDebug)
+
+// Встроенные функции CMSIS
+#undef __WFI
+#define __WFI()            HostHal_WaitForInterrupt()
+#undef __NOP
+#define __NOP()            ((void)0)
+#define __disable_irq()    HostHal_SetPrimask(1)
+#define __enable_irq()     HostHal_SetPrimask(0)
+#define __get_PRIMASK()    HostHal_GetPrimask()
+#define __set_PRIMASK(x)   HostHal_SetPrimask(x)
+#define __DMB()            __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB()            __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __ISB()            __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif // HOST_STM32F1XX_HAL_H
@@ -0,0 +1,486 @@
+// Проверки lockfree.h и seqlock.h на хосте: граничные случаи колец, флагов
+// и seqlock в одном потоке, затем писатель и читатель в разных потоках
+// (pthread) с проверкой последовательности данных и целостности снимков. На хосте lockfree.h идет через атомарные
+// встроенные функции GCC, потоки заменяют пару прерывание - основной цикл.
+//
+//   ./test_lockfree [мегабайт для нагрузочной проверки]
+
+#include "lockfree.h"
+#include "seqlock.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// ---------------------------------------------------------------------------
+// SpscRing
+
+static void TestRingEmptyFull(void) {
+    uint8_t buffer[16];
+    uint8_t data[32];
+    const uint8_t* chunk;
+    SpscRing ring;
+
+    SpscRing_Init(&ring, buffer, sizeof(buffer));
+    CHECK(SpscRing_Size(&ring) == 16);
+    CHECK(SpscRing_Count(&ring) == 0);
+    CHECK(SpscRing_Free(&ring) == 16);
+    CHECK(SpscRing_Peek(&ring, &chunk) == 0);
+    CHECK(SpscRing_Read(&ring, data, sizeof(data)) == 0);
+
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+    // Запись целиком не больше свободного места
+    CHECK(SpscRing_Write(&ring, data, 17) == 0);
+    CHECK(SpscRing_Count(&ring) == 0);
+    CHECK(SpscRing_Write(&ring, data, 16) == 1);
+    CHECK(SpscRing_Free(&ring) == 0);
+    CHECK(SpscRing_Write(&ring, data, 1) == 0);
+    CHECK(SpscRing_WritePartial(&ring, data, 4) == 0);
+
+    uint8_t out[16];
+    CHECK(SpscRing_Read(&ring, out, sizeof(out)) == 16);
+    CHECK(memcmp(out, data, 16) == 0);
+    CHECK(SpscRing_Count(&ring) == 0);
+}
+
+static void TestRingWrap(void) {
+    uint8_t buffer[16];
+    uint8_t data[16];
+    uint8_t out[16];
+    const uint8_t* chunk;
+    SpscRing ring;
+
+    SpscRing_Init(&ring, buffer, sizeof(buffer));
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(0xA0 + i);
+    }
+
+    // Сдвиг к концу буфера: следующая запись переходит через край
+    CHECK(SpscRing_Write(&ring, data, 12) == 1);
+    CHECK(SpscRing_Read(&ring, out, 12) == 12);
+    CHECK(SpscRing_Write(&ring, data, 10) == 1);
+
+    // Peek отдает участок до конца буфера, остаток - со следующего вызова
+    CHECK(SpscRing_Peek(&ring, &chunk) == 4);
+    CHECK(chunk == &buffer[12]);
+    CHECK(memcmp(chunk, data, 4) == 0);
+    SpscRing_Consume(&ring, 4);
+    CHECK(SpscRing_Peek(&ring, &chunk) == 6);
+    CHECK(chunk == &buffer[0]);
+    CHECK(memcmp(chunk, &data[4], 6) == 0);
+    SpscRing_Consume(&ring, 6);
+    CHECK(SpscRing_Count(&ring) == 0);
+
+    // WritePartial через край, Read собирает оба участка
+    CHECK(SpscRing_WritePartial(&ring, data, 16) == 16);
+    CHECK(SpscRing_Read(&ring, out, 16) == 16);
+    CHECK(memcmp(out, data, 16) == 0);
+
+    // Счетчики переходят через 2^32 без потери длины
+    ring.head = ring.tail = 0xFFFFFFF8U;
+    CHECK(SpscRing_Write(&ring, data, 16) == 1);
+    CHECK(ring.head == 8);
+    CHECK(SpscRing_Count(&ring) == 16);
+    CHECK(SpscRing_Read(&ring, out, 16) == 16);
+    CHECK(memcmp(out, data, 16) == 0);
+}
+
+// Commit без проверки места (DMA пишет в буфер сам): Count больше размера,
+// читатель определяет перезапись и догоняет
+static void TestRingCommitOverrun(void) {
+    uint8_t buffer[16];
+    const uint8_t* chunk;
+    SpscRing ring;
+
+    SpscRing_Init(&ring, buffer, sizeof(buffer));
+    for (uint32_t i = 0; i < 20; i++) {
+        buffer[i & 15] = (uint8_t)i;
+    }
+    SpscRing_Commit(&ring, 20);
+    CHECK(SpscRing_Count(&ring) == 20);
+    CHECK(SpscRing_Count(&ring) > SpscRing_Size(&ring));
+
+    // Как GPS_Update: отбросить перезаписанное, остаются последние 16 байт
+    SpscRing_Consume(&ring, SpscRing_Count(&ring) - SpscRing_Size(&ring));
+    CHECK(SpscRing_Count(&ring) == 16);
+    CHECK(SpscRing_Peek(&ring, &chunk) == 12);
+    CHECK(chunk[0] == 4);
+    SpscRing_Consume(&ring, 12);
+    CHECK(SpscRing_Peek(&ring, &chunk) == 4);
+    CHECK(chunk[0] == 16 && chunk[3] == 19);
+    SpscRing_Consume(&ring, 4);
+    CHECK(SpscRing_Count(&ring) == 0);
+}
+
+// ---------------------------------------------------------------------------
+// SpscRecordRing
+
+typedef struct {
+    uint32_t id;
+    uint16_t length;
+    uint8_t tag;
+    uint8_t reserved;
+} TestRecord;
+
+static void TestRecordRing(void) {
+    TestRecord storage[4];
+    TestRecord out[8];
+    SpscRecordRing ring;
+
+    SpscRecordRing_Init(&ring, storage, sizeof(TestRecord), 4);
+    CHECK(SpscRecordRing_Count(&ring) == 0);
+    CHECK(SpscRecordRing_Read(&ring, out, 8) == 0);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        TestRecord r = { i, (uint16_t)(i * 10), (uint8_t)i, 0 };
+        CHECK(SpscRecordRing_Push(&ring, &r) == 1);
+    }
+    TestRecord extra = { 99, 0, 0, 0 };
+    CHECK(SpscRecordRing_Push(&ring, &extra) == 0);
+    CHECK(SpscRecordRing_Count(&ring) == 4);
+
+    // Чтение частями с переходом через край
+    CHECK(SpscRecordRing_Read(&ring, out, 3) == 3);
+    CHECK(out[0].id == 0 && out[2].id == 2 && out[2].length == 20);
+    for (uint32_t i = 4; i < 7; i++) {
+        TestRecord r = { i, (uint16_t)(i * 10), (uint8_t)i, 0 };
+        CHECK(SpscRecordRing_Push(&ring, &r) == 1);
+    }
+    CHECK(SpscRecordRing_Read(&ring, out, 8) == 4);
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(out[i].id == 3 + i);
+        CHECK(out[i].tag == (uint8_t)(3 + i));
+    }
+
+    // Clear сбрасывает непрочитанное, место снова доступно
+    for (uint32_t i = 0; i < 3; i++) {
+        CHECK(SpscRecordRing_Push(&ring, &extra) == 1);
+    }
+    SpscRecordRing_Clear(&ring);
+    CHECK(SpscRecordRing_Count(&ring) == 0);
+    CHECK(SpscRecordRing_Read(&ring, out, 8) == 0);
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(SpscRecordRing_Push(&ring, &extra) == 1);
+    }
+    CHECK(SpscRecordRing_Push(&ring, &extra) == 0);
+}
+
+// ---------------------------------------------------------------------------
+// AtomicFlag, EventFlags
+
+static void TestFlags(void) {
+    AtomicFlag flag = { 0 };
+    CHECK(AtomicFlag_Take(&flag) == 0);
+    AtomicFlag_Set(&flag);
+    AtomicFlag_Set(&flag);  // Повторная установка не копится
+    CHECK(AtomicFlag_Take(&flag) == 1);
+    CHECK(AtomicFlag_Take(&flag) == 0);
+
+    EventFlags events = { 0 };
+    CHECK(EventFlags_Take(&events, 0xFFFFFFFFU) == 0);
+    EventFlags_Set(&events, 0x5);
+    EventFlags_Set(&events, 0x80000000U);
+    CHECK(EventFlags_Peek(&events) == 0x80000005U);
+    // Взятие по маске оставляет остальные флаги
+    CHECK(EventFlags_Take(&events, 0x1) == 0x1);
+    CHECK(EventFlags_Peek(&events) == 0x80000004U);
+    CHECK(EventFlags_Take(&events, 0x3) == 0);
+    CHECK(EventFlags_Take(&events, 0xFFFFFFFFU) == 0x80000004U);
+    CHECK(EventFlags_Peek(&events) == 0);
+}
+
+// ---------------------------------------------------------------------------
+// Seqlock
+
+#define SNAPSHOT_WORDS 16
+
+// Все слова снимка пишутся одним значением: разные слова - разорванная копия
+typedef struct {
+    uint32_t word[SNAPSHOT_WORDS];
+} TestSnapshot;
+
+static void TestSnapshotFill(TestSnapshot* snapshot, uint32_t value) {
+    for (uint32_t i = 0; i < SNAPSHOT_WORDS; i++) {
+        snapshot->word[i] = value;
+    }
+}
+
+static uint8_t TestSnapshotIntact(const TestSnapshot* snapshot) {
+    for (uint32_t i = 1; i < SNAPSHOT_WORDS; i++) {
+        if (snapshot->word[i] != snapshot->word[0]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void TestSeqlock(void) {
+    Seqlock lock;
+    TestSnapshot shared;
+    TestSnapshot local;
+    TestSnapshot out;
+
+    Seqlock_Init(&lock);
+    TestSnapshotFill(&local, 7);
+    Seqlock_Write(&lock, &shared, &local, sizeof(shared));
+    CHECK((lock.sequence & 1U) == 0);
+    Seqlock_Read(&lock, &out, &shared, sizeof(out));
+    CHECK(memcmp(&out, &local, sizeof(out)) == 0);
+
+    // Запись между началом и концом чтения требует повтора
+    uint32_t sequence = Seqlock_ReadBegin(&lock);
+    CHECK(Seqlock_ReadRetry(&lock, sequence) == 0);
+    Seqlock_WriteBegin(&lock);
+    CHECK((lock.sequence & 1U) == 1);
+    Seqlock_WriteEnd(&lock);
+    CHECK(Seqlock_ReadRetry(&lock, sequence) == 1);
+    CHECK(Seqlock_ReadRetry(&lock, Seqlock_ReadBegin(&lock)) == 0);
+}
+
+// ---------------------------------------------------------------------------
+// Нагрузочная проверка: писатель и читатель в разных потоках
+
+#define STRESS_RING_SIZE 4096
+#define STRESS_RECORDS   64
+
+static uint8_t stress_buffer[STRESS_RING_SIZE];
+static SpscRing stress_ring;
+static TestRecord stress_records[STRESS_RECORDS];
+static SpscRecordRing stress_record_ring;
+static EventFlags stress_events;
+static uint32_t stress_bytes;
+static uint32_t stress_record_count;
+
+// Байт номер n потока: перестановка, чтобы сдвиг на размер кольца не совпал
+static uint8_t StressByte(uint32_t n) {
+    return (uint8_t)(n * 167U + (n >> 8));
+}
+
+static void* StressProducer(void* arg) {
+    uint8_t chunk[64];
+    uint32_t sent = 0;
+    uint32_t records = 0;
+    uint32_t seed = 1;
+
+    while (sent < stress_bytes || records < stress_record_count) {
+        uint32_t progress = sent + records;
+
+        if (sent < stress_bytes) {
+            // Части от 1 до 64 байт, целиком (Write) или сколько влезет
+            seed = seed * 1103515245U + 12345U;
+            uint32_t size = 1 + ((seed >> 16) & 63);
+            if (size > stress_bytes - sent) {
+                size = stress_bytes - sent;
+            }
+            for (uint32_t i = 0; i < size; i++) {
+                chunk[i] = StressByte(sent + i);
+            }
+            if (seed & 0x80000000U) {
+                if (SpscRing_Write(&stress_ring, chunk, size)) {
+                    sent += size;
+                }
+            } else {
+                sent += SpscRing_WritePartial(&stress_ring, chunk, size);
+            }
+        }
+        if (records < stress_record_count) {
+            TestRecord r = { records, (uint16_t)records, (uint8_t)(records * 7), 0 };
+            if (SpscRecordRing_Push(&stress_record_ring, &r)) {
+                records++;
+                EventFlags_Set(&stress_events, 0x10000U);
+            }
+        }
+        // Флаги писателя: бит 16 на каждую запись, остальные - по числу байт
+        EventFlags_Set(&stress_events, 1U << (sent & 15));
+
+        // Кольца полны: на одном ядре читателю нужно время
+        if (sent + records == progress) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void TestStress(uint32_t megabytes) {
+    pthread_t producer;
+    uint32_t received = 0;
+    uint32_t records = 0;
+    uint32_t mismatches = 0;
+    uint32_t high_takes = 0;
+    uint32_t seed = 7;
+
+    SpscRing_Init(&stress_ring, stress_buffer, sizeof(stress_buffer));
+    SpscRecordRing_Init(&stress_record_ring, stress_records, sizeof(TestRecord), STRESS_RECORDS);
+    stress_bytes = megabytes * 1024U * 1024U;
+    stress_record_count = stress_bytes / 256U;
+
+    pthread_create(&producer, NULL, StressProducer, NULL);
+
+    while (received < stress_bytes || records < stress_record_count) {
+        uint32_t progress = received + records;
+
+        // Чтение поочередно на месте (Peek/Consume) и с копированием (Read)
+        seed = seed * 1103515245U + 12345U;
+        if (seed & 0x100U) {
+            const uint8_t* chunk;
+            uint32_t length = SpscRing_Peek(&stress_ring, &chunk);
+            for (uint32_t i = 0; i < length; i++) {
+                mismatches += (chunk[i] != StressByte(received + i));
+            }
+            SpscRing_Consume(&stress_ring, length);
+            received += length;
+        } else {
+            uint8_t out[48];
+            uint32_t length = SpscRing_Read(&stress_ring, out, 1 + ((seed >> 16) % sizeof(out)));
+            for (uint32_t i = 0; i < length; i++) {
+                mismatches += (out[i] != StressByte(received + i));
+            }
+            received += length;
+        }
+        CHECK(SpscRing_Count(&stress_ring) <= STRESS_RING_SIZE);
+
+        TestRecord out[STRESS_RECORDS];
+        uint32_t count = SpscRecordRing_Read(&stress_record_ring, out, STRESS_RECORDS);
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t id = records + i;
+            mismatches += (out[i].id != id || out[i].length != (uint16_t)id ||
+                           out[i].tag != (uint8_t)(id * 7));
+        }
+        records += count;
+
+        high_takes += (EventFlags_Take(&stress_events, 0x10000U) != 0);
+        EventFlags_Take(&stress_events, 0xFFFFU);
+
+        if (received + records == progress) {
+            sched_yield();
+        }
+    }
+
+    pthread_join(producer, NULL);
+
+    // Установка после последнего взятия не теряется
+    high_takes += (EventFlags_Take(&stress_events, 0x10000U) != 0);
+
+    CHECK(received == stress_bytes);
+    CHECK(records == stress_record_count);
+    CHECK(mismatches == 0);
+    CHECK(high_takes > 0 && high_takes <= stress_record_count);
+    printf("stress: %u bytes, %u records, %u flag takes, %u mismatches\n",
+           (unsigned)received, (unsigned)records, (unsigned)high_takes, (unsigned)mismatches);
+}
+
+// Снимок seqlock: писатель публикует номера по возрастанию, читатель
+// проверяет, что копия не разорвана и номера не идут назад
+
+#define SEQLOCK_WRITES 200000U
+
+static Seqlock stress_lock;
+static TestSnapshot stress_snapshot;
+static volatile uint32_t stress_writer_done;
+
+static void* SeqlockWriter(void* arg) {
+    TestSnapshot local;
+
+    for (uint32_t n = 1; n <= SEQLOCK_WRITES; n++) {
+        if ((n & 4095U) == 0) {
+            // Изредка писатель вытесняется посреди записи: читатель видит
+            // нечетный счетчик и ждет в Seqlock_ReadBegin
+            Seqlock_WriteBegin(&stress_lock);
+            for (uint32_t i = 0; i < SNAPSHOT_WORDS; i++) {
+                stress_snapshot.word[i] = n;
+                if (i == SNAPSHOT_WORDS / 2) {
+                    sched_yield();
+                }
+            }
+            Seqlock_WriteEnd(&stress_lock);
+        } else {
+            TestSnapshotFill(&local, n);
+            Seqlock_Write(&stress_lock, &stress_snapshot, &local, sizeof(local));
+        }
+        if ((n & 15U) == 0) {
+            sched_yield();
+        }
+    }
+    __atomic_store_n(&stress_writer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void TestSeqlockStress(void) {
+    pthread_t writer;
+    TestSnapshot out;
+    uint32_t reads = 0;
+    uint32_t retries = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    uint32_t last = 0;
+
+    Seqlock_Init(&stress_lock);
+    TestSnapshotFill(&stress_snapshot, 0);
+    stress_writer_done = 0;
+    pthread_create(&writer, NULL, SeqlockWriter, NULL);
+
+    while (!__atomic_load_n(&stress_writer_done, __ATOMIC_ACQUIRE)) {
+        if (reads & 1U) {
+            Seqlock_Read(&stress_lock, &out, &stress_snapshot, sizeof(out));
+        } else {
+            // Чтение по шагам с вытеснением между началом и копией:
+            // писатель успевает записать, копия повторяется
+            uint32_t sequence = Seqlock_ReadBegin(&stress_lock);
+            if ((reads & 7U) == 0) {
+                sched_yield();
+            }
+            memcpy(&out, &stress_snapshot, sizeof(out));
+            while (Seqlock_ReadRetry(&stress_lock, sequence)) {
+                retries++;
+                sequence = Seqlock_ReadBegin(&stress_lock);
+                memcpy(&out, &stress_snapshot, sizeof(out));
+            }
+        }
+        torn += !TestSnapshotIntact(&out);
+        backwards += (out.word[0] < last);
+        last = out.word[0];
+        reads++;
+    }
+    pthread_join(writer, NULL);
+
+    Seqlock_Read(&stress_lock, &out, &stress_snapshot, sizeof(out));
+    CHECK(TestSnapshotIntact(&out) && out.word[0] == SEQLOCK_WRITES);
+    CHECK(torn == 0);
+    CHECK(backwards == 0);
+    CHECK(retries > 0);
+    printf("seqlock: %u writes, %u reads, %u retries, %u torn\n",
+           (unsigned)SEQLOCK_WRITES, (unsigned)reads, (unsigned)retries, (unsigned)torn);
+}
+
+int main(int argc, char** argv) {
+    uint32_t megabytes = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 4U;
+
+    TestRingEmptyFull();
+    TestRingWrap();
+    TestRingCommitOverrun();
+    TestRecordRing();
+    TestFlags();
+    TestSeqlock();
+    TestStress(megabytes);
+    TestSeqlockStress();
+
+    if (failures) {
+        fprintf(stderr, "test_lockfree: %u failed\n", failures);
+        return 1;
+    }
+    printf("test_lockfree: ok\n");
+    return 0;
+}
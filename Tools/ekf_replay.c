@@ -0,0 +1,185 @@
+// Хостовая проверка фильтра GPS/IMU (Core/Src/nav_ekf.c).
+//
+// Сборка из корня репозитория:
+//   gcc -O2 -ICore/Inc Tools/ekf_replay.c Core/Src/nav_ekf.c -lm -o ekf_replay
+//
+// Без аргументов - синтетический заезд по окружности: IMU 50 Гц с шумом и
+// смещением нуля, GPS 1 Гц с шумом 2.5 м. Печатает СКО ошибки позиции фильтра
+// и "последнего решения GPS" между решениями, плюс время шага на хосте.
+//
+// С записью: ./ekf_replay imu_capture.csv [gps.csv] > ekf_out.csv
+//   imu_capture.csv - файл захвата Control.py (timestamp_us,ax,ay,az,temp,gx,gy,gz,seq)
+//   gps.csv         - timestamp_us,lat_e7,lon_e7,speed_mps,course_deg
+// Отсчеты GPS привязываются к шкале IMU по timestamp_us.
+
+#include "nav_ekf.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#define GRAVITY        9.80665f
+#define DEG_TO_RAD     0.0174532925f
+#define ACCEL_LSB_PER_G 8192.0f   // ±4g, как в imu.c
+#define GYRO_LSB_PER_DPS 65.5f    // ±500°/с
+
+static uint64_t NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Нормальный шум (Бокс-Мюллер), воспроизводимый между запусками
+static float Gaussian(float sigma) {
+    float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    float u2 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    return sigma * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * 3.14159265f * u2);
+}
+
+static int RunSynthetic(void) {
+    const float dt = 0.02f;            // 50 Гц, поток IMU_CONSUMER_CONTROL
+    const float radius = 20.0f;
+    const float speed = 2.0f;
+    const float omega = speed / radius;
+    const float duration = 300.0f;
+    const int32_t lat0 = 557558000, lon0 = 376173000;
+    const float m_per_e7 = 1e-7f * DEG_TO_RAD * 6371000.0f;
+    const float m_per_e7_lon = m_per_e7 * cosf(lat0 * 1e-7f * DEG_TO_RAD);
+
+    NavEkf ekf;
+    double err_ekf = 0.0, err_gps = 0.0;
+    long samples = 0;
+    float gps_n = 0.0f, gps_e = 0.0f;
+    uint64_t predict_ns = 0, update_ns = 0;
+    long updates = 0;
+
+    srand(1);
+    NavEkf_Init(&ekf);
+
+    for (int step = 0; step * dt < duration; step++) {
+        float t = step * dt;
+        // Истинное движение: старт на востоке окружности, курс на север, против часовой
+        float angle = omega * t;
+        float true_n = radius * sinf(angle);
+        float true_e = radius * cosf(angle);
+        float psi = -angle;
+
+        // GPS раз в секунду: позиция, путевая скорость и курс с шумом
+        if (step % 50 == 0) {
+            gps_n = true_n + Gaussian(NAV_EKF_GPS_POS_NOISE);
+            gps_e = true_e + Gaussian(NAV_EKF_GPS_POS_NOISE);
+            int32_t lat = lat0 + (int32_t)lroundf(gps_n / m_per_e7);
+            int32_t lon = lon0 + (int32_t)lroundf((gps_e - radius) / m_per_e7_lon);
+            float course = psi + Gaussian(0.05f);
+
+            uint64_t t0 = NowNs();
+            NavEkf_UpdatePosition(&ekf, lat, lon);
+            NavEkf_UpdateVelocity(&ekf, speed + Gaussian(0.1f), course, 1.0f);
+            update_ns += NowNs() - t0;
+            updates++;
+        }
+
+        // IMU: поворот против часовой, центростремительное ускорение влево
+        float accel_right = -speed * omega + Gaussian(0.3f) + 0.05f;
+        float accel_fwd = Gaussian(0.3f) - 0.03f;
+        float yaw_rate = omega + Gaussian(0.01f) + 0.002f;
+
+        uint64_t t0 = NowNs();
+        NavEkf_Predict(&ekf, dt, accel_fwd, accel_right, -yaw_rate);
+        predict_ns += NowNs() - t0;
+
+        // Ошибка после первых 30 с, когда фильтр сошелся
+        if (t > 30.0f && ekf.initialized) {
+            // Начало локальной системы фильтра - первое (зашумленное) решение
+            float origin_n = (ekf.origin_lat_e7 - lat0) * m_per_e7;
+            float origin_e = (ekf.origin_lon_e7 - lon0) * m_per_e7_lon + radius;
+            float en = origin_n + ekf.x[NAV_EKF_PN] - true_n;
+            float ee = origin_e + ekf.x[NAV_EKF_PE] - true_e;
+            float gn = gps_n - true_n;
+            float ge = gps_e - true_e;
+            err_ekf += en * en + ee * ee;
+            err_gps += gn * gn + ge * ge;
+            samples++;
+        }
+    }
+
+    printf("synthetic: %ld predicts, %ld GPS updates, %lu scalar updates, %lu rejected\n",
+           (long)ekf.predicts, updates, (unsigned long)ekf.updates, (unsigned long)ekf.rejected);
+    printf("position RMS: filter %.2f m, last GPS fix %.2f m\n",
+           sqrt(err_ekf / samples), sqrt(err_gps / samples));
+    printf("host time: %.1f ns/predict, %.1f ns/GPS update\n",
+           (double)predict_ns / ekf.predicts, (double)update_ns / updates);
+    return 0;
+}
+
+static int RunRecorded(const char* imu_path, const char* gps_path) {
+    FILE* imu = fopen(imu_path, "r");
+    FILE* gps = gps_path ? fopen(gps_path, "r") : NULL;
+    char line[256];
+    NavEkf ekf;
+    uint32_t last_ts = 0;
+    int have_last = 0;
+    int have_gps = 0;
+    unsigned long gps_ts = 0;
+    long gps_lat = 0, gps_lon = 0;
+    float gps_speed = 0.0f, gps_course = 0.0f;
+
+    if (!imu || (gps_path && !gps)) {
+        fprintf(stderr, "cannot open input\n");
+        return 1;
+    }
+
+    NavEkf_Init(&ekf);
+    fgets(line, sizeof(line), imu); // Заголовок
+    if (gps) {
+        fgets(line, sizeof(line), gps);
+        have_gps = fscanf(gps, "%lu,%ld,%ld,%f,%f", &gps_ts, &gps_lat, &gps_lon, &gps_speed, &gps_course) == 5;
+    }
+
+    printf("timestamp_us,north,east,vel_north,vel_east,heading_deg\n");
+    while (fgets(line, sizeof(line), imu)) {
+        unsigned long ts;
+        int ax, ay, az, temp, gx, gy, gz, seq;
+        if (sscanf(line, "%lu,%d,%d,%d,%d,%d,%d,%d,%d", &ts, &ax, &ay, &az, &temp, &gx, &gy, &gz, &seq) != 9) {
+            continue;
+        }
+
+        // Решения GPS, пришедшие до этого отсчета IMU
+        while (have_gps && (int32_t)(gps_ts - ts) <= 0) {
+            NavEkf_UpdatePosition(&ekf, (int32_t)gps_lat, (int32_t)gps_lon);
+            NavEkf_UpdateVelocity(&ekf, gps_speed, gps_course * DEG_TO_RAD, 1.0f);
+            have_gps = fscanf(gps, "%lu,%ld,%ld,%f,%f", &gps_ts, &gps_lat, &gps_lon, &gps_speed, &gps_course) == 5;
+        }
+
+        // Оси как в nav.c: X вперед, Y влево, Z вверх
+        if (have_last) {
+            float dt = (uint32_t)(ts - last_ts) * 1e-6f;
+            NavEkf_Predict(&ekf, dt,
+                           ax / ACCEL_LSB_PER_G * GRAVITY,
+                           -ay / ACCEL_LSB_PER_G * GRAVITY,
+                           -gz / GYRO_LSB_PER_DPS * DEG_TO_RAD);
+        }
+        last_ts = (uint32_t)ts;
+        have_last = 1;
+
+        if (ekf.initialized) {
+            printf("%lu,%.3f,%.3f,%.3f,%.3f,%.2f\n", ts, ekf.x[NAV_EKF_PN], ekf.x[NAV_EKF_PE],
+                   ekf.x[NAV_EKF_VN], ekf.x[NAV_EKF_VE], ekf.x[NAV_EKF_PSI] / DEG_TO_RAD);
+        }
+    }
+
+    fprintf(stderr, "%lu predicts, %lu scalar updates, %lu rejected\n",
+            (unsigned long)ekf.predicts, (unsigned long)ekf.updates, (unsigned long)ekf.rejected);
+    fclose(imu);
+    if (gps) fclose(gps);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return RunRecorded(argv[1], argc > 2 ? argv[2] : NULL);
+    }
+    return RunSynthetic();
+}
@@ -0,0 +1,191 @@
+// Хостовый бенчмарк кадра телеметрии: прежний текстовый кадр snprintf
+// против двоичных кадров каналов телеметрии (telemetry.c) + Frame_Encode
+// (Core/Src/frame.c): полный прежний состав (IMU, ATT, GPS, HALL, NAV)
+// и подписка только на IMU.
+//
+// Сборка и запуск из корня репозитория:
+//   gcc -O2 -ICore/Inc Tools/frame_bench.c Core/Src/frame.c -o frame_bench
+//   ./frame_bench [iterations]
+//   ./frame_bench -x     - пять кадров каналов в hex для проверки декодера Control.py
+//
+// На x86 с аппаратной плавающей точкой разрыв меньше, чем на Cortex-M3:
+// там каждое %.3f - это цепочка программных делений в newlib-nano.
+
+#include "frame.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+static uint64_t NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Типичные значения одного кадра (стоящий ровер, фикс 3D)
+static volatile float imu_f[13] = {
+    0.012f, -0.034f, 0.998f, 0.61f, -0.12f, 0.05f, 0.0f, 0.0f, 0.0f,
+    27.4f, 1.25f, -0.75f, 183.2f
+};
+static volatile float hall_f[4] = { 12.3f, -4.5f, 0.7f, 44.9f };
+
+static int BuildText(char* out, size_t size) {
+    return snprintf(out, size,
+        "IMU:%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.2f,%.2f,%.2f|"
+        "GPS:%ld,%ld,%.2f,%.2f,%.1f,%d,%d,%02d:%02d:%02d.%03d,%02d/%02d/%04d|"
+        "HALL:%.1f,%.1f,%.1f,%.1f|"
+        "TIME:%d,%lu,%lu.%06lu,%lu.%06lu|"
+        "NAV:%d,%ld,%ld,%.2f,%.2f,%.1f\n",
+        imu_f[0], imu_f[1], imu_f[2], imu_f[3], imu_f[4], imu_f[5],
+        imu_f[6], imu_f[7], imu_f[8], imu_f[9], imu_f[10], imu_f[11], imu_f[12],
+        557558123L, 376173456L, 152.37f, 1.52f, 87.4f, 11, 1,
+        12, 34, 56, 200, 19, 10, 2026,
+        hall_f[0], hall_f[1], hall_f[2], hall_f[3],
+        1, 123456789UL, 1792413296UL, 200512UL, 1792413296UL, 201733UL,
+        1, 557558120L, 376173460L, 0.03f, -0.02f, 87.1f);
+}
+
+static uint16_t BuildImu(uint8_t* out, uint16_t size, uint16_t sequence) {
+    Frame_Imu frame;
+
+    frame.timestamp_us = 123456789UL;
+    frame.accel[0] = Frame_ToFixed16(imu_f[0], FRAME_ACCEL_SCALE);
+    frame.accel[1] = Frame_ToFixed16(imu_f[1], FRAME_ACCEL_SCALE);
+    frame.accel[2] = Frame_ToFixed16(imu_f[2], FRAME_ACCEL_SCALE);
+    frame.gyro[0] = Frame_ToFixed16(imu_f[3], FRAME_GYRO_SCALE);
+    frame.gyro[1] = Frame_ToFixed16(imu_f[4], FRAME_GYRO_SCALE);
+    frame.gyro[2] = Frame_ToFixed16(imu_f[5], FRAME_GYRO_SCALE);
+    frame.mag[0] = Frame_ToFixed16(imu_f[6], FRAME_MAG_SCALE);
+    frame.mag[1] = Frame_ToFixed16(imu_f[7], FRAME_MAG_SCALE);
+    frame.mag[2] = Frame_ToFixed16(imu_f[8], FRAME_MAG_SCALE);
+    frame.temp = Frame_ToFixed16(imu_f[9], FRAME_TEMP_SCALE);
+    frame.sync = 1;
+    frame.utc_seconds = 1792413296UL;
+    frame.utc_micros = 200512UL;
+
+    return Frame_Encode(FRAME_TYPE_IMU, sequence, &frame, sizeof(frame), out, size);
+}
+
+static uint16_t BuildAttitude(uint8_t* out, uint16_t size, uint16_t sequence) {
+    Frame_Attitude frame;
+
+    frame.timestamp_us = 123456789UL;
+    frame.attitude[0] = Frame_ToFixed16(imu_f[10], FRAME_ANGLE_SCALE);
+    frame.attitude[1] = Frame_ToFixed16(imu_f[11], FRAME_ANGLE_SCALE);
+    frame.attitude[2] = Frame_ToFixed16(imu_f[12], FRAME_ANGLE_SCALE);
+    frame.yaw_source = 1;
+
+    return Frame_Encode(FRAME_TYPE_ATTITUDE, sequence, &frame, sizeof(frame), out, size);
+}
+
+static uint16_t BuildGps(uint8_t* out, uint16_t size, uint16_t sequence) {
+    Frame_Gps frame;
+
+    frame.timestamp_us = 123401234UL;
+    frame.latitude_e7 = 557558123L;
+    frame.longitude_e7 = 376173456L;
+    frame.altitude = (int32_t)(152.37f * FRAME_ALT_SCALE);
+    frame.speed = Frame_ToFixedU16(1.52f, FRAME_SPEED_SCALE);
+    frame.course = Frame_ToFixedU16(87.4f, FRAME_COURSE_SCALE);
+    frame.satellites = 11;
+    frame.fix = 1;
+    frame.time_of_day_ms = ((12 * 60UL + 34) * 60UL + 56) * 1000UL + 200;
+    frame.day = 19;
+    frame.month = 10;
+    frame.year = 2026;
+    frame.hdop = Frame_ToFixedU16(0.9f, FRAME_DOP_SCALE);
+
+    return Frame_Encode(FRAME_TYPE_GPS, sequence, &frame, sizeof(frame), out, size);
+}
+
+static uint16_t BuildHall(uint8_t* out, uint16_t size, uint16_t sequence) {
+    Frame_Hall frame;
+
+    frame.timestamp_us = 123457010UL;
+    for (int i = 0; i < 4; i++) {
+        frame.hall[i] = Frame_ToFixed16(hall_f[i], FRAME_ANGLE_SCALE);
+    }
+
+    return Frame_Encode(FRAME_TYPE_HALL, sequence, &frame, sizeof(frame), out, size);
+}
+
+static uint16_t BuildNav(uint8_t* out, uint16_t size, uint16_t sequence) {
+    Frame_Nav frame;
+
+    frame.timestamp_us = 123456789UL;
+    frame.valid = 1;
+    frame.latitude_e7 = 557558120L;
+    frame.longitude_e7 = 376173460L;
+    frame.vel_north = Frame_ToFixed16(0.03f, FRAME_SPEED_SCALE);
+    frame.vel_east = Frame_ToFixed16(-0.02f, FRAME_SPEED_SCALE);
+    frame.heading = Frame_ToFixedU16(87.1f, FRAME_COURSE_SCALE);
+
+    return Frame_Encode(FRAME_TYPE_NAV, sequence, &frame, sizeof(frame), out, size);
+}
+
+// Прежний состав текстового кадра: пять кадров каналов подряд
+static uint16_t BuildBinary(uint8_t* out, uint16_t size, uint16_t sequence) {
+    uint16_t length = 0;
+
+    length += BuildImu(out + length, size - length, sequence++);
+    length += BuildAttitude(out + length, size - length, sequence++);
+    length += BuildGps(out + length, size - length, sequence++);
+    length += BuildHall(out + length, size - length, sequence++);
+    length += BuildNav(out + length, size - length, sequence);
+    return length;
+}
+
+static volatile uint32_t sink;
+
+int main(int argc, char** argv) {
+    uint8_t out[512];
+    char text[512];
+
+    // Контрольное значение CRC-16/CCITT-FALSE
+    if (Frame_Crc16(0xFFFF, (const uint8_t*)"123456789", 9) != 0x29B1) {
+        fprintf(stderr, "CRC16 check value mismatch\n");
+        return 1;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "-x") == 0) {
+        uint16_t size = BuildBinary(out, sizeof(out), 0x1234);
+        for (uint16_t i = 0; i < size; i++) {
+            printf("%02x", out[i]);
+        }
+        printf("\n");
+        return 0;
+    }
+
+    long iterations = (argc > 1) ? atol(argv[1]) : 200000;
+    uint64_t t0, t1;
+    int text_len = 0;
+    uint16_t binary_len = 0;
+
+    t0 = NowNs();
+    for (long it = 0; it < iterations; it++) {
+        text_len = BuildText(text, sizeof(text));
+        sink += (uint32_t)text_len;
+    }
+    t1 = NowNs();
+    printf("text       %4d bytes/frame %8.1f ns/frame\n", text_len, (double)(t1 - t0) / iterations);
+
+    t0 = NowNs();
+    for (long it = 0; it < iterations; it++) {
+        binary_len = BuildBinary(out, sizeof(out), (uint16_t)it);
+        sink += binary_len;
+    }
+    t1 = NowNs();
+    printf("binary     %4u bytes/frame %8.1f ns/frame\n", binary_len, (double)(t1 - t0) / iterations);
+
+    t0 = NowNs();
+    for (long it = 0; it < iterations; it++) {
+        binary_len = BuildImu(out, sizeof(out), (uint16_t)it);
+        sink += binary_len;
+    }
+    t1 = NowNs();
+    printf("binary IMU %4u bytes/frame %8.1f ns/frame\n", binary_len, (double)(t1 - t0) / iterations);
+    return 0;
+}
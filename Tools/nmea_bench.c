@@ -0,0 +1,228 @@
+// Хостовый бенчмарк разбора NMEA: прежний ParseNMEA (strtok_r/atof)
+// против потокового NMEA_ParseByte + NMEA_DecodeSentence, с подпиской на все
+// типы и только на RMC/GGA (остальные отбрасываются по заголовку).
+//
+// Сборка и запуск из корня репозитория:
+//   gcc -O2 -ICore/Inc Tools/nmea_bench.c Core/Src/nmea_parser.c -o nmea_bench
+//   ./nmea_bench [iterations]
+//
+// Числа на x86 показывают относительную стоимость; на Cortex-M3 с программной
+// плавающей точкой разрыв в пользу целочисленного разбора еще больше.
+
+#include "nmea_parser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+// Типичный поток приемника: RMC и GGA плюс предложения, которые не используются
+static const char* const sentences[] = {
+    "$GPRMC,123519.00,A,4807.03812,N,01131.00047,E,022.4,084.4,230394,003.1,W*44\r\n",
+    "$GPGGA,123519.00,4807.03812,N,01131.00047,E,1,08,0.9,545.4,M,46.9,M,,*69\r\n",
+    "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n",
+    "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n",
+    "$GPVTG,084.4,T,,M,022.4,N,041.5,K,A*01\r\n",
+    "$GPGLL,4807.03812,N,01131.00047,E,123519.00,A,A*66\r\n",
+};
+#define SENTENCE_COUNT (sizeof(sentences) / sizeof(sentences[0]))
+
+// ---------------------------------------------------------------------------
+// Прежний разбор из gps.c (для сравнения, без изменений логики)
+
+typedef struct {
+    float latitude;
+    float longitude;
+    float altitude;
+    float speed;
+    float course;
+    uint8_t satellites;
+    uint8_t fix;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+} Legacy_GPS_Data;
+
+static Legacy_GPS_Data gps_data;
+
+static void LegacyParseNMEA(const char* sentence) {
+    char* token;
+    char* rest = (char*)sentence;
+
+    token = strtok_r(rest, ",", &rest);
+    if(strcmp(token, "$GPRMC") == 0) {
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            gps_data.hour = (token[0] - '0') * 10 + (token[1] - '0');
+            gps_data.minute = (token[2] - '0') * 10 + (token[3] - '0');
+            gps_data.second = (token[4] - '0') * 10 + (token[5] - '0');
+        }
+        token = strtok_r(NULL, ",", &rest);
+        gps_data.fix = (token[0] == 'A') ? 1 : 0;
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            float lat = atof(token);
+            int degrees = (int)(lat / 100);
+            float minutes = lat - (degrees * 100);
+            gps_data.latitude = degrees + (minutes / 60.0f);
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] == 'S') gps_data.latitude = -gps_data.latitude;
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            float lon = atof(token);
+            int degrees = (int)(lon / 100);
+            float minutes = lon - (degrees * 100);
+            gps_data.longitude = degrees + (minutes / 60.0f);
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] == 'W') gps_data.longitude = -gps_data.longitude;
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            gps_data.speed = atof(token) * 0.514f;
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            gps_data.course = atof(token);
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            gps_data.day = (token[0] - '0') * 10 + (token[1] - '0');
+            gps_data.month = (token[2] - '0') * 10 + (token[3] - '0');
+            gps_data.year = 2000 + (token[4] - '0') * 10 + (token[5] - '0');
+        }
+    }
+    else if(strcmp(token, "$GPGGA") == 0) {
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            gps_data.hour = (token[0] - '0') * 10 + (token[1] - '0');
+            gps_data.minute = (token[2] - '0') * 10 + (token[3] - '0');
+            gps_data.second = (token[4] - '0') * 10 + (token[5] - '0');
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            float lat = atof(token);
+            int degrees = (int)(lat / 100);
+            float minutes = lat - (degrees * 100);
+            gps_data.latitude = degrees + (minutes / 60.0f);
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] == 'S') gps_data.latitude = -gps_data.latitude;
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            float lon = atof(token);
+            int degrees = (int)(lon / 100);
+            float minutes = lon - (degrees * 100);
+            gps_data.longitude = degrees + (minutes / 60.0f);
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] == 'W') gps_data.longitude = -gps_data.longitude;
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            gps_data.fix = atoi(token);
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            gps_data.satellites = atoi(token);
+        }
+        token = strtok_r(NULL, ",", &rest);
+        if(token[0] != '\0') {
+            gps_data.altitude = atof(token);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+static uint64_t NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t NowCycles(void) {
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void Report(const char* name, uint64_t sentences_done, uint64_t ns, uint64_t cycles) {
+    double seconds = ns / 1e9;
+    printf("%-10s %12.0f sentences/s %10.1f ns/sentence", name,
+           sentences_done / seconds, (double)ns / sentences_done);
+#ifdef HAVE_TSC
+    printf(" %10.1f cycles/sentence", (double)cycles / sentences_done);
+#else
+    (void)cycles;
+#endif
+    printf("\n");
+}
+
+static volatile int32_t sink;
+
+static void RunStreaming(const char* name, long iterations, uint32_t subscriptions) {
+    NMEA_Parser parser;
+    NMEA_Fix fix;
+    uint64_t t0, t1, c0, c1;
+
+    NMEA_Init(&parser);
+    NMEA_SetSubscriptions(&parser, subscriptions);
+    memset(&fix, 0, sizeof(fix));
+
+    t0 = NowNs();
+    c0 = NowCycles();
+    for (long it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < SENTENCE_COUNT; i++) {
+            for (const char* p = sentences[i]; *p; p++) {
+                if (NMEA_ParseByte(&parser, (uint8_t)*p)) {
+                    NMEA_DecodeSentence(&parser, &fix);
+                }
+            }
+        }
+    }
+    c1 = NowCycles();
+    t1 = NowNs();
+    sink = fix.latitude_e7;
+    Report(name, (uint64_t)iterations * SENTENCE_COUNT, t1 - t0, c1 - c0);
+
+    printf("%s: %lu ok, %lu skipped, %lu checksum errors, %lu format errors\n", name,
+           (unsigned long)parser.sentences, (unsigned long)parser.skipped,
+           (unsigned long)parser.checksum_errors, (unsigned long)parser.format_errors);
+}
+
+int main(int argc, char** argv) {
+    long iterations = (argc > 1) ? atol(argv[1]) : 200000;
+    char line[128];
+    uint64_t t0, t1, c0, c1;
+
+    // Прежний разбор: каждое предложение копируется, strtok_r портит строку
+    t0 = NowNs();
+    c0 = NowCycles();
+    for (long it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < SENTENCE_COUNT; i++) {
+            strcpy(line, sentences[i]);
+            LegacyParseNMEA(line);
+        }
+    }
+    c1 = NowCycles();
+    t1 = NowNs();
+    sink = (int32_t)(gps_data.latitude * 1e6f);
+    Report("legacy", (uint64_t)iterations * SENTENCE_COUNT, t1 - t0, c1 - c0);
+
+    // Потоковый разбор: байты подаются так же, как из буфера DMA
+    RunStreaming("streaming", iterations, NMEA_SUBSCRIBE_ALL);
+    RunStreaming("filtered", iterations,
+                 NMEA_SENTENCE_BIT(NMEA_SENTENCE_RMC) | NMEA_SENTENCE_BIT(NMEA_SENTENCE_GGA));
+    return 0;
+}
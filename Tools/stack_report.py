@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+# Худший расход стека по цепочкам вызовов.
+#
+# Кадры функций берутся из файлов .su (-fstack-usage, сборка CubeIDE кладет
+# их рядом с объектными файлами), граф вызовов - из дизассемблера
+# Sojourner_DCU.list (objdump -h -S, шаг сборки CubeIDE). Для каждого корня
+# (main и обработчики прерываний *_Handler / *_IRQHandler) выводится самая
+# глубокая цепочка, затем оценка для стека MSP целиком: основной цикл и
+# вложенные прерывания, каждое со своим кадром исключения (32 байта).
+#
+# Запуск из корня репозитория после сборки:
+#   python3 Tools/stack_report.py [--build Debug] [--limit N] [--strict]
+#
+# Вызовы через указатель (blx rN) по дизассемблеру не видны: цели берутся из
+# INDIRECT (шаблоны имен), для HAL - обратные вызовы своей периферии
+# (USE_HAL_*_REGISTER_CALLBACKS), и из --indirect ВЫЗЫВАЮЩАЯ=ШАБЛОН. Функции
+# без .su (libgcc, newlib, ассемблер) считаются с нулевым кадром и перечисляются.
+
+import argparse
+import fnmatch
+import glob
+import os
+import re
+import sys
+
+# Цели вызовов через указатель: шаблон вызывающей -> шаблоны целей, первое
+# совпадение. Задачи планировщика (main.c), класс CDC (USBD_ClassTypeDef,
+# USBD_CDC_ItfTypeDef), обратные вызовы DMA от драйверов периферии.
+INDIRECT = [
+    ("Scheduler_Dispatch", ["Task_*"]),
+    ("USBD_CDC_*", ["CDC_*_FS"]),
+    ("USBD_*", ["USBD_CDC_*"]),
+    ("HAL_DMA_*", ["UART_DMA*", "I2C_DMA*", "ADC_DMA*", "TIM_DMA*"]),
+    ("_printf_*", ["__ssputs_r"]),
+]
+
+# HAL_<ПЕРИФЕРИЯ>_... и внутренние <ПЕРИФЕРИЯ>_... драйвера
+HAL_PERIPH_RE = re.compile(r'^(?:HAL_)?([A-Z][A-Z0-9]*)_')
+
+EXCEPTION_FRAME = 32  # r0-r3, r12, lr, pc, xPSR
+
+FUNC_RE = re.compile(r'^([0-9a-f]{8}) <([^>]+)>:$')
+CALL_RE = re.compile(r'^\s*[0-9a-f]+:\s+(?:[0-9a-f]{4}\s?)+\s+(bl|b|b\.w|b\.n)\s+[0-9a-f]+ <([^>+]+)>')
+INDIRECT_RE = re.compile(r'^\s*[0-9a-f]+:\s+(?:[0-9a-f]{4}\s?)+\s+blx\s+r\d+')
+SU_RE = re.compile(r'^(.*):(\d+):(\d+):(\S+)\t(\d+)\t(\S+)$')
+
+
+def load_stack_usage(build_dir):
+    """Кадры функций из .su: имя -> (байт, квалификатор)."""
+    frames = {}
+    for path in glob.glob(os.path.join(build_dir, "**", "*.su"), recursive=True):
+        with open(path, encoding="utf-8", errors="replace") as f:
+            for line in f:
+                m = SU_RE.match(line.rstrip("\n"))
+                if not m:
+                    continue
+                name, size, qualifier = m.group(4), int(m.group(5)), m.group(6)
+                # Одноименные static-функции разных файлов: берется больший кадр
+                if name not in frames or frames[name][0] < size:
+                    frames[name] = (size, qualifier)
+    return frames
+
+
+def load_call_graph(listing):
+    """Граф вызовов из дизассемблера: имя -> (множество вызываемых, есть ли blx rN)."""
+    graph = {}
+    current = None
+    with open(listing, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            m = FUNC_RE.match(line.rstrip("\n"))
+            if m:
+                current = m.group(2)
+                graph.setdefault(current, (set(), [False]))
+                continue
+            if current is None:
+                continue
+            m = CALL_RE.match(line)
+            if m:
+                target = m.group(2)
+                # Переход на себя - цикл, а не вызов
+                if target != current:
+                    graph[current][0].add(target)
+            elif INDIRECT_RE.match(line):
+                graph[current][1][0] = True
+    return {name: (callees, flag[0]) for name, (callees, flag) in graph.items()}
+
+
+def linker_symbol(script, symbol):
+    with open(script, encoding="utf-8", errors="replace") as f:
+        m = re.search(re.escape(symbol) + r'\s*=\s*(0x[0-9a-fA-F]+|\d+)', f.read())
+    return int(m.group(1), 0) if m else None
+
+
+def base_name(name):
+    """Имя клона GCC (f.constprop.0, f.isra.0) в записи .su: f.constprop."""
+    return re.sub(r'\.\d+$', '', name)
+
+
+class Analyzer:
+    def __init__(self, frames, graph, indirect):
+        self.frames = frames
+        self.graph = graph
+        self.indirect = indirect
+        self.memo = {}
+        self.missing = set()
+        self.dynamic = set()
+        self.recursive = set()
+        self.unresolved = set()
+
+    def indirect_targets(self, name):
+        for caller, patterns in self.indirect:
+            if fnmatch.fnmatchcase(name, caller):
+                return patterns
+        m = HAL_PERIPH_RE.match(name)
+        if m:
+            p = m.group(1)
+            return [f"HAL_{p}_*Callback", f"HAL_{p}Ex_*Callback", f"HAL_{p}_Msp*Init"]
+        return []
+
+    def callees(self, name):
+        callees, has_indirect = self.graph.get(name, (set(), False))
+        callees = set(callees)
+        if has_indirect:
+            targets = set()
+            for pattern in self.indirect_targets(name):
+                targets.update(fnmatch.filter(self.graph.keys(), pattern))
+            targets.discard(name)
+            if not targets:
+                self.unresolved.add(name)
+            callees |= targets
+        return callees
+
+    def frame(self, name):
+        for key in (name, base_name(name), name.split(".")[0]):
+            if key in self.frames:
+                break
+        else:
+            self.missing.add(name)
+            return 0
+        size, qualifier = self.frames[key]
+        if "dynamic" in qualifier:
+            self.dynamic.add(name)
+        return size
+
+    def worst(self, name, path=()):
+        """(байт, цепочка) самой глубокой цепочки от name."""
+        if name in self.memo:
+            return self.memo[name]
+        if name in path:
+            self.recursive.add(name)
+            return 0, [name + " (рекурсия)"]
+
+        best, chain = 0, []
+        for callee in sorted(self.callees(name)):
+            depth, sub = self.worst(callee, path + (name,))
+            if depth > best or not chain:
+                best, chain = depth, sub
+        result = (self.frame(name) + best, [name] + chain)
+        self.memo[name] = result
+        return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Худший расход стека по цепочкам вызовов")
+    parser.add_argument("--build", default="Debug", help="каталог сборки с .su и .list")
+    parser.add_argument("--list", help="дизассемблер (по умолчанию <build>/*.list)")
+    parser.add_argument("--ld", default="STM32F103C8TX_FLASH.ld", help="скрипт компоновщика")
+    parser.add_argument("--limit", type=int, help="бюджет стека, байт (по умолчанию _Min_Stack_Size)")
+    parser.add_argument("--strict", action="store_true", help="код возврата 1 при превышении бюджета")
+    parser.add_argument("--indirect", action="append", default=[], metavar="ФУНКЦИЯ=ШАБЛОН",
+                        help="цели вызовов через указатель, шаблоны через запятую")
+    parser.add_argument("--chains", action="store_true", help="печатать цепочки всех корней")
+    args = parser.parse_args()
+
+    listing = args.list
+    if listing is None:
+        found = sorted(glob.glob(os.path.join(args.build, "*.list")))
+        if not found:
+            sys.exit(f"нет .list в {args.build}: сначала соберите проект")
+        listing = found[0]
+
+    # Явные цели из командной строки проверяются раньше встроенных
+    indirect = []
+    for item in args.indirect:
+        caller, _, patterns = item.partition("=")
+        indirect.append((caller, [p for p in patterns.split(",") if p]))
+    indirect += INDIRECT
+
+    frames = load_stack_usage(args.build)
+    if not frames:
+        sys.exit(f"нет .su в {args.build}: нужна сборка с -fstack-usage")
+    graph = load_call_graph(listing)
+    analyzer = Analyzer(frames, graph, indirect)
+
+    limit = args.limit
+    if limit is None and os.path.exists(args.ld):
+        limit = linker_symbol(args.ld, "_Min_Stack_Size")
+
+    # Обработчики из таблицы векторов; HAL_*_IRQHandler - вызываемые из них
+    handlers = sorted(name for name in graph
+                      if not name.startswith("HAL_") and
+                      (name.endswith("_IRQHandler") or
+                       (name.endswith("_Handler") and name not in ("Reset_Handler", "Default_Handler"))))
+    main_depth, main_chain = analyzer.worst("main")
+
+    print(f"Стек по цепочкам вызовов ({listing}, {len(frames)} функций в .su)\n")
+    print(f"main: {main_depth} байт")
+    print("  " + " -> ".join(main_chain))
+
+    isr = []
+    for name in handlers:
+        depth, chain = analyzer.worst(name)
+        isr.append((depth + EXCEPTION_FRAME, name, chain))
+    isr.sort(reverse=True)
+
+    print(f"\nОбработчики прерываний (с кадром исключения {EXCEPTION_FRAME} байт):")
+    for depth, name, chain in isr:
+        if depth > EXCEPTION_FRAME or args.chains:
+            print(f"  {depth:5d}  {name}")
+            if args.chains or depth == isr[0][0]:
+                print("         " + " -> ".join(chain))
+
+    worst_isr = isr[0][0] if isr else 0
+    nested = sum(depth for depth, _, _ in isr)
+    print(f"\nmain + самое глубокое прерывание: {main_depth + worst_isr} байт")
+    print(f"main + все прерывания вложенно (верхняя граница): {main_depth + nested} байт")
+    if limit:
+        print(f"Бюджет (_Min_Stack_Size): {limit} байт, запас {limit - main_depth - worst_isr} байт")
+
+    if analyzer.dynamic:
+        print("\nКадр переменного размера (alloca/VLA), оценка снизу:")
+        print("  " + ", ".join(sorted(analyzer.dynamic)))
+    if analyzer.recursive:
+        print("\nРекурсия, глубина не ограничена анализом:")
+        print("  " + ", ".join(sorted(analyzer.recursive)))
+    if analyzer.unresolved:
+        print("\nВызовы через указатель без списка целей (--indirect):")
+        print("  " + ", ".join(sorted(analyzer.unresolved)))
+    if analyzer.missing:
+        print(f"\nБез .su, кадр принят за 0 ({len(analyzer.missing)}):")
+        print("  " + ", ".join(sorted(analyzer.missing)))
+
+    if args.strict and limit and main_depth + worst_isr > limit:
+        print(f"\nПревышен бюджет стека: {main_depth + worst_isr} > {limit}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -32,7 +32,6 @@
 
 /* USER CODE BEGIN PV */
 /* Private variables ---------------------------------------------------------*/
-static uint8_t CDC_Transmit_busy = 0;
 /* USER CODE END PV */
 
 /** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
@@ -154,9 +153,12 @@ static int8_t CDC_Init_FS(void)
 {
   /* USER CODE BEGIN 3 */
   /* Set Application Buffers */
+  // Прием идет в блоки пула usb_cdc.c, UserRxBufferFS - буфер сброса,
+  // когда свободных блоков нет
+  uint8_t* rx = USB_CDC_ArmRx();
   USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, 0);
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
-  CDC_Transmit_busy = 0;
+  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, (rx != NULL) ? rx : UserRxBufferFS);
+  USB_CDC_ResetTx();
   return (USBD_OK);
   /* USER CODE END 3 */
 }
@@ -168,7 +170,7 @@ static int8_t CDC_Init_FS(void)
 static int8_t CDC_DeInit_FS(void)
 {
   /* USER CODE BEGIN 4 */
-  CDC_Transmit_busy = 0;
+  USB_CDC_ResetTx();
   return (USBD_OK);
   /* USER CODE END 4 */
 }
@@ -256,11 +258,11 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
   /* USER CODE BEGIN 6 */
-  // Вызываем функцию обработки полученных данных из usb_cdc.c
-  USB_CDC_ReceiveCallback(Buf, Len);
+  // Блок с пакетом передается usb_cdc.c, следующий пакет - в новый блок
+  uint8_t* next = USB_CDC_ReceiveCallback(Buf, Len);
   
   // Перенастраиваем буфер приема для следующего пакета
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, (next != NULL) ? next : UserRxBufferFS);
   USBD_CDC_ReceivePacket(&hUsbDeviceFS);
   return (USBD_OK);
   /* USER CODE END 6 */
@@ -283,8 +285,8 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *pbuf, uint32_t *Len, uint8_t epnum)
   UNUSED(Len);
   UNUSED(epnum);
   
-  // Сброс флага занятости передачи
-  CDC_Transmit_busy = 0;
+  // Блок передан: возврат в пул, запуск следующего
+  USB_CDC_TransmitComplete();
   /* USER CODE END 7 */
   return result;
 }
@@ -303,41 +305,13 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
 {
   uint8_t result = USBD_OK;
   /* USER CODE BEGIN TRANSMIT_FS */
-  
-  // Проверка занятости передачи
-  if (CDC_Transmit_busy)
-  {
-    return USBD_BUSY;
-  }
-  
-  // Проверка валидности параметров
-  if (Buf == NULL || Len == 0 || Len > APP_TX_DATA_SIZE)
+  // Общая очередь передачи usb_cdc.c: данные ставятся в очередь целиком
+  // или отбрасываются, передача запускается по завершению предыдущей
+  if (Buf == NULL || Len == 0)
   {
     return USBD_FAIL;
   }
-  
-  // Проверка состояния USB устройства
-  USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
-  if (hcdc->TxState != 0)
-  {
-    return USBD_BUSY;
-  }
-  
-  // Установка флага занятости
-  CDC_Transmit_busy = 1;
-  
-  // Копируем данные в буфер передачи
-  memcpy(UserTxBufferFS, Buf, Len);
-  
-  USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, Len);
-  result = USBD_CDC_TransmitPacket(&hUsbDeviceFS);
-  
-  // Если передача не началась, сбрасываем флаг
-  if (result != USBD_OK)
-  {
-    CDC_Transmit_busy = 0;
-  }
-  
+  result = USB_CDC_QueueData(Buf, Len) ? USBD_OK : USBD_BUSY;
   /* USER CODE END TRANSMIT_FS */
   return result;
 }